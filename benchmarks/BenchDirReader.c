@@ -0,0 +1,130 @@
+#include <DirReader.h>
+
+#include <Definitions.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef BENCH_FLAT_ENTRIES
+#    define BENCH_FLAT_ENTRIES 100000
+#endif
+
+#ifndef BENCH_RUNS
+#    define BENCH_RUNS 5
+#endif
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// Walks the tree below fd (like the traversal does, openat per subdirectory), returns the number of entries.
+static usize Walk(DR_Backend backend, int fd, char* buf) {
+    DirReader reader;
+    if (DR_OpenWith(&reader, backend, fd, buf, DR_BUF_SIZE) != DRE_Ok) return 0;
+
+    // subdirectories are walked after the listing, so a single buffer is enough per level
+    usize count = 0;
+    usize dirsLen = 0, dirsCap = 0;
+    char** dirs = NULL;
+
+    DR_Entry entry;
+    while (DR_Next(&reader, &entry) == DRE_Ok && entry.name != NULL) {
+        if (strcmp(entry.name, ".") == 0 || strcmp(entry.name, "..") == 0) continue;
+        count++;
+
+        unsigned char type = entry.type;
+        if (type == DT_UNKNOWN) {
+            struct stat st;
+            if (fstatat(fd, entry.name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+            type = IFTODT(st.st_mode);
+        }
+        if (type != DT_DIR) continue;
+
+        if (dirsLen == dirsCap) {
+            dirsCap = dirsCap ? dirsCap * 2 : 16;
+            dirs = realloc(dirs, dirsCap * sizeof(char*));
+        }
+        dirs[dirsLen++] = strdup(entry.name);
+    }
+    DR_Close(&reader);
+
+    for (usize i = 0; i < dirsLen; ++i) {
+        int child = openat(fd, dirs[i], O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (child != -1) {
+            count += Walk(backend, child, buf);
+            close(child);
+        }
+        free(dirs[i]);
+    }
+    free(dirs);
+    return count;
+}
+
+static void Bench(const char* path) {
+    char* buf = malloc(DR_BUF_SIZE);
+    usize expected = 0;
+
+    printf("%s\n", path);
+    for (DR_Backend backend = 0; backend < DRB_Count; ++backend) {
+        if (!DR_IsSupported(backend)) {
+            printf("  %-12s unsupported\n", DR_BackendName(backend));
+            continue;
+        }
+
+        double best = 0;
+        usize count = 0;
+        for (int run = 0; run < BENCH_RUNS; ++run) {
+            int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd == -1) {
+                fprintf(stderr, "failed to open %s\n", path);
+                free(buf);
+                return;
+            }
+
+            double start = Now();
+            count = Walk(backend, fd, buf);
+            double elapsed = Now() - start;
+            close(fd);
+
+            if (run == 0 || elapsed < best) best = elapsed;
+        }
+
+        if (backend == DRB_Readdir) expected = count;
+        printf("  %-12s %8.3f ms  %zu entries  %s\n", DR_BackendName(backend), best * 1e3, count,
+            count == expected ? "ok" : "MISMATCH");
+    }
+    free(buf);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) Bench(argv[i]);
+        return 0;
+    }
+
+    // one huge flat directory, like generated code or logs
+    char dir[] = "/tmp/clines-bench-XXXXXX";
+    if (mkdtemp(dir) == NULL) return 1;
+
+    char path[256];
+    for (int i = 0; i < BENCH_FLAT_ENTRIES; ++i) {
+        snprintf(path, sizeof(path), "%s/generated_message_%d.pb.cc", dir, i);
+        int fd = open(path, O_WRONLY | O_CREAT, 0644);
+        if (fd == -1) return 1;
+        close(fd);
+    }
+
+    printf("synthetic (%d empty files in one directory)\n", BENCH_FLAT_ENTRIES);
+    Bench(dir);
+
+    snprintf(path, sizeof(path), "rm -rf '%s'", dir);
+    return system(path) == 0 ? 0 : 1;
+}
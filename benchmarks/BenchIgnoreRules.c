@@ -0,0 +1,100 @@
+#include <IgnoreRules.h>
+
+#include <Definitions.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef BENCH_NAMES
+#    define BENCH_NAMES 1000000
+#endif
+
+#ifndef BENCH_RULES
+#    define BENCH_RULES 300
+#endif
+
+static const char* const dirs[] = { "src", "lib", "include", "tests", "docs", "tools", "internal", "pkg", "app", "core" };
+static const char* const exts[] = { "c", "h", "cpp", "py", "js", "go", "rs", "md", "txt", "json", "o", "log" };
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// A large monorepo style ignore file: mostly names and extensions, some anchored globs.
+static char* SyntheticRules(usize count) {
+    char* text = malloc(count * 64);
+    if (text == NULL) return NULL;
+
+    usize len = 0;
+    for (usize i = 0; i < count; ++i) {
+        switch (i % 6) {
+        case 0: len += sprintf(text + len, "generated_%zu/\n", i); break;
+        case 1: len += sprintf(text + len, "*.tmp%zu\n", i); break;
+        case 2: len += sprintf(text + len, "/out/%s/*_%zu.bin\n", dirs[i % 10], i); break;
+        case 3: len += sprintf(text + len, "cache-%zu\n", i); break;
+        case 4: len += sprintf(text + len, "**/fixtures/%zu/**\n", i); break;
+        case 5: len += sprintf(text + len, "!keep_%zu.tmp%zu\n", i, i - 4); break;
+        }
+    }
+    len += sprintf(text + len, "*.o\n*.log\nnode_modules/\nbuild/\n");
+    return text;
+}
+
+int main() {
+    char* text = SyntheticRules(BENCH_RULES);
+    if (text == NULL) return 1;
+
+    IgnoreRules rules;
+    if (IG_Parse(&rules, text, strlen(text)) != IGE_Ok) return 1;
+    rules.dirLen = strlen("/repo");
+
+    srand(3);
+    char (*names)[32] = malloc(BENCH_NAMES * sizeof(*names));
+    const char** dirPaths = malloc(BENCH_NAMES * sizeof(char*));
+    static char dirBufs[10][64];
+    for (usize i = 0; i < 10; ++i) snprintf(dirBufs[i], sizeof(dirBufs[i]), "/repo/%s/%s", dirs[i], dirs[(i * 7) % 10]);
+    for (usize i = 0; i < BENCH_NAMES; ++i) {
+        snprintf(names[i], sizeof(names[i]), "file_%d.%s", rand() % 1000, exts[rand() % 12]);
+        dirPaths[i] = dirBufs[rand() % 10];
+    }
+
+    printf("%d names, %zu rules (%zu names, %zu extensions, %zu globs)\n", BENCH_NAMES, rules.count, rules.namesCount,
+        rules.extsCount, rules.globsCount);
+
+    // every rule matched from the last one, as a plain list of globs would be
+    double start = Now();
+    usize expected = 0;
+    char rel[256];
+    for (usize i = 0; i < BENCH_NAMES; ++i) {
+        snprintf(rel, sizeof(rel), "%s/%s", dirPaths[i] + rules.dirLen + 1, names[i]);
+        for (usize r = rules.count; r > 0; --r) {
+            const IG_Rule* rule = &rules.rules[r - 1];
+            if (rule->dirOnly) continue;
+            if (IG_GlobMatch(rule->pattern, rule->anchored ? rel : names[i])) {
+                expected += !rule->negated;
+                break;
+            }
+        }
+    }
+    double naiveTime = Now() - start;
+
+    start = Now();
+    usize ignored = 0;
+    for (usize i = 0; i < BENCH_NAMES; ++i) {
+        if (IG_IsIgnored(&rules, dirPaths[i], names[i], false)) ignored++;
+    }
+    double rulesTime = Now() - start;
+
+    printf("  glob per rule  %8.3f s  %zu ignored\n", naiveTime, expected);
+    printf("  IgnoreRules    %8.3f s  %zu ignored  %s\n", rulesTime, ignored, ignored == expected ? "ok" : "MISMATCH");
+
+    IG_Destroy(&rules);
+    free(names);
+    free(dirPaths);
+    free(text);
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <LineCounterList.h>
+
+#include <Definitions.h>
+#include <Utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef BENCH_FILES
+#    define BENCH_FILES 5000000
+#endif
+
+static const char* const dirs[] = { "src", "lib", "include", "tests", "docs", "tools", "internal", "pkg", "app", "core" };
+static const char* const exts[] = { "c", "h", "cpp", "py", "js", "go", "rs", "md", "txt", "json", "o", "log" };
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool FillList(LineCounterList* list, usize count) {
+    srand(7);
+    char buf[512];
+    for (usize i = 0; i < count; ++i) {
+        int len = snprintf(buf, sizeof(buf), "./project%d", rand() % 50);
+        int depth = 1 + rand() % 6;
+        for (int d = 0; d < depth; ++d) {
+            len += snprintf(buf + len, sizeof(buf) - len, "/%s", dirs[rand() % 10]);
+        }
+        if (rand() % 20 == 0) {
+            snprintf(buf + len, sizeof(buf) - len, "/Makefile");
+        } else {
+            snprintf(buf + len, sizeof(buf) - len, "/file_%d.%s", rand() % 100000, exts[rand() % 12]);
+        }
+
+        FileMeta meta = {
+            .fullPath = buf,
+            .size = rand() % (1 << 20),
+            .mtime = 1600000000 + rand() % 100000000,
+        };
+        if (LCL_Append(list, buf, (usize)(rand() % 5000), &meta, (LocStat) {0}, false) != LCLE_Ok) return false;
+    }
+    return true;
+}
+
+static const char* NameOf(const char* path) {
+    const char* name = strrchr(path, '/');
+    return name ? name + 1 : path;
+}
+
+static const char* ExtOf(const char* path) {
+    const char* ext = GetExtension(path);
+    return ext ? ext : "";
+}
+
+/// Compares the counters the way LCL_SortBy orders them (ascending, ties by row).
+static int Compare(const LineCounterList* list, CFG_SortMode mode, uint32_t a, uint32_t b) {
+    int cmp = 0;
+    switch (mode) {
+    case SM_Lines:
+        cmp = (list->lines[a] > list->lines[b]) - (list->lines[a] < list->lines[b]);
+        break;
+    case SM_Size:
+        cmp = (list->size[a] > list->size[b]) - (list->size[a] < list->size[b]);
+        break;
+    case SM_MTime:
+        cmp = (list->mtime[a] > list->mtime[b]) - (list->mtime[a] < list->mtime[b]);
+        break;
+    case SM_Path:
+        cmp = strcmp(list->toPrint[a], list->toPrint[b]);
+        break;
+    case SM_Name:
+        cmp = strcmp(NameOf(list->toPrint[a]), NameOf(list->toPrint[b]));
+        if (cmp == 0) cmp = (list->lines[a] > list->lines[b]) - (list->lines[a] < list->lines[b]);
+        break;
+    case SM_Ext:
+        cmp = strcmp(ExtOf(list->toPrint[a]), ExtOf(list->toPrint[b]));
+        break;
+    default:
+        break;
+    }
+    return cmp;
+}
+
+static bool IsSorted(const LineCounterList* list, CFG_SortMode mode, bool reverse) {
+    for (usize pos = 1; pos < list->len; ++pos) {
+        uint32_t a = list->order[pos - 1];
+        uint32_t b = list->order[pos];
+
+        int cmp = Compare(list, mode, a, b);
+        if (reverse) cmp = -cmp;
+        if (cmp > 0 || (cmp == 0 && a > b)) return false;
+    }
+    return true;
+}
+
+int main() {
+    LineCounterList list;
+    LCL_Init(&list);
+    if (!FillList(&list, BENCH_FILES)) {
+        fprintf(stderr, "failed to fill the list\n");
+        return 1;
+    }
+    printf("%d files\n", BENCH_FILES);
+
+    static const struct {
+        const char* name;
+        CFG_SortMode mode;
+    } modes[] = {
+        { "lines", SM_Lines }, { "size", SM_Size }, { "mtime", SM_MTime },
+        { "path", SM_Path }, { "name", SM_Name }, { "ext", SM_Ext },
+    };
+
+    for (usize i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i) {
+        for (int reverse = 0; reverse <= 1; ++reverse) {
+            double start = Now();
+            LCL_Error err = LCL_SortBy(&list, modes[i].mode, reverse);
+            double took = Now() - start;
+
+            const char* state = err != LCLE_Ok ? "FAILED" : (IsSorted(&list, modes[i].mode, reverse) ? "ok" : "UNSORTED");
+            printf("  %-6s %-9s %8.3f s  %s\n", modes[i].name, reverse ? "reversed" : "", took, state);
+        }
+    }
+
+    LCL_Destroy(&list);
+    return 0;
+}
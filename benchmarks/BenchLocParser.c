@@ -0,0 +1,146 @@
+#include <LocParser.h>
+#include <LocSettings.h>
+#include <LocUtils.h>
+
+#include <Definitions.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef BENCH_SYNTHETIC_SIZE
+#    define BENCH_SYNTHETIC_SIZE (32 * 1024 * 1024)
+#endif
+
+#ifndef BENCH_RUNS
+#    define BENCH_RUNS 3
+#endif
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char* ReadWholeFile(const char* path, usize* outLen) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return NULL;
+
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    char* buf = malloc(len > 0 ? (usize)len : 1);
+    if (buf == NULL || fread(buf, 1, (usize)len, fp) != (usize)len) {
+        free(buf);
+        fclose(fp);
+        return NULL;
+    }
+
+    fclose(fp);
+    *outLen = (usize)len;
+    return buf;
+}
+
+static usize Append(char* buf, usize at, usize cap, const char* str) {
+    usize len = strlen(str);
+    if (at + len > cap) len = cap - at;
+    memcpy(buf + at, str, len);
+    return at + len;
+}
+
+// source-like text built from the language's own delimiters: code, strings, comments, blank lines
+static char* SyntheticSource(const LocEntry* lang, usize len) {
+    char* buf = malloc(len);
+    if (buf == NULL) return NULL;
+
+    const char* str = lang->stringDelims ? lang->stringDelims[0] : NULL;
+    const char* comment = lang->commentStarts ? lang->commentStarts[0] : NULL;
+    const StringDelimPair* block = lang->multilineCommentDelimPairs;
+    const char* pp = lang->ppDirectiveStarts ? lang->ppDirectiveStarts[0] : NULL;
+
+    usize at = 0;
+    while (at < len) {
+        at = Append(buf, at, len, "    result = compute(value, other) + offset * 42;\n");
+        at = Append(buf, at, len, "        if (result > limit) { handle(result, limit); }\n");
+        if (str) {
+            at = Append(buf, at, len, "    message = ");
+            at = Append(buf, at, len, str);
+            at = Append(buf, at, len, "a fairly ordinary string literal with some words");
+            at = Append(buf, at, len, str);
+            at = Append(buf, at, len, ";\n");
+        }
+        if (comment) {
+            at = Append(buf, at, len, "    ");
+            at = Append(buf, at, len, comment);
+            at = Append(buf, at, len, " explains what the next few lines are doing and why\n");
+        }
+        if (block) {
+            at = Append(buf, at, len, block->start);
+            at = Append(buf, at, len, "\n   A license header or a documentation block that spans\n"
+                                      "   a couple of lines of plain prose without any code in it\n");
+            at = Append(buf, at, len, block->end);
+            at = Append(buf, at, len, "\n");
+        }
+        if (pp) {
+            at = Append(buf, at, len, pp);
+            at = Append(buf, at, len, "include something\n");
+        }
+        at = Append(buf, at, len, "\n");
+    }
+    return buf;
+}
+
+static void Bench(const char* label, const LocEntry* lang, const char* buf, usize len) {
+    double best = 1e9;
+    LocStat result = {0};
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        LocParser parser;
+        LP_Init(&parser);
+        result = (LocStat) {0};
+
+        double start = Now();
+        LP_ParseBuffer(&parser, lang, buf, len, &result);
+        LP_Finish(&parser, lang, &result);
+        double elapsed = Now() - start;
+
+        LP_Destroy(&parser);
+        if (elapsed < best) best = elapsed;
+    }
+
+    printf("  %-14s %-24s %8.1f MB/s  %zu lines\n", lang->langName, label, (double)len / best / 1e6, result.totalLines);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            const LocEntry* lang;
+            const char* name = strrchr(argv[i], '/');
+            if (!GetLocLangFor(name ? name + 1 : argv[i], &lang)) {
+                fprintf(stderr, "unsupported language: %s\n", argv[i]);
+                continue;
+            }
+
+            usize len = 0;
+            char* buf = ReadWholeFile(argv[i], &len);
+            if (buf == NULL) {
+                fprintf(stderr, "failed to read %s\n", argv[i]);
+                return 1;
+            }
+            Bench(argv[i], lang, buf, len);
+            free(buf);
+        }
+        return 0;
+    }
+
+    printf("synthetic (%.1f MiB per language)\n", (double)BENCH_SYNTHETIC_SIZE / (1024.0 * 1024.0));
+    const LocEntry* entries = GetLocEntries();
+    for (usize i = 0; i < GetLocEntriesCount(); ++i) {
+        char* buf = SyntheticSource(&entries[i], BENCH_SYNTHETIC_SIZE);
+        if (buf == NULL) return 1;
+        Bench("synthetic", &entries[i], buf, BENCH_SYNTHETIC_SIZE);
+        free(buf);
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <NewlineCount.h>
+
+#include <Definitions.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef BENCH_SYNTHETIC_SIZE
+#    define BENCH_SYNTHETIC_SIZE (256 * 1024 * 1024)
+#endif
+
+#ifndef BENCH_RUNS
+#    define BENCH_RUNS 5
+#endif
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char* ReadWholeFile(const char* path, usize* outLen) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return NULL;
+
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    char* buf = malloc(len > 0 ? (usize)len : 1);
+    if (buf == NULL || fread(buf, 1, (usize)len, fp) != (usize)len) {
+        free(buf);
+        fclose(fp);
+        return NULL;
+    }
+
+    fclose(fp);
+    *outLen = (usize)len;
+    return buf;
+}
+
+// source-like text: lines of 0..80 characters
+static char* SyntheticText(usize len) {
+    char* buf = malloc(len);
+    if (buf == NULL) return NULL;
+
+    srand(1);
+    usize lineLeft = 0;
+    for (usize i = 0; i < len; ++i) {
+        if (lineLeft == 0) {
+            buf[i] = '\n';
+            lineLeft = (usize)(rand() % 81);
+        } else {
+            buf[i] = ' ' + rand() % 95;
+            lineLeft--;
+        }
+    }
+    return buf;
+}
+
+static void Bench(const char* label, const char* buf, usize len) {
+    printf("%s (%.1f MiB)\n", label, (double)len / (1024.0 * 1024.0));
+
+    usize expected = NC_CountWith(NCK_Scalar, buf, len);
+    for (NC_Kernel k = 0; k < NCK_Count; ++k) {
+        if (!NC_IsSupported(k)) continue;
+
+        double best = 1e9;
+        usize count = 0;
+        for (int run = 0; run < BENCH_RUNS; ++run) {
+            double start = Now();
+            count = NC_CountWith(k, buf, len);
+            double elapsed = Now() - start;
+            if (elapsed < best) best = elapsed;
+        }
+
+        printf("  %-10s %8.2f GB/s  %s%s\n", NC_KernelName(k), (double)len / best / 1e9,
+            count == expected ? "ok" : "MISMATCH", k == NC_BestKernel() ? "  (dispatched)" : "");
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            usize len = 0;
+            char* buf = ReadWholeFile(argv[i], &len);
+            if (buf == NULL) {
+                fprintf(stderr, "failed to read %s\n", argv[i]);
+                return 1;
+            }
+            Bench(argv[i], buf, len);
+            free(buf);
+        }
+        return 0;
+    }
+
+    char* buf = SyntheticText(BENCH_SYNTHETIC_SIZE);
+    if (buf == NULL) return 1;
+    Bench("synthetic", buf, BENCH_SYNTHETIC_SIZE);
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <RegexSet.h>
+#include <StringList.h>
+
+#include <Definitions.h>
+
+#include <regex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef BENCH_PATHS
+#    define BENCH_PATHS 1000000
+#endif
+
+// a typical exclusion list: mostly plain names, a few real regexes
+static const char* const patterns[] = {
+    "node_modules", "\\.git$", "/\\.cache/", "/build/", "/dist/", "/target/", "/vendor/", "__pycache__",
+    "\\.pyc$", "\\.o$", "\\.a$", "\\.so$", "\\.min\\.js$", "\\.map$", "\\.lock$", "^/proc/", "^/sys/",
+    "/\\.idea/", "/\\.vscode/", "/cmake-build-[a-z]*/", "\\.sw[op]$", "~$", "/tmp[0-9]*/", "/out/.*\\.log$",
+    "/generated/.*_pb2\\.py$",
+    NULL,
+};
+
+static const char* const dirs[] = { "src", "lib", "include", "tests", "docs", "tools", "internal", "pkg", "app", "core" };
+static const char* const exts[] = { "c", "h", "cpp", "py", "js", "go", "rs", "md", "txt", "json", "o", "log" };
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char** SyntheticPaths(usize count) {
+    char** paths = malloc(count * sizeof(char*));
+    if (paths == NULL) return NULL;
+
+    srand(3);
+    char buf[512];
+    for (usize i = 0; i < count; ++i) {
+        int len = snprintf(buf, sizeof(buf), "/home/user/projects/project%d", rand() % 50);
+        int depth = 1 + rand() % 6;
+        for (int d = 0; d < depth; ++d) {
+            len += snprintf(buf + len, sizeof(buf) - len, "/%s", dirs[rand() % 10]);
+        }
+        if (rand() % 50 == 0) len += snprintf(buf + len, sizeof(buf) - len, "/node_modules");
+        if (rand() % 80 == 0) len += snprintf(buf + len, sizeof(buf) - len, "/build");
+        snprintf(buf + len, sizeof(buf) - len, "/file_%d.%s", rand() % 1000, exts[rand() % 12]);
+        paths[i] = strdup(buf);
+    }
+    return paths;
+}
+
+int main() {
+    StringList list;
+    SL_Init(&list);
+
+    usize patternsCount = 0;
+    for (; patterns[patternsCount] != NULL; ++patternsCount) SL_Append(&list, patterns[patternsCount]);
+
+    regex_t* separate = malloc(patternsCount * sizeof(regex_t));
+    for (usize i = 0; i < patternsCount; ++i) regcomp(&separate[i], patterns[i], REG_ICASE);
+
+    RegexSet set;
+    if (RS_Init(&set, &list) != RSE_Ok) {
+        fprintf(stderr, "failed to compile the regex set\n");
+        return 1;
+    }
+
+    char** paths = SyntheticPaths(BENCH_PATHS);
+    if (paths == NULL) return 1;
+
+    printf("%d paths, %zu patterns (%zu literal, %s combined, %zu separate)\n", BENCH_PATHS, patternsCount,
+        set.literalsCount, set.hasCombined ? "1" : "0", set.separateCount);
+
+    double start = Now();
+    usize expected = 0;
+    for (usize p = 0; p < BENCH_PATHS; ++p) {
+        for (usize i = 0; i < patternsCount; ++i) {
+            if (regexec(&separate[i], paths[p], 0, NULL, 0) == 0) {
+                expected++;
+                break;
+            }
+        }
+    }
+    double separateTime = Now() - start;
+
+    start = Now();
+    usize matched = 0;
+    for (usize p = 0; p < BENCH_PATHS; ++p) {
+        if (RS_Matches(&set, paths[p])) matched++;
+    }
+    double setTime = Now() - start;
+
+    printf("  regexec per pattern %8.3f s  %zu matched\n", separateTime, expected);
+    printf("  RegexSet            %8.3f s  %zu matched  %s\n", setTime, matched, matched == expected ? "ok" : "MISMATCH");
+
+    for (usize p = 0; p < BENCH_PATHS; ++p) free(paths[p]);
+    free(paths);
+    for (usize i = 0; i < patternsCount; ++i) regfree(&separate[i]);
+    free(separate);
+    RS_Destroy(&set);
+    SL_Destroy(&list);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#!/bin/bash
+
+cd "$(dirname "$0")" || exit 1
+source "../scripts/utils.sh" || exit 1
+
+CC="${CC:-gcc}"
+CCFLAGS=( -Wall -Werror -O2 )
+
+if [ -f "../compile_flags.txt" ]; then
+    readFlags=$(tr '\n' ' ' < ../compile_flags.txt)
+    if [ -n "$readFlags" ]; then
+        read -ra CCFLAGS <<< "$readFlags"
+    fi
+fi
+
+includePath=(
+    "../src/include"
+    "."
+)
+
+libs=(
+    -pthread
+)
+
+CompilationErrorExit=1
+LinkingErrorExit=2
+InvalidFlagExit=4
+
+OUTDIR="${OUTDIR:-build}"
+CLINES_OBJECTS=()
+benches=()
+benchArgs=()
+
+Help() {
+    echo "Usage: bench.sh [options] [targets] [-- args...]"
+    echo
+    echo "Options:"
+    echo "  --cc=<compiler>             Set C compiler path"
+    echo "  --ccflags=<flags>           Set C compilation flags"
+    echo "  --outdir=<directory>        Set output directory"
+    echo "  --help                      Show this help message"
+    echo
+    echo "Targets:"
+    echo "  -Bench{NAME}                Run specific benchmark"
+    echo
+    echo "If no targets specified, all benchmarks will be run. Arguments after -- are passed to every benchmark."
+}
+
+ParseFlags() {
+    while [[ $# -gt 0 ]]; do
+        case "$1" in
+        --)
+            shift
+            benchArgs=("$@")
+            return ;;
+        -Bench*)
+            benches+=("${1##-}") ;;
+        --cc=*)
+            CC="${1#*=}" ;;
+        --ccflags=*)
+            read -ra CCFLAGS <<< "${1#*=}" ;;
+        --outdir=*)
+            OUTDIR="${1#*=}" ;;
+        --help | -h)
+            Help
+            exit 0 ;;
+        *)
+            ShowError $InvalidFlagExit "Invalid flag: $1" ;;
+        esac
+        shift
+    done
+}
+
+CollectClinesObjects() {
+    while IFS= read -r -d '' f; do
+        if [[ $f == "../build/main.c.o" ]]; then
+            continue
+        fi
+        CLINES_OBJECTS+=("$f")
+    done < <(find ../build/ -name '*.o' -print0)
+}
+
+RunBench() {
+    local name="$1"
+    local out="$OUTDIR/$name"
+
+    "$CC" "${CCFLAGS[@]}" "${includePath[@]/#/-I}" "$name.c" -c -o "$out.o" || ShowError $CompilationErrorExit "Benchmark \"$name\" failed to compile."
+    "$CC" "${CCFLAGS[@]}" "${CLINES_OBJECTS[@]}" "$out.o" "${libs[@]}" -o "$out" || ShowError $LinkingErrorExit "Benchmark \"$name\" failed to link."
+
+    echo -e "\033[34;1m" "Running $name..." "\033[0m"
+    "$out" "${benchArgs[@]}"
+}
+
+Main() {
+    ParseFlags "$@"
+    mkdir -p "$OUTDIR"
+    CollectClinesObjects
+
+    if [[ ${#benches[@]} -eq 0 ]]; then
+        while IFS= read -r file; do
+            benches+=("$(basename "$file" .c)")
+        done < <(find . -maxdepth 1 -name "Bench*.c" | sort)
+    fi
+
+    for bench in "${benches[@]}"; do
+        RunBench "$bench"
+    done
+}
+
+Main "$@"
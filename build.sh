@@ -66,7 +66,7 @@ includePath=(
 )
 
 libs=(
-	# nothing yet...
+	-pthread
 )
 
 # ---------------------- Building Project ---------------------- #
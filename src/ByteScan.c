@@ -0,0 +1,154 @@
+#include <ByteScan.h>
+
+#include <Definitions.h>
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#    define BS_X86 1
+#    include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#    define BS_NEON 1
+#    include <arm_neon.h>
+#endif
+
+static usize BS_FindScalar(const char* buf, usize len, char a, char b) {
+    for (usize i = 0; i < len; ++i) {
+        if (buf[i] == a || buf[i] == b) return i;
+    }
+    return len;
+}
+
+#ifdef BS_X86
+
+__attribute__((target("sse2"))) static usize BS_FindSSE2(const char* buf, usize len, char a, char b) {
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+
+    usize i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(buf + i));
+        __m128i eq = _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb));
+
+        int mask = _mm_movemask_epi8(eq);
+        if (mask != 0) return i + (usize)__builtin_ctz((unsigned)mask);
+    }
+
+    return i + BS_FindScalar(buf + i, len - i, a, b);
+}
+
+__attribute__((target("avx2"))) static usize BS_FindAVX2(const char* buf, usize len, char a, char b) {
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+
+    usize i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(buf + i));
+        __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb));
+
+        unsigned mask = (unsigned)_mm256_movemask_epi8(eq);
+        if (mask != 0) return i + (usize)__builtin_ctz(mask);
+    }
+
+    // most strings and comment lines are short, the tail still gets a 16 byte step
+    return i + BS_FindSSE2(buf + i, len - i, a, b);
+}
+
+#endif // BS_X86
+
+#ifdef BS_NEON
+
+static usize BS_FindNEON(const char* buf, usize len, char a, char b) {
+    const uint8x16_t va = vdupq_n_u8((uint8_t)a);
+    const uint8x16_t vb = vdupq_n_u8((uint8_t)b);
+
+    usize i = 0;
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t chunk = vld1q_u8((const uint8_t*)(buf + i));
+        uint8x16_t eq = vorrq_u8(vceqq_u8(chunk, va), vceqq_u8(chunk, vb));
+
+        // narrow every byte to a nibble, 64 bits for the 16 lanes
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (mask != 0) return i + (usize)(__builtin_ctzll(mask) >> 2);
+    }
+
+    return i + BS_FindScalar(buf + i, len - i, a, b);
+}
+
+#endif // BS_NEON
+
+static BS_FindFunc* const kernels[BSK_Count] = {
+    [BSK_Scalar] = BS_FindScalar,
+#ifdef BS_X86
+    [BSK_SSE2] = BS_FindSSE2,
+    [BSK_AVX2] = BS_FindAVX2,
+#endif
+#ifdef BS_NEON
+    [BSK_NEON] = BS_FindNEON,
+#endif
+};
+
+static const char* const kernelNames[BSK_Count] = {
+    [BSK_Scalar] = "scalar",
+    [BSK_SSE2] = "sse2",
+    [BSK_AVX2] = "avx2",
+    [BSK_NEON] = "neon",
+};
+
+bool BS_IsSupported(BS_Kernel kernel) {
+    if (kernel >= BSK_Count || kernels[kernel] == NULL) return false;
+
+#ifdef BS_X86
+    __builtin_cpu_init();
+    switch (kernel) {
+    case BSK_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case BSK_AVX2:
+        return __builtin_cpu_supports("avx2");
+    default:
+        break;
+    }
+#endif
+
+    return true;
+}
+
+BS_Kernel BS_BestKernel() {
+    const BS_Kernel preferred[] = { BSK_AVX2, BSK_NEON, BSK_SSE2 };
+    for (usize i = 0; i < sizeof(preferred) / sizeof(preferred[0]); ++i) {
+        if (BS_IsSupported(preferred[i])) return preferred[i];
+    }
+    return BSK_Scalar;
+}
+
+const char* BS_KernelName(BS_Kernel kernel) {
+    if (kernel >= BSK_Count) return "unknown";
+    return kernelNames[kernel];
+}
+
+usize BS_FindAny2With(BS_Kernel kernel, const char* buf, usize len, char a, char b) {
+    if (!BS_IsSupported(kernel)) kernel = BSK_Scalar;
+    return kernels[kernel](buf, len, a, b);
+}
+
+static BS_FindFunc* bestKernel = BS_FindScalar;
+static pthread_once_t bestKernelOnce = PTHREAD_ONCE_INIT;
+
+static void BS_ResolveBestKernel() {
+    bestKernel = kernels[BS_BestKernel()];
+}
+
+usize BS_FindAny2(const char* buf, usize len, char a, char b) {
+    if (a == b) {
+        const char* found = memchr(buf, a, len);
+        return found != NULL ? (usize)(found - buf) : len;
+    }
+
+    pthread_once(&bestKernelOnce, BS_ResolveBestKernel);
+    return bestKernel(buf, len, a, b);
+}
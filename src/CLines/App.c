@@ -5,9 +5,13 @@
 
 #include <Config.h>
 #include <Definitions.h>
+#include <ExtensionSet.h>
 #include <INodeSet.h>
 #include <LineCounterList.h>
 #include <StringList.h>
+#include <ThreadPool.h>
+#include <TopList.h>
+#include <UringReader.h>
 
 #include <HelpPrinter.h>
 #include <HelpSettings.h>
@@ -15,6 +19,9 @@
 #include <LocParser.h>
 #include <LocSettings.h>
 #include <LocUtils.h>
+#include <PathTrie.h>
+#include <RegexSet.h>
+#include <ResultCache.h>
 
 #include <errno.h>
 #include <limits.h>
@@ -28,9 +35,26 @@
 #include <fcntl.h>
 #include <libgen.h>
 #include <regex.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifndef CL_RESERVED_FDS
+#    define CL_RESERVED_FDS 32
+#endif
+
+#ifndef CL_PENDING_ENTRIES
+#    define CL_PENDING_ENTRIES 4096 ///< default CLinesApp.pendingEntriesBudget
+#endif
+
+/// How many directories the traversal may keep open: about half of the soft RLIMIT_NOFILE, the rest is left for files.
+static usize CL_OpenDirsBudget() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) return 512;
+    if (limit.rlim_cur <= CL_RESERVED_FDS) return 0;
+    return (usize)(limit.rlim_cur - CL_RESERVED_FDS) / 2;
+}
+
 /// Initializes CLinesApp (should be called before CL_Run).
 CL_Error CL_Init(CLinesApp* self) {
     memset(self, 0, sizeof(CLinesApp));
@@ -41,9 +65,20 @@ CL_Error CL_Init(CLinesApp* self) {
     LCL_Error lcerr = LCL_InitReserved(&self->files, 128);
     if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
 
-    INS_Error inerr = INS_DefaultInit(&self->seen);
+    INS_Error inerr = INSS_DefaultInit(&self->seen);
     if (inerr != INSE_Ok) return CL_MapAndExceptINS(self, inerr);
 
+    inerr = INSS_DefaultInit(&self->scanned);
+    if (inerr != INSE_Ok) return CL_MapAndExceptINS(self, inerr);
+
+    atomic_init(&self->openDirs, 0);
+    self->openDirsBudget = CL_OpenDirsBudget();
+
+    atomic_init(&self->pendingEntries, 0);
+    self->pendingEntriesBudget = CL_PENDING_ENTRIES;
+    pthread_mutex_init(&self->nodesLock, NULL);
+    pthread_cond_init(&self->nodeDone, NULL);
+
     HP_Init(
         &self->helpPrinter,
         "CLines Help",
@@ -56,25 +91,20 @@ CL_Error CL_Init(CLinesApp* self) {
     return CLE_Ok;
 }
 
-static void FreeRegexArray(regex_t** arr, usize* count) {
-    for (usize i = 0; i < *count; ++i) regfree(&(*arr)[i]);
-    free(*arr);
-    *arr = NULL;
-    *count = 0;
-}
-
-static void FreeStringArray(char*** arr, usize* count) {
-    for (usize i = 0; i < *count; ++i) free((*arr)[i]);
-    free(*arr);
-    *arr = NULL;
-    *count = 0;
-}
-
 /// Destroys CLinesApp and frees up memory.
 CL_Error CL_Destroy(CLinesApp* self) {
-    FreeRegexArray(&self->includedRegexes, &self->includedRegexesCount);
-    FreeRegexArray(&self->excludedRegexes, &self->excludedRegexesCount);
-    FreeStringArray(&self->excludedPaths, &self->excludedPathsCount);
+    RS_Destroy(&self->includedRegexes);
+    RS_Destroy(&self->excludedRegexes);
+    ES_Destroy(&self->includedExtensions);
+    ES_Destroy(&self->excludedExtensions);
+    PT_Destroy(&self->excludedPaths);
+    CL_StopWatch(self);
+    if (self->keepingTop) TL_Destroy(&self->top);
+    self->keepingTop = false;
+    free(self->langSummary);
+    self->langSummary = NULL;
+    if (self->cacheEnabled) RC_Destroy(&self->cache);
+    self->cacheEnabled = false;
 
     CFG_Error cerr = CFG_Destroy(&self->cfg);
     if (cerr != CFGE_Ok) return CLE_ConfigError;
@@ -82,9 +112,23 @@ CL_Error CL_Destroy(CLinesApp* self) {
     LCL_Error lcerr = LCL_Destroy(&self->files);
     if (lcerr != LCLE_Ok) return CLE_ListError;
 
-    INS_Error inerr = INS_Destroy(&self->seen);
+    INS_Error inerr = INSS_Destroy(&self->seen);
     if (inerr != INSE_Ok) return CLE_SetError;
 
+    inerr = INSS_Destroy(&self->scanned);
+    if (inerr != INSE_Ok) return CLE_SetError;
+
+    TP_Destroy(&self->pool);
+    pthread_mutex_destroy(&self->nodesLock);
+    pthread_cond_destroy(&self->nodeDone);
+
+    for (usize i = 0; i < self->ringsCount; ++i) {
+        if (self->rings[i].usable) UR_Destroy(&self->rings[i].reader);
+    }
+    free(self->rings);
+    self->rings = NULL;
+    self->ringsCount = 0;
+
     HP_Destroy(&self->helpPrinter);
 
     self->linesCount = 0;
@@ -110,52 +154,55 @@ CL_Error CL_ResetCounter(CLinesApp* self) {
     self->linesCount = 0;
     self->fileCount = 0;
     self->dirCount = 0;
+    if (self->langSummary != NULL) memset(self->langSummary, 0, GetLocEntriesCount() * sizeof(CL_LangSummary));
 
     return CLE_Ok;
 }
 
-/// Compiles a list of regular expressions from a string list.
-static CL_Error CL_CompileRegexList(StringList* src, regex_t** outList, usize* outCount) {
-    *outCount = 0;
-    *outList = malloc(src->len * sizeof(regex_t));
-    if (!*outList) return CLE_AllocFailed;
-
-    for (usize i = 0; i < src->len; ++i) {
-        char* regStr;
-        SL_Get(src, i, &regStr);
-
-        int res = regcomp(&(*outList)[i], regStr, REG_ICASE);
-        if (res != 0) return CLE_RegexError;
-
-        (*outCount)++;
+/// Compiles a list of regular expressions from a string list into a single RegexSet.
+static CL_Error CL_CompileRegexSet(CLinesApp* self, StringList* src, RegexSet* out) {
+    RS_Error err = RS_Init(out, src);
+    switch (err) {
+    case RSE_Ok:
+        return CLE_Ok;
+    case RSE_AllocFailed:
+        return CLE_AllocFailed;
+    case RSE_InvalidRegex:
+        CL_SetErrorDetails(self, out->invalidPattern);
+        return CLE_RegexError;
     }
 
-    return CLE_Ok;
+    return CLE_InternalError;
 }
 
 /// Loads the included regular expressions from the configuration.
 CL_Error CL_LoadIncludedRegexes(CLinesApp* self) {
-    return CL_CompileRegexList(&self->cfg.includedRegexes, &self->includedRegexes, &self->includedRegexesCount);
+    return CL_CompileRegexSet(self, &self->cfg.includedRegexes, &self->includedRegexes);
 }
 
 /// Loads the excluded regular expressions from the configuration.
 CL_Error CL_LoadExcludedRegexes(CLinesApp* self) {
-    return CL_CompileRegexList(&self->cfg.excludedRegexes, &self->excludedRegexes, &self->excludedRegexesCount);
+    return CL_CompileRegexSet(self, &self->cfg.excludedRegexes, &self->excludedRegexes);
+}
+
+/// Compiles the included and excluded extensions from the configuration into sets.
+CL_Error CL_LoadExtensions(CLinesApp* self) {
+    if (ES_Init(&self->includedExtensions, &self->cfg.includedExtensions) != ESE_Ok) return CLE_AllocFailed;
+    if (ES_Init(&self->excludedExtensions, &self->cfg.excludedExtensions) != ESE_Ok) return CLE_AllocFailed;
+    return CLE_Ok;
 }
 
-/// Loads the excluded paths from the configuration.
+/// Loads the excluded paths from the configuration into a trie of their resolved paths.
 CL_Error CL_LoadExcludedPaths(CLinesApp* self) {
-    self->excludedPathsCount = 0;
-    self->excludedPaths = malloc(self->cfg.excludedPaths.len * sizeof(char*));
-    if (!self->excludedPaths) return CLE_AllocFailed;
+    PT_Init(&self->excludedPaths);
 
     for (usize i = 0; i < self->cfg.excludedPaths.len; ++i) {
         char* excluded;
         SL_Get(&self->cfg.excludedPaths, i, &excluded);
 
         errno = 0;
-        self->excludedPaths[i] = realpath(excluded, NULL);
-        if (self->excludedPaths[i] == NULL) {
+        char* resolved = realpath(excluded, NULL);
+        if (resolved == NULL) {
             if (errno == ENOENT || errno == ENOTDIR) {
                 CL_SetErrorDetails(self, excluded);
                 return CLE_NoSuchFileOrDir;
@@ -168,9 +215,85 @@ CL_Error CL_LoadExcludedPaths(CLinesApp* self) {
             }
         }
 
-        self->excludedPathsCount++;
+        PT_Error pterr = PT_Insert(&self->excludedPaths, resolved);
+        free(resolved);
+        if (pterr != PTE_Ok) return CLE_AllocFailed;
+    }
+
+    return CLE_Ok;
+}
+
+/// Starts the worker pool if more than one job was requested.
+CL_Error CL_StartWorkers(CLinesApp* self) {
+    if (self->cfg.jobs == 0) self->cfg.jobs = TP_DefaultWorkersCount();
+    usize workersCount = self->cfg.jobs > 1 ? self->cfg.jobs : 0;
+
+    if (self->cfg.ioUring.val && UR_IsSupported()) {
+        // without io_uring every file goes through CountLines/LP_ParseFile as before
+        self->rings = calloc(workersCount + 1, sizeof(CL_Ring));
+        if (self->rings == NULL) return CLE_AllocFailed;
+        self->ringsCount = workersCount + 1;
+    }
+
+    if (workersCount == 0) return CLE_Ok;
+
+    TP_Error tperr = TP_Init(&self->pool, workersCount);
+    return CL_MapAndExceptTP(self, tperr);
+}
+
+static const char* CL_CachePath(CLinesApp* self) {
+    return self->cfg.cachePath != NULL ? self->cfg.cachePath : RC_DEFAULT_PATH;
+}
+
+/// Resolves the path of a file that may not exist yet (through its directory).
+static char* CL_ResolveMaybeMissing(const char* path) {
+    char* resolved = realpath(path, NULL);
+    if (resolved != NULL) return resolved;
+
+    char* dirCopy = strdup(path);
+    char* nameCopy = strdup(path);
+    char* dirResolved = dirCopy && nameCopy ? realpath(dirname(dirCopy), NULL) : NULL;
+    if (dirResolved != NULL) {
+        const char* name = basename(nameCopy);
+        usize len = strlen(dirResolved) + strlen(name) + 2;
+        resolved = malloc(len);
+        if (resolved != NULL) snprintf(resolved, len, "%s/%s", strcmp(dirResolved, "/") == 0 ? "" : dirResolved, name);
     }
 
+    free(dirResolved);
+    free(dirCopy);
+    free(nameCopy);
+    return resolved;
+}
+
+/// Maps the results of the last run (see --cache). The cache file itself is never counted.
+CL_Error CL_LoadCache(CLinesApp* self) {
+    if (!self->cfg.useCache.val) return CLE_Ok;
+
+    const char* path = CL_CachePath(self);
+    RC_Init(&self->cache);
+    RC_Load(&self->cache, path);
+    self->cacheEnabled = true;
+    MSG_ShowDebugLog("cache: %zu results loaded from %s", self->cache.count, path);
+
+    char* resolved = CL_ResolveMaybeMissing(path);
+    if (resolved == NULL) return CLE_Ok;
+
+    PT_Error pterr = PT_Insert(&self->excludedPaths, resolved);
+    free(resolved);
+    return pterr == PTE_Ok ? CLE_Ok : CLE_AllocFailed;
+}
+
+/// Replaces the cache file with the results of this run. A cache that cannot be written is not an error.
+CL_Error CL_SaveCache(CLinesApp* self) {
+    if (!self->cacheEnabled) return CLE_Ok;
+
+    const char* path = CL_CachePath(self);
+    if (RC_Save(&self->cache, path) != RCE_Ok) {
+        MSG_ShowDebugLog("cache: could not write %s", path);
+    } else {
+        MSG_ShowDebugLog("cache: %zu results saved to %s", self->cache.freshLen, path);
+    }
     return CLE_Ok;
 }
 
@@ -180,35 +303,159 @@ CL_Error CL_LoadConfig(CLinesApp* self, int argc, char** argv) {
     return CL_MapAndExceptCFG(self, cerr);
 }
 
-CL_Error CL_PrintFiles(CLinesApp* self) {
+/// Prints a single file the way CL_PrintFiles does (nothing unless --print or --loc).
+CL_Error CL_PrintFile(CLinesApp* self, LineCounter* f) {
     if (self->cfg.printMode.val) {
-        for (usize i = 0; i < self->files.len; ++i) {
-            LineCounter* f;
-            LCL_Error lcerr = LCL_Get(&self->files, i, &f);
-            if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
-
-            printf("[+] %s - %zu lines\n", f->toPrint, f->lines);
-            if (self->cfg.locEnabled.val && f->hasLocStat) {
-                CL_PrintLocStat(self, &f->locStat, 1);
-            }
+        printf("[+] %s - %zu lines\n", f->toPrint, f->lines);
+        if (self->cfg.locEnabled.val && f->hasLocStat) {
+            CL_PrintLocStat(self, &f->locStat, 1);
         }
-    } else if (self->cfg.locEnabled.val) {
-        for (usize i = 0; i < self->files.len; ++i) {
-            LineCounter* f;
-            LCL_Error lcerr = LCL_Get(&self->files, i, &f);
-            if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
-
-            if (self->cfg.locEnabled.val && f->hasLocStat) {
-                printf("[+] %s - %zu lines\n", f->toPrint, f->lines);
-                CL_PrintLocStat(self, &f->locStat, 1);
-            }
+    } else if (self->cfg.locEnabled.val && !self->cfg.locSummary.val && f->hasLocStat) {
+        printf("[+] %s - %zu lines\n", f->toPrint, f->lines);
+        CL_PrintLocStat(self, &f->locStat, 1);
+    }
+    return CLE_Ok;
+}
+
+CL_Error CL_PrintFiles(CLinesApp* self) {
+    if (self->streaming) return CLE_Ok; // already printed
+    if (!self->cfg.printMode.val && !self->cfg.locEnabled.val) return CLE_Ok;
+
+    usize count = self->files.len;
+    if (self->cfg.topSetted && self->cfg.top < count) count = self->cfg.top;
+
+    for (usize i = 0; i < count; ++i) {
+        LineCounter f;
+        LCL_Error lcerr = LCL_GetOrdered(&self->files, i, &f);
+        if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
+
+        CL_PrintFile(self, &f);
+    }
+    return CLE_Ok;
+}
+
+/// Prints the totals of a single path.
+CL_Error CL_PrintTotals(CLinesApp* self) {
+    printf(BOLD "Total Lines:" RESET " %zu\n", self->linesCount);
+    printf(BOLD "Total Files:" RESET " %zu\n", self->fileCount);
+    if (self->cfg.recursive.val) {
+        printf(BOLD "Total Directories:" RESET " %zu\n", self->dirCount);
+    }
+    return CL_PrintLangSummary(self);
+}
+
+/// Whether only the totals and the language table are printed (see --loc-summary), so files need not be kept.
+bool CL_IsSummaryOnly(const CLinesApp* self) {
+    return self->cfg.locSummary.val && !self->cfg.printMode.val && !self->cfg.watch.val;
+}
+
+/// Adds a counted file to the totals of its language, or takes it away again (see --loc-summary).
+void CL_SummarizeFile(CLinesApp* self, const LocEntry* lang, const LocStat* stat, bool remove) {
+    if (self->langSummary == NULL || lang == NULL) return;
+
+    CL_LangSummary* summary = &self->langSummary[lang - GetLocEntries()];
+    if (remove) {
+        summary->files--;
+        summary->stat.emptyLines -= stat->emptyLines;
+        summary->stat.commentLines -= stat->commentLines;
+        summary->stat.codeLines -= stat->codeLines;
+        summary->stat.preprocessorLines -= stat->preprocessorLines;
+        summary->stat.totalLines -= stat->totalLines;
+    } else {
+        summary->files++;
+        summary->stat.emptyLines += stat->emptyLines;
+        summary->stat.commentLines += stat->commentLines;
+        summary->stat.codeLines += stat->codeLines;
+        summary->stat.preprocessorLines += stat->preprocessorLines;
+        summary->stat.totalLines += stat->totalLines;
+    }
+}
+
+/// The language a stored file was counted as, NULL if it has no LocStat.
+const LocEntry* CL_LangOf(const LineCounter* f) {
+    if (!f->hasLocStat) return NULL;
+
+    const char* name = strrchr(f->meta.fullPath, '/');
+    const LocEntry* lang = NULL;
+    return GetLocLangFor(name ? name + 1 : f->meta.fullPath, &lang) ? lang : NULL;
+}
+
+/// Prints the files and lines of every language that had files, most code first.
+CL_Error CL_PrintLangSummary(CLinesApp* self) {
+    if (self->langSummary == NULL) return CLE_Ok;
+
+    const LocEntry* entries = GetLocEntries();
+    const usize count = GetLocEntriesCount();
+
+    usize* byCode = malloc(count * sizeof(usize));
+    if (byCode == NULL) return CLE_AllocFailed;
+
+    usize len = 0;
+    CL_LangSummary total = {0};
+    for (usize i = 0; i < count; ++i) {
+        const CL_LangSummary* summary = &self->langSummary[i];
+        if (summary->files == 0) continue;
+
+        usize j = len++;
+        for (; j > 0 && self->langSummary[byCode[j - 1]].stat.codeLines < summary->stat.codeLines; --j) {
+            byCode[j] = byCode[j - 1];
         }
+        byCode[j] = i;
+
+        total.files += summary->files;
+        total.stat.emptyLines += summary->stat.emptyLines;
+        total.stat.commentLines += summary->stat.commentLines;
+        total.stat.codeLines += summary->stat.codeLines;
+        total.stat.preprocessorLines += summary->stat.preprocessorLines;
     }
+
+    printf(BOLD "%-12s %10s %10s %10s %10s %14s" RESET "\n", "Language", "Files", "Blank", "Comment", "Code", "Preprocessor");
+    for (usize i = 0; i < len; ++i) {
+        const CL_LangSummary* summary = &self->langSummary[byCode[i]];
+        printf("%-12s %10zu %10zu %10zu %10zu %14zu\n", entries[byCode[i]].langName, summary->files,
+            summary->stat.emptyLines, summary->stat.commentLines, summary->stat.codeLines,
+            summary->stat.preprocessorLines);
+    }
+    printf(BOLD "%-12s" RESET " %10zu %10zu %10zu %10zu %14zu\n", "Total", total.files, total.stat.emptyLines,
+        total.stat.commentLines, total.stat.codeLines, total.stat.preprocessorLines);
+
+    free(byCode);
     return CLE_Ok;
 }
 
+/**
+ * Whether files can be printed as soon as they are counted instead of being collected: only
+ * when nothing has to be ordered, limited or kept for later. The order is then the one of
+ * the traversal, which is also what the collected list gives without --reverse.
+ */
+bool CL_CanStream(const CLinesApp* self) {
+    const Config* cfg = &self->cfg;
+    return cfg->sortMode == SM_NotSort && !cfg->reverse.setted && !cfg->topSetted && !cfg->watch.val;
+}
+
+/**
+ * Whether --top can keep just the first files while counting (see TopList) instead of all of
+ * them. Not with --watch, which updates the counts of every file.
+ */
+bool CL_CanKeepTop(const CLinesApp* self) {
+    return self->cfg.topSetted && !self->cfg.watch.val;
+}
+
+/// The direction LCL_SortBy sorts the files in.
+static bool CL_SortReversed(const CLinesApp* self) {
+    // unsorted output keeps the traversal order unless --reverse is given, the other modes
+    // are descending by default (see CFG_SetDefauts)
+    bool reverse = self->cfg.reverse.val;
+    if (self->cfg.sortMode == SM_NotSort) reverse = !reverse;
+    return reverse;
+}
+
 CL_Error CL_ApplySort(CLinesApp* self) {
-    LCL_Error lcerr = LCL_SortBy(&self->files, self->cfg.sortMode, self->cfg.reverse.val);
+    if (self->streaming) return CLE_Ok;
+
+    if (self->keepingTop && TL_MoveTo(&self->top, &self->files) != TLE_Ok) return CLE_AllocFailed;
+
+    LCL_Error lcerr = LCL_SortBy(&self->files, self->cfg.sortMode, CL_SortReversed(self));
     return (int)CL_MapAndExceptLCL(self, lcerr);
 }
 
@@ -234,7 +481,7 @@ static int HandleBasicFlags(CLinesApp* self) {
 static int ProcessSinglePath(CLinesApp* self, const char* path) {
     CL_Error err;
 
-    err = CL_CountRecursive(self, path, 0);
+    err = CL_Count(self, path);
     if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
 
     err = CL_ApplySort(self);
@@ -243,12 +490,7 @@ static int ProcessSinglePath(CLinesApp* self, const char* path) {
     err = CL_PrintFiles(self);
     if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
 
-    printf(BOLD "Total Lines:" RESET " %zu\n", self->linesCount);
-    printf(BOLD "Total Files:" RESET " %zu\n", self->fileCount);
-    if (self->cfg.recursive.val) {
-        printf(BOLD "Total Directories:" RESET " %zu\n", self->dirCount);
-    }
-
+    CL_PrintTotals(self);
     return 0;
 }
 
@@ -259,11 +501,11 @@ static int ProcessMultiplePaths(CLinesApp* self) {
     usize totalDirCount = 0;
 
     for (usize i = 0; i < self->cfg.includedPaths.len; ++i) {
-        INS_Clear(&self->seen);
+        INSS_Clear(&self->seen);
         SL_Get(&self->cfg.includedPaths, i, &self->currentPath);
 
         printf("\033[1m-------- %s/ --------\033[0m\n", self->currentPath);
-        err = CL_CountRecursive(self, self->currentPath, 0);
+        err = CL_Count(self, self->currentPath);
         if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
 
         err = CL_ApplySort(self);
@@ -277,6 +519,8 @@ static int ProcessMultiplePaths(CLinesApp* self) {
         if (self->cfg.recursive.val) {
             printf(BOLD "Directories Count:" RESET " %zu\n", self->dirCount);
         }
+        err = CL_PrintLangSummary(self);
+        if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
         putchar('\n');
 
         totalLinesCount += self->linesCount;
@@ -316,13 +560,45 @@ int CL_Run(CLinesApp* self, int argc, char** argv) {
     err = CL_LoadIncludedRegexes(self);
     if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
 
+    err = CL_LoadExtensions(self);
+    if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
+
     err = CL_LoadExcludedPaths(self);
     if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
 
+    err = CL_StartWorkers(self);
+    if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
+
+    err = CL_LoadCache(self);
+    if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
+
+    self->streaming = CL_CanStream(self);
+    self->keepingTop = CL_CanKeepTop(self);
+    self->summaryOnly = CL_IsSummaryOnly(self);
+    if (self->cfg.locSummary.val) {
+        self->langSummary = calloc(GetLocEntriesCount(), sizeof(CL_LangSummary));
+        if (self->langSummary == NULL) return (int)CL_MapAndExceptCL(self, CLE_AllocFailed);
+    }
+    if (self->keepingTop) TL_Init(&self->top, self->cfg.top, self->cfg.sortMode, CL_SortReversed(self));
+    if (self->cfg.watch.val) {
+        // directories are recorded while the first count walks them
+        err = CL_StartWatch(self);
+        if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
+    }
+
+    int res;
     if (self->cfg.includedPaths.len > 1) {
-        return ProcessMultiplePaths(self);
+        res = ProcessMultiplePaths(self);
     } else {
         SL_Get(&self->cfg.includedPaths, 0, &self->currentPath);
-        return ProcessSinglePath(self, self->currentPath);
+        res = ProcessSinglePath(self, self->currentPath);
     }
+    if (res != 0) return res;
+
+    CL_SaveCache(self);
+    if (self->watch != NULL) {
+        err = CL_Watch(self, self->currentPath);
+        if (err != CLE_Ok) return (int)CL_MapAndExceptCL(self, err);
+    }
+    return 0;
 }
@@ -3,9 +3,21 @@
 #include <Utils.h>
 
 #include <Definitions.h>
+#include <DirReader.h>
+#include <ExtensionSet.h>
+#include <FileReader.h>
+#include <GitIndex.h>
+#include <IgnoreRules.h>
 #include <LocParser.h>
 #include <LocSettings.h>
 #include <LocUtils.h>
+#include <NewlineCount.h>
+#include <PathTrie.h>
+#include <RegexSet.h>
+#include <ResultCache.h>
+#include <ThreadPool.h>
+#include <TopList.h>
+#include <UringReader.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +32,11 @@
 #    define READ_BUF_SIZE (64 * 1024)
 #endif
 
+/// Files counted together through io_uring, in parallel mode a task of its own.
+#ifndef CL_RING_BATCH
+#    define CL_RING_BATCH (UR_QUEUE_DEPTH * 4)
+#endif
+
 #ifndef TMP_PATH_BUF_CAP
 #    ifdef PATH_MAX
 #        define TMP_PATH_BUF_CAP (PATH_MAX + 256)
@@ -29,58 +46,27 @@
 #endif
 
 static bool HasExcludedExtension(CLinesApp* self, const char* path) {
-    const char* ext = GetExtension(path);
-    if (!ext) return false;
-
-    for (usize i = 0; i < self->cfg.excludedExtensions.len; ++i) {
-        char* excludedExt;
-        SL_Get(&self->cfg.excludedExtensions, i, &excludedExt);
-        if (StrEql(ext, excludedExt)) return true;
-    }
-
-    return false;
+    return ES_MatchesName(&self->excludedExtensions, path);
 }
 
 static bool MatchesExcludedRegex(CLinesApp* self, const char* path) {
-    for (usize i = 0; i < self->excludedRegexesCount; ++i) {
-        int res = regexec(&self->excludedRegexes[i], path, 0, NULL, 0);
-        if (res == 0) return true;
-    }
-
-    return false;
+    return RS_Matches(&self->excludedRegexes, path);
 }
 
 static bool HasIncludedExtension(CLinesApp* self, const char* path) {
-    const char* ext = GetExtension(path);
-    if (!ext) return false;
-
-    for (usize i = 0; i < self->cfg.includedExtensions.len; ++i) {
-        char* includedExt;
-        SL_Get(&self->cfg.includedExtensions, i, &includedExt);
-        if (StrEql(ext, includedExt)) return true;
-    }
-
-    return false;
+    return ES_MatchesName(&self->includedExtensions, path);
 }
 
 static bool MatchesIncludedRegex(CLinesApp* self, const char* path) {
-    for (usize i = 0; i < self->includedRegexesCount; ++i) {
-        int res = regexec(&self->includedRegexes[i], path, 0, NULL, 0);
-        if (res == 0) return true;
-    }
-
-    return false;
+    return RS_Matches(&self->includedRegexes, path);
 }
 
-/**
- * Checks if file/directory should be included
- */
-bool CL_ShouldIncludePath(CLinesApp* self, const char* resolvedPath, const char* name, bool isDir) {
+/// The filters of CL_ShouldIncludePath except --exclude, which the caller already checked.
+static bool CL_PassesFilters(CLinesApp* self, const char* resolvedPath, const char* name, bool isDir) {
     if (!self->cfg.showHidden.val) {
         if (HasPrefix(name, ".")) return false;
     }
 
-    if (CL_IsExcluded(self, resolvedPath)) return false;
     if (!isDir) {
         if (HasExcludedExtension(self, name)) return false;
     }
@@ -91,7 +77,7 @@ bool CL_ShouldIncludePath(CLinesApp* self, const char* resolvedPath, const char*
             return false;
         }
     }
-    if (self->includedRegexesCount > 0 && !MatchesIncludedRegex(self, name)) {
+    if (self->includedRegexes.len > 0 && !MatchesIncludedRegex(self, name)) {
         return false;
     }
 
@@ -99,36 +85,38 @@ bool CL_ShouldIncludePath(CLinesApp* self, const char* resolvedPath, const char*
 }
 
 /**
- * Checks if the file is excluded
+ * Checks if file/directory should be included
+ */
+bool CL_ShouldIncludePath(CLinesApp* self, const char* resolvedPath, const char* name, bool isDir) {
+    if (CL_IsExcluded(self, resolvedPath)) return false;
+    return CL_PassesFilters(self, resolvedPath, name, isDir);
+}
+
+/**
+ * Checks if the file is excluded (is or is inside one of the excluded paths)
  */
 bool CL_IsExcluded(CLinesApp* self, const char* resolvedPath) {
-    for (usize i = 0; i < self->excludedPathsCount; ++i) {
-        if (HasPrefix(resolvedPath, self->excludedPaths[i])) {
-            return true;
-        }
-    }
-    return false;
+    return PT_Covers(&self->excludedPaths, resolvedPath);
 }
 
-static inline CL_Error CountLines(const char* path, usize* out) {
-    usize count = 0;
+static bool CountBlock(void* arg, const char* data, usize len) {
+    *(usize*)arg += NC_Count(data, len);
+    return true;
+}
 
-    int fd = open(path, O_RDONLY);
-    if (fd == -1) {
-        return CLE_FileOpenError;
-    }
+static inline CL_Error CountLines(int dirFd, const char* path, usize mmapThreshold, usize* out) {
+    usize count = 0;
 
     char buf[READ_BUF_SIZE];
-    isize bytesRead;
-    while ((bytesRead = read(fd, buf, READ_BUF_SIZE)) > 0) {
-        for (isize i = 0; i < bytesRead; ++i) {
-            if (buf[i] == '\n') count++;
-        }
+    FileReader reader;
+    if (FR_OpenAt(&reader, dirFd, path, mmapThreshold, buf, READ_BUF_SIZE) != FRE_Ok) {
+        return CLE_FileOpenError;
     }
 
-    close(fd);
+    FR_Error frerr = FR_ForEach(&reader, CountBlock, &count);
+    FR_Close(&reader);
 
-    if (bytesRead < 0) {
+    if (frerr != FRE_Ok) {
         return CLE_FileReadError;
     }
 
@@ -136,63 +124,265 @@ static inline CL_Error CountLines(const char* path, usize* out) {
     return CLE_Ok;
 }
 
-CL_Error CL_HandleFileWithLoc(CLinesApp* self, const char* formattedPath, const char* resolvedPath, const char* name, FileMeta* meta) {
-    bool hasLocStat = false;
-    LocStat stat = {0};
-    const LocEntry* lang = NULL;
+/**
+ * Counts lines (and LOC statistics when enabled) of a single file. The file is opened by name
+ * relative to dirFd, or by path when dirFd is AT_FDCWD. Does not touch CLinesApp, so it is
+ * safe to call from workers.
+ */
+static CL_Error CL_CountFile(int dirFd, const char* path, const char* name, const Config* cfg, CL_FileJob* out) {
+    if (dirFd != AT_FDCWD) path = name;
+
+    out->hasLocStat = false;
+    out->locStat = (LocStat) {0};
+    out->lang = NULL;
+    out->lperr = LPE_Ok;
 
-    bool res = GetLocLangFor(name, &lang);
-    if (!res) {
+    const LocEntry* lang = NULL;
+    if (!cfg->locEnabled.val || !GetLocLangFor(name, &lang)) {
         // no loc lang associated with this file
-        CL_Error err = CountLines(formattedPath, &stat.totalLines);
+        CL_Error err = CountLines(dirFd, path, cfg->mmapThreshold, &out->lines);
         if (err != CLE_Ok) return err;
 
-        hasLocStat = false;
-        goto add;
+        if (cfg->locEnabled.val) out->locStat.totalLines = out->lines;
+        return CLE_Ok;
     }
 
     LocParser parser;
     LP_Init(&parser);
+    parser.mmapThreshold = cfg->mmapThreshold;
 
-    LP_Error lperr = LP_ParseFile(&parser, lang, formattedPath, &stat);
-    if (lperr != LPE_Ok) {
-        CL_SetErrorDetails(self, name);
-        return MapAndExceptLP(self, lperr);
+    out->lperr = LP_ParseFileAt(&parser, lang, dirFd, path, &out->locStat);
+    LP_Destroy(&parser);
+    if (out->lperr != LPE_Ok) return CLE_LocError;
+
+    out->lines = out->locStat.totalLines;
+    out->hasLocStat = true;
+    out->lang = lang;
+    return CLE_Ok;
+}
+
+/// Counts a file that was already read into memory, the same way CL_CountFile does.
+static CL_Error CL_CountData(const char* name, const Config* cfg, const char* data, usize len, CL_FileJob* out) {
+    out->hasLocStat = false;
+    out->locStat = (LocStat) {0};
+    out->lang = NULL;
+    out->lperr = LPE_Ok;
+
+    const LocEntry* lang = NULL;
+    if (!cfg->locEnabled.val || !GetLocLangFor(name, &lang)) {
+        out->lines = NC_Count(data, len);
+        if (cfg->locEnabled.val) out->locStat.totalLines = out->lines;
+        return CLE_Ok;
     }
 
+    LocParser parser;
+    LP_Init(&parser);
+
+    out->lperr = LP_ParseBuffer(&parser, lang, data, len, &out->locStat);
+    if (out->lperr == LPE_Ok) out->lperr = LP_Finish(&parser, lang, &out->locStat);
     LP_Destroy(&parser);
+    if (out->lperr != LPE_Ok) return CLE_LocError;
 
-    hasLocStat = true;
-    goto add;
+    out->lines = out->locStat.totalLines;
+    out->hasLocStat = true;
+    out->lang = lang;
+    return CLE_Ok;
+}
 
-add:
-    {
-        LCL_Error lcerr = LCL_Append(&self->files, formattedPath, stat.totalLines, meta, stat, hasLocStat);
-        if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
-        self->linesCount += stat.totalLines;
+/**
+ * Appends a counted file to the list (or prints it right away when streaming, or offers it to
+ * --top), or reports the error of its count. Files of every thread end up here in order, so
+ * this is also where the totals (and --loc-summary) are added up.
+ */
+static CL_Error CL_AppendCounted(CLinesApp* self, const char* formattedPath, const char* name, FileMeta* meta, const CL_FileJob* res) {
+    if (res->err == CLE_LocError) {
+        CL_SetErrorDetails(self, name);
+        return MapAndExceptLP(self, res->lperr);
+    }
+    if (res->err == CLE_FileReadError) CL_SetErrorDetails(self, name);
+    if (res->err != CLE_Ok) return res->err;
 
+    CL_SummarizeFile(self, res->lang, &res->locStat, false);
+    if (self->summaryOnly) {
+        self->linesCount += res->lines;
         return CLE_Ok;
     }
+
+    if (self->streaming) {
+        LineCounter counter = {
+            .toPrint = (char*)formattedPath,
+            .lines = res->lines,
+            .meta = *meta,
+            .hasLocStat = res->hasLocStat,
+            .locStat = res->locStat,
+        };
+        self->linesCount += res->lines;
+        return CL_PrintFile(self, &counter);
+    }
+    if (self->keepingTop) {
+        TL_Error tlerr = TL_Offer(&self->top, formattedPath, res->lines, meta, res->locStat, res->hasLocStat);
+        if (tlerr != TLE_Ok) return CLE_AllocFailed;
+        self->linesCount += res->lines;
+        return CLE_Ok;
+    }
+
+    LCL_Error lcerr = LCL_Append(&self->files, formattedPath, res->lines, meta, res->locStat, res->hasLocStat);
+    if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
+    self->linesCount += res->lines;
+
+    return CLE_Ok;
 }
 
-CL_Error CL_HandleFile(CLinesApp* self, const char* formattedPath, const char* resolvedPath, const char* name, FileMeta* meta) {
-    if (!CL_ShouldIncludePath(self, resolvedPath, name, false)) return CLE_Ok;
+/// Counts the file (opened relative to dirFd, see CL_CountFile) on the calling thread and appends it to the list.
+static CL_Error CL_AddFileAt(CLinesApp* self, int dirFd, const char* formattedPath, const char* name, FileMeta* meta) {
+    CL_FileJob res;
+    res.err = CL_CountFile(dirFd, formattedPath, name, &self->cfg, &res);
+    return CL_AppendCounted(self, formattedPath, name, meta, &res);
+}
 
-    self->fileCount++;
+/// The cache key of a file entry, see RC_Key.mode.
+static RC_Key CL_CacheKey(const CLinesApp* self, const CL_DirEntry* entry) {
+    uint32_t mode = 0;
+    const LocEntry* lang = NULL;
+    if (self->cfg.locEnabled.val && GetLocLangFor(entry->name, &lang)) {
+        mode = (uint32_t)(lang - GetLocEntries()) + 1;
+    }
+
+    return (RC_Key) {
+        .dev = entry->inode.dev,
+        .ino = entry->inode.ino,
+        .size = entry->meta.size,
+        .mtimeNs = (int64_t)entry->meta.mtime * 1000000000LL + entry->meta.mtimeNsec,
+        .mode = mode,
+    };
+}
+
+/// Fills the job of the entry from the cache (as CL_CountFile would), returns false if the file has to be counted.
+static bool CL_LookupCached(const CLinesApp* self, CL_DirEntry* entry) {
+    if (!self->cacheEnabled) return false;
 
-    if (self->cfg.locEnabled.val) {
-        return CL_HandleFileWithLoc(self, formattedPath, resolvedPath, name, meta);
+    RC_Key key = CL_CacheKey(self, entry);
+    RC_Value value;
+    if (!RC_Lookup(&self->cache, &key, &value)) {
+        if (entry->blobId == NULL) return false;
+
+        // the same content may have been counted in another branch or worktree
+        key = RC_BlobKey(entry->blobId, key.size, key.mode);
+        if (!RC_Lookup(&self->cache, &key, &value)) return false;
     }
 
-    usize count = 0;
-    CL_Error err = CountLines(formattedPath, &count);
-    if (err != CLE_Ok) return err;
+    CL_FileJob* job = &entry->job;
+    job->err = CLE_Ok;
+    job->lperr = LPE_Ok;
+    job->lines = value.lines;
+    job->hasLocStat = key.mode > 0;
+    job->locStat = job->hasLocStat ? value.locStat : (LocStat) {0};
+    job->lang = job->hasLocStat ? &GetLocEntries()[key.mode - 1] : NULL;
+    if (!job->hasLocStat && self->cfg.locEnabled.val) job->locStat.totalLines = value.lines;
+    job->counted = true;
+    return true;
+}
 
-    LCL_Error lcerr = LCL_Append(&self->files, formattedPath, count, meta, (LocStat) {0}, false);
-    if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
-    self->linesCount += count;
+/// Remembers the result of an appended entry for the next run.
+static void CL_RecordCached(CLinesApp* self, const CL_DirEntry* entry) {
+    if (!self->cacheEnabled) return;
 
-    return CLE_Ok;
+    RC_Key key = CL_CacheKey(self, entry);
+    RC_Value value = { .lines = entry->job.lines, .locStat = entry->job.locStat };
+    // a result that could not be remembered is just counted again next time
+    RC_Add(&self->cache, &key, &value);
+
+    if (entry->blobId != NULL) {
+        key = RC_BlobKey(entry->blobId, key.size, key.mode);
+        RC_Add(&self->cache, &key, &value);
+    }
+}
+
+/// Returns the io_uring of the calling thread, NULL when files are read the usual way.
+static UringReader* CL_ThreadRing(CLinesApp* self) {
+    if (self->rings == NULL) return NULL;
+
+    isize worker = TP_CurrentWorker();
+    CL_Ring* ring = &self->rings[worker >= 0 ? (usize)worker : self->ringsCount - 1];
+    if (!ring->initialized) {
+        ring->initialized = true;
+        ring->usable = UR_Init(&ring->reader) == URE_Ok;
+    }
+    return ring->usable && !ring->reader.broken ? &ring->reader : NULL;
+}
+
+/// Whether the file is small enough to be read at once through io_uring.
+static inline bool CL_FitsRing(const CL_DirEntry* entry) {
+    return !entry->isDir && (usize)entry->meta.size < UR_SLOT_SIZE;
+}
+
+typedef struct CL_RingBatch {
+    CL_DirEntry** entries;
+    const Config* cfg;
+} CL_RingBatch;
+
+static void CL_OnRingFile(void* ctx, usize index, const UR_Result* result) {
+    CL_RingBatch* batch = ctx;
+    CL_DirEntry* entry = batch->entries[index];
+
+    // left for CL_CountFile, which also reports errors the usual way
+    if (result->err != 0 || result->truncated) return;
+
+    entry->job.err = CL_CountData(entry->name, batch->cfg, result->data, result->len, &entry->job);
+    entry->job.counted = true;
+}
+
+/**
+ * Counts up to CL_RING_BATCH files into their jobs through the ring, dirFd like in
+ * CL_CountFile. Files that could not be read this way are left with job.counted unset.
+ */
+static void CL_CountWithRing(UringReader* ring, int dirFd, const Config* cfg, CL_DirEntry** entries, usize len) {
+    UR_File files[CL_RING_BATCH];
+    for (usize i = 0; i < len; ++i) {
+        files[i] = (UR_File) { .dirFd = dirFd, .path = dirFd == AT_FDCWD ? entries[i]->path : entries[i]->name };
+    }
+
+    CL_RingBatch batch = { .entries = entries, .cfg = cfg };
+    UR_ReadFiles(ring, files, len, CL_OnRingFile, &batch);
+}
+
+/// Counts the files of a directory that fit a ring slot (see CL_FitsRing) into their jobs.
+static void CL_CountSmallFiles(UringReader* ring, int dirFd, const Config* cfg, CL_DirEntry* entries, usize len) {
+    CL_DirEntry* batch[CL_RING_BATCH];
+    usize batchLen = 0;
+
+    for (usize i = 0; i < len; ++i) {
+        if (!CL_FitsRing(&entries[i]) || entries[i].job.counted) continue;
+
+        batch[batchLen++] = &entries[i];
+        if (batchLen == CL_RING_BATCH) {
+            CL_CountWithRing(ring, dirFd, cfg, batch, batchLen);
+            batchLen = 0;
+        }
+    }
+    if (batchLen > 0) CL_CountWithRing(ring, dirFd, cfg, batch, batchLen);
+}
+
+CL_Error CL_HandleFileWithLoc(CLinesApp* self, const char* formattedPath, const char* resolvedPath, const char* name, FileMeta* meta) {
+    return CL_AddFileAt(self, AT_FDCWD, formattedPath, name, meta);
+}
+
+/// Counts the file entry into its job on the calling thread, opened by path and never from the cache.
+CL_Error CL_CountEntry(CLinesApp* self, CL_DirEntry* entry) {
+    entry->job.err = CL_CountFile(AT_FDCWD, entry->path, entry->name, &self->cfg, &entry->job);
+    return entry->job.err;
+}
+
+/// Counts the file on the calling thread and appends it to the list.
+CL_Error CL_AddFile(CLinesApp* self, const char* formattedPath, const char* name, FileMeta* meta) {
+    return CL_AddFileAt(self, AT_FDCWD, formattedPath, name, meta);
+}
+
+CL_Error CL_HandleFile(CLinesApp* self, const char* formattedPath, const char* resolvedPath, const char* name, FileMeta* meta) {
+    if (!CL_ShouldIncludePath(self, resolvedPath, name, false)) return CLE_Ok;
+
+    self->fileCount++;
+    return CL_AddFile(self, formattedPath, name, meta);
 }
 
 static char* BuildFullPath(const char* path, const char* name, char* tmpBuf, char** allocatedPath) {
@@ -245,6 +435,337 @@ static char* GetResolvedPath(const char* path, char* tmpBuf, char** outAllocated
     return resolved;
 }
 
+/// Returns true if the directory was not visited yet (and marks it as visited).
+static bool CL_MarkSeen(CLinesApp* self, INode inode) {
+    return INSS_Insert(&self->seen, inode) != INSE_AlredyExists;
+}
+
+static void CL_FreeEntries(CL_DirEntry* entries, usize len) {
+    for (usize i = 0; i < len; ++i) {
+        free(entries[i].path);
+        free(entries[i].resolved);
+    }
+    free(entries);
+}
+
+static CL_Error CL_PushEntry(CL_DirEntry** entries, usize* len, usize* cap, CL_DirEntry entry) {
+    if (*len == *cap) {
+        usize newCap = *cap > 0 ? *cap * 2 : 16;
+        CL_DirEntry* newEntries = realloc(*entries, newCap * sizeof(CL_DirEntry));
+        if (newEntries == NULL) return CLE_AllocFailed;
+
+        *entries = newEntries;
+        *cap = newCap;
+    }
+
+    (*entries)[(*len)++] = entry;
+    return CLE_Ok;
+}
+
+/// Position of a scanned directory in the excluded paths trie.
+typedef struct ExcludeCursor {
+    const char* dirResolved; ///< NULL when there is nothing to check
+    usize dirResolvedLen;
+    bool covered; ///< the directory itself is excluded (it was given explicitly)
+    const PT_Node* node; ///< NULL if no excluded path is below the directory
+} ExcludeCursor;
+
+static void CL_InitExcludeCursor(CLinesApp* self, const char* dirResolved, ExcludeCursor* out) {
+    *out = (ExcludeCursor) {0};
+    if (PT_IsEmpty(&self->excludedPaths)) return;
+
+    out->dirResolved = dirResolved;
+    out->dirResolvedLen = strlen(dirResolved);
+    if (out->dirResolvedLen == 1) out->dirResolvedLen = 0; // "/" + "name" has no extra separator
+    out->node = PT_Walk(PT_Root(&self->excludedPaths), dirResolved, &out->covered);
+}
+
+/**
+ * Checks --exclude for an entry of the directory of cursor. Entries resolving to <dir>/<name>
+ * are a single child lookup (none when nothing below the directory is excluded), only
+ * symlinks pointing elsewhere walk the trie from the root.
+ */
+static bool CL_IsExcludedEntry(CLinesApp* self, const ExcludeCursor* cursor, const char* resolvedPath, const char* name) {
+    if (PT_IsEmpty(&self->excludedPaths)) return false;
+
+    usize dirLen = cursor->dirResolvedLen;
+    bool inDir = strncmp(resolvedPath, cursor->dirResolved, dirLen) == 0 && resolvedPath[dirLen] == '/'
+        && strcmp(resolvedPath + dirLen + 1, name) == 0;
+    if (!inDir) return CL_IsExcluded(self, resolvedPath);
+
+    if (cursor->covered) return true;
+    if (cursor->node == NULL) return false;
+
+    const PT_Node* child = PT_Child(cursor->node, name, strlen(name));
+    return child != NULL && child->terminal;
+}
+
+/// Whether the entry is skipped because of the ignore files (see --ignore-files), .git is always skipped then.
+static bool CL_IsIgnoredEntry(CLinesApp* self, const IgnoreRules* ignore, const char* dirPath, const char* name, bool isDir) {
+    if (!self->cfg.ignoreFiles.val) return false;
+    if (isDir && strcmp(name, ".git") == 0) return true;
+    return ignore != NULL && IG_IsIgnored(ignore, dirPath, name, isDir);
+}
+
+/// Reads the ignore files of the open directory when --ignore-files is on, *out stays NULL without rules.
+static CL_Error CL_LoadIgnore(CLinesApp* self, int dirFd, const char* path, const IgnoreRules* parent, IgnoreRules** out) {
+    *out = NULL;
+    if (!self->cfg.ignoreFiles.val) return CLE_Ok;
+    return IG_Load(dirFd, path, parent, out) == IGE_Ok ? CLE_Ok : CLE_AllocFailed;
+}
+
+/// Opens the directory by name relative to parentFd, or by path when parentFd is AT_FDCWD.
+static CL_Error CL_OpenDir(int parentFd, const char* path, const char* name, int* outFd) {
+    *outFd = openat(parentFd, parentFd == AT_FDCWD ? path : name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (*outFd == -1) return CLE_ReadDirError;
+    return CLE_Ok;
+}
+
+/// Takes a slot of CLinesApp.openDirs, returns false when the budget is used up.
+static bool CL_ReserveOpenDir(CLinesApp* self) {
+    if (atomic_fetch_add(&self->openDirs, 1) < self->openDirsBudget) return true;
+    atomic_fetch_sub(&self->openDirs, 1);
+    return false;
+}
+
+static void CL_UnreserveOpenDir(CLinesApp* self) {
+    atomic_fetch_sub(&self->openDirs, 1);
+}
+
+/**
+ * Reads the directory and collects every entry that should be counted, in readdir order.
+ * path is the formatted path of the directory, only used to format the paths of the entries,
+ * which are stat'ed relative to the directory (fstatat). dirResolved is its resolved path:
+ * entries are resolved by appending their name, realpath is only needed for symlinks. d_type
+ * tells what an entry is, so only the entries that pass the filters are stat'ed (for their
+ * size, mtime and inode). Entries are read in bulk with getdents64 where available (see
+ * DirReader). Entries ignored by the rules of ignore (see --ignore-files) are dropped before
+ * anything else, so ignored directories are never opened. Does not modify CLinesApp, so it
+ * can run on workers concurrently. The caller keeps the ownership of fd.
+ */
+CL_Error CL_ScanDir(CLinesApp* self, int fd, const char* path, const char* dirResolved, const IgnoreRules* ignore,
+    CL_DirEntry** outEntries, usize* outLen) {
+    *outEntries = NULL;
+    *outLen = 0;
+
+    char direntBuf[DR_BUF_SIZE];
+    DirReader reader;
+    if (DR_Open(&reader, fd, direntBuf, sizeof(direntBuf)) != DRE_Ok) {
+        return CLE_ReadDirError;
+    }
+
+    CL_Error err = CLE_Ok;
+    DR_Entry entry;
+
+    CL_DirEntry* entries = NULL;
+    usize len = 0;
+    usize cap = 0;
+
+    char tmpFormmattedBuf[TMP_PATH_BUF_CAP];
+    char tmpResolvedBuf[TMP_PATH_BUF_CAP];
+
+    // the trie node of this directory, entries are checked against its children only
+    ExcludeCursor cursor;
+    CL_InitExcludeCursor(self, dirResolved, &cursor);
+
+    while (DR_Next(&reader, &entry) == DRE_Ok && entry.name != NULL) {
+        // skip "." and ".."
+        if (strcmp(entry.name, ".") == 0) continue;
+        if (strcmp(entry.name, "..") == 0) continue;
+
+        // built lazily, most entries never need it
+        char* allocatedFormattedPath = NULL;
+        char* formattedPath = NULL;
+
+        struct stat st;
+        bool haveStat = false;
+
+        unsigned char type = entry.type;
+        if (type == DT_UNKNOWN) {
+            // not every filesystem fills d_type
+            if (fstatat(fd, entry.name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+            type = IFTODT(st.st_mode);
+            haveStat = !S_ISLNK(st.st_mode);
+        }
+
+        char* allocatedResolved = NULL;
+        char* resolvedPath;
+        if (type == DT_LNK) {
+            // the only case where the path changes, the target decides what the entry is
+            formattedPath = BuildFullPath(path, entry.name, tmpFormmattedBuf, &allocatedFormattedPath);
+            if (formattedPath == NULL) {
+                err = CLE_AllocFailed;
+                goto cleanup;
+            }
+
+            resolvedPath = GetResolvedPath(formattedPath, tmpResolvedBuf, &allocatedResolved);
+            if (resolvedPath == NULL || fstatat(fd, entry.name, &st, 0) != 0) {
+                free(allocatedResolved);
+                goto skip;
+            }
+            type = IFTODT(st.st_mode);
+            haveStat = true;
+        } else {
+            resolvedPath = BuildFullPath(dirResolved, entry.name, tmpResolvedBuf, &allocatedResolved);
+            if (resolvedPath == NULL) {
+                err = CLE_AllocFailed;
+                goto cleanup;
+            }
+        }
+
+        bool isDir = type == DT_DIR;
+        bool include = false;
+        if (CL_IsIgnoredEntry(self, ignore, path, entry.name, isDir)) {
+            include = false;
+        } else if (isDir && self->cfg.recursive.val) {
+            include = !CL_IsExcludedEntry(self, &cursor, resolvedPath, entry.name)
+                && CL_PassesFilters(self, resolvedPath, entry.name, true);
+        } else if (type == DT_REG) {
+            include = !CL_IsExcludedEntry(self, &cursor, resolvedPath, entry.name)
+                && CL_PassesFilters(self, resolvedPath, entry.name, false);
+        }
+
+        if (include && !haveStat) include = fstatat(fd, entry.name, &st, 0) == 0;
+        if (include && !isDir) include = st.st_size != 0;
+
+        char* ownedResolved = NULL;
+        if (include && isDir) {
+            // directories keep their resolved path for scanning their own entries
+            ownedResolved = allocatedResolved ? allocatedResolved : strdup(resolvedPath);
+            allocatedResolved = NULL;
+            if (ownedResolved == NULL) {
+                free(allocatedFormattedPath);
+                err = CLE_AllocFailed;
+                goto cleanup;
+            }
+        }
+
+        free(allocatedResolved);
+        if (!include) goto skip;
+
+        if (formattedPath == NULL) {
+            formattedPath = BuildFullPath(path, entry.name, tmpFormmattedBuf, &allocatedFormattedPath);
+        }
+        char* ownedPath = NULL;
+        if (formattedPath != NULL) ownedPath = allocatedFormattedPath ? allocatedFormattedPath : strdup(formattedPath);
+        if (ownedPath == NULL) {
+            free(ownedResolved);
+            err = CLE_AllocFailed;
+            goto cleanup;
+        }
+
+        err = CL_PushEntry(&entries, &len, &cap, (CL_DirEntry) {
+            .path = ownedPath,
+            .name = ownedPath + (strlen(ownedPath) - strlen(entry.name)),
+            .resolved = ownedResolved,
+            .isDir = isDir,
+            .inode = { .dev = st.st_dev, .ino = st.st_ino },
+            .meta = {
+                .fullPath = ownedPath,
+                .size = st.st_size,
+                .mtime = st.st_mtime,
+                .mtimeNsec = st.st_mtim.tv_nsec,
+            },
+        });
+        if (err != CLE_Ok) {
+            free(ownedPath);
+            free(ownedResolved);
+            goto cleanup;
+        }
+        continue;
+
+    skip:
+        free(allocatedFormattedPath);
+    }
+
+cleanup:
+    DR_Close(&reader);
+    if (err != CLE_Ok) {
+        CL_FreeEntries(entries, len);
+        return err;
+    }
+
+    *outEntries = entries;
+    *outLen = len;
+    return CLE_Ok;
+}
+
+/**
+ * Counts the directory opened relative to parentFd (see CL_OpenDir). While its entries are
+ * counted it stays open, so they are opened relative to it, unless CLinesApp.openDirsBudget
+ * is used up (very deep trees), then it is closed right after scanning and paths are used.
+ * parentIgnore are the ignore rules in effect for the directory (see --ignore-files).
+ */
+CL_Error CL_CountDir(CLinesApp* self, int parentFd, const char* path, const char* name, const char* resolved,
+    const IgnoreRules* parentIgnore, usize depth) {
+    if (depth > self->cfg.maxDepth) return CLE_Ok;
+
+    int dirFd;
+    CL_Error err = CL_OpenDir(parentFd, path, name, &dirFd);
+    if (err != CLE_Ok) return err;
+
+    IgnoreRules* ownIgnore;
+    err = CL_LoadIgnore(self, dirFd, path, parentIgnore, &ownIgnore);
+    const IgnoreRules* ignore = ownIgnore != NULL ? ownIgnore : parentIgnore;
+
+    // watched before scanning, so nothing created meanwhile is missed
+    if (err == CLE_Ok && self->watch != NULL) {
+        err = CL_WatchDir(self, dirFd, path, resolved, depth, ignore, &ownIgnore);
+    }
+
+    CL_DirEntry* entries = NULL;
+    usize len = 0;
+    if (err == CLE_Ok) err = CL_ScanDir(self, dirFd, path, resolved, ignore, &entries, &len);
+
+    bool keepOpen = err == CLE_Ok && CL_ReserveOpenDir(self);
+    if (!keepOpen) {
+        if (close(dirFd) == -1 && err == CLE_Ok) err = CLE_CloseDirError;
+        if (err != CLE_Ok) {
+            CL_FreeEntries(entries, len);
+            IG_Free(ownIgnore);
+            return err;
+        }
+    }
+    const int fd = keepOpen ? dirFd : AT_FDCWD;
+
+    // unchanged files are not opened at all
+    if (self->cacheEnabled) {
+        for (usize i = 0; i < len; ++i) {
+            if (!entries[i].isDir) CL_LookupCached(self, &entries[i]);
+        }
+    }
+
+    // small files are read in batches first, they are appended in order below
+    UringReader* ring = CL_ThreadRing(self);
+    if (ring != NULL) CL_CountSmallFiles(ring, fd, &self->cfg, entries, len);
+
+    for (usize i = 0; i < len && err == CLE_Ok; ++i) {
+        CL_DirEntry* entry = &entries[i];
+
+        if (entry->isDir) {
+            if (!CL_MarkSeen(self, entry->inode)) continue;
+
+            self->dirCount++;
+            err = CL_CountDir(self, fd, entry->path, entry->name, entry->resolved, ignore, depth + 1);
+        } else {
+            self->fileCount++;
+            if (!entry->job.counted) {
+                entry->job.err = CL_CountFile(fd, entry->path, entry->name, &self->cfg, &entry->job);
+            }
+            err = CL_AppendCounted(self, entry->path, entry->name, &entry->meta, &entry->job);
+            if (err == CLE_Ok) CL_RecordCached(self, entry);
+        }
+    }
+
+    CL_FreeEntries(entries, len);
+    IG_Free(ownIgnore);
+    if (keepOpen) {
+        if (close(dirFd) == -1 && err == CLE_Ok) err = CLE_CloseDirError;
+        CL_UnreserveOpenDir(self);
+    }
+    return err;
+}
+
 CL_Error CL_CountRecursive(CLinesApp* self, const char* path, usize depth) {
     if (depth > self->cfg.maxDepth) return CLE_Ok;
 
@@ -258,94 +779,660 @@ CL_Error CL_CountRecursive(CLinesApp* self, const char* path, usize depth) {
         .fullPath = (char*)path,
         .size = pathStat.st_size,
         .mtime = pathStat.st_mtime,
+        .mtimeNsec = pathStat.st_mtim.tv_nsec,
     };
 
     if (S_ISREG(pathStat.st_mode)) {
         return CL_HandleFile(self, path, path, GetBaseName(path), &pathMeta);
     }
 
-    DIR* dir = opendir(path);
-    if (!dir) {
-        return CLE_ReadDirError;
+    // the only realpath of the whole traversal (besides symlinks), entries extend it
+    char* resolved = realpath(path, NULL);
+    if (resolved == NULL) {
+        CL_SetErrorDetails(self, path);
+        return CLE_NoSuchFileOrDir;
     }
 
-    CL_Error err = CLE_Ok;
-    struct dirent* entry = NULL;
+    CL_Error err = CL_CountDir(self, AT_FDCWD, path, path, resolved, NULL, depth);
+    free(resolved);
+    return err;
+}
 
-    char tmpFormmattedBuf[TMP_PATH_BUF_CAP];
-    char tmpResolvedBuf[TMP_PATH_BUF_CAP];
-    while ((entry = readdir(dir)) != NULL) {
-        // skip "." and ".."
-        if (strcmp(entry->d_name, ".") == 0) continue;
-        if (strcmp(entry->d_name, "..") == 0) continue;
+static CL_DirHandle* CL_RetainDir(CL_DirHandle* handle) {
+    if (handle != NULL) atomic_fetch_add(&handle->refs, 1);
+    return handle;
+}
 
-        char* allocatedFormattedPath = NULL;
-        char* formattedPath = BuildFullPath(path, entry->d_name, tmpFormmattedBuf, &allocatedFormattedPath);
+/// Drops a reference, the last one closes the directory.
+static void CL_ReleaseDir(CL_DirHandle* handle) {
+    if (handle == NULL || atomic_fetch_sub(&handle->refs, 1) != 1) return;
 
-        if (formattedPath == NULL) {
-            return CLE_AllocFailed;
+    close(handle->fd);
+    CL_UnreserveOpenDir(handle->app);
+    free(handle);
+}
+
+static inline int CL_DirFd(const CL_DirHandle* handle) {
+    return handle != NULL ? handle->fd : AT_FDCWD;
+}
+
+/// Marks count pieces of the work of the node done, the last one wakes up the merge (see CL_WaitDirNode).
+static void CL_FinishDirWork(CL_DirNode* node, usize count) {
+    if (node == NULL || atomic_fetch_sub(&node->pending, count) != count) return;
+
+    CLinesApp* self = node->app;
+    pthread_mutex_lock(&self->nodesLock);
+    node->done = true;
+    pthread_cond_broadcast(&self->nodeDone);
+    pthread_mutex_unlock(&self->nodesLock);
+}
+
+static void CL_WaitDirNode(CLinesApp* self, CL_DirNode* node) {
+    pthread_mutex_lock(&self->nodesLock);
+    while (!node->done) pthread_cond_wait(&self->nodeDone, &self->nodesLock);
+    pthread_mutex_unlock(&self->nodesLock);
+}
+
+static void CL_RunFileJob(void* arg) {
+    CL_FileJob* job = arg;
+    job->err = CL_CountFile(CL_DirFd(job->dir), job->path, job->name, job->cfg, job);
+
+    CL_ReleaseDir(job->dir);
+    job->dir = NULL;
+    CL_FinishDirWork(job->node, 1);
+}
+
+/// Small files of a directory, counted together through the ring of the worker that runs it.
+typedef struct CL_FileBatch {
+    CLinesApp* app;
+    CL_DirHandle* dir;
+    CL_DirNode* node;
+    CL_DirEntry* entries[CL_RING_BATCH];
+    usize len;
+} CL_FileBatch;
+
+static void CL_RunFileBatch(void* arg) {
+    CL_FileBatch* batch = arg;
+    const int dirFd = CL_DirFd(batch->dir);
+
+    UringReader* ring = CL_ThreadRing(batch->app);
+    if (ring != NULL) CL_CountWithRing(ring, dirFd, &batch->app->cfg, batch->entries, batch->len);
+
+    for (usize i = 0; i < batch->len; ++i) {
+        CL_FileJob* job = &batch->entries[i]->job;
+        if (!job->counted) job->err = CL_CountFile(dirFd, job->path, job->name, job->cfg, job);
+    }
+
+    CL_ReleaseDir(batch->dir);
+    CL_DirNode* node = batch->node;
+    usize len = batch->len;
+    free(batch);
+    CL_FinishDirWork(node, len);
+}
+
+static void CL_SubmitFileBatch(CLinesApp* self, CL_FileBatch* batch) {
+    if (TP_Submit(&self->pool, CL_RunFileBatch, batch) != TPE_Ok) CL_RunFileBatch(batch);
+}
+
+/**
+ * Hands the file (its job already set up) to the pool, small files are collected into *batch first.
+ * The job counts as work of node (NULL for none) until it is done.
+ */
+static void CL_SubmitFile(CLinesApp* self, CL_DirNode* node, CL_DirEntry* entry, CL_DirHandle* handle, CL_FileBatch** batch) {
+    if (node != NULL) atomic_fetch_add(&node->pending, 1);
+
+    if (self->rings != NULL && CL_FitsRing(entry)) {
+        if (*batch == NULL && (*batch = calloc(1, sizeof(CL_FileBatch))) != NULL) {
+            (*batch)->app = self;
+            (*batch)->dir = CL_RetainDir(handle);
+            (*batch)->node = node;
         }
+        if (*batch != NULL) {
+            (*batch)->entries[(*batch)->len++] = entry;
+            if ((*batch)->len == CL_RING_BATCH) {
+                CL_SubmitFileBatch(self, *batch);
+                *batch = NULL;
+            }
+            return;
+        }
+    }
 
-        char* allocatedResolved = NULL;
+    entry->job.dir = CL_RetainDir(handle);
+    entry->job.node = node;
+    if (TP_Submit(&self->pool, CL_RunFileJob, &entry->job) != TPE_Ok) CL_RunFileJob(&entry->job);
+}
 
-        char* resolvedPath = GetResolvedPath(formattedPath, tmpResolvedBuf, &allocatedResolved);
-        if (resolvedPath == NULL) {
-            free(allocatedFormattedPath);
-            continue;
+static void CL_RunDirTask(void* arg);
+
+static void CL_SubmitDirNode(CLinesApp* self, CL_DirNode* node) {
+    node->submitted = true;
+    if (TP_Submit(&self->pool, CL_RunDirTask, node) != TPE_Ok) CL_RunDirTask(node);
+}
+
+/**
+ * Opens the directory relative to its parent and scans it. The directory then stays open
+ * (as a CL_DirHandle) until its file jobs are done and its subdirectories are opened, unless
+ * CLinesApp.openDirsBudget is used up, then they fall back to paths.
+ */
+static void CL_ScanDirNode(CL_DirNode* node) {
+    CLinesApp* self = node->app;
+
+    int dirFd = -1;
+    if (node->depth <= self->cfg.maxDepth) {
+        node->err = CL_OpenDir(CL_DirFd(node->parent), node->path, node->name, &dirFd);
+    }
+    CL_ReleaseDir(node->parent);
+    node->parent = NULL;
+    if (dirFd == -1) return;
+
+    node->err = CL_LoadIgnore(self, dirFd, node->path, node->ignore, &node->ownIgnore);
+    const IgnoreRules* ignore = node->ownIgnore != NULL ? node->ownIgnore : node->ignore;
+    if (node->err == CLE_Ok && self->watch != NULL) {
+        node->err = CL_WatchDir(self, dirFd, node->path, node->resolved, node->depth, ignore, &node->ownIgnore);
+    }
+    if (node->err == CLE_Ok) {
+        node->err = CL_ScanDir(self, dirFd, node->path, node->resolved, ignore, &node->entries, &node->len);
+        atomic_fetch_add(&self->pendingEntries, node->len);
+    }
+
+    CL_DirHandle* handle = NULL;
+    if (node->err == CLE_Ok && CL_ReserveOpenDir(self)) {
+        handle = malloc(sizeof(CL_DirHandle));
+        if (handle == NULL) CL_UnreserveOpenDir(self);
+    }
+    if (handle == NULL) {
+        if (close(dirFd) == -1 && node->err == CLE_Ok) node->err = CLE_CloseDirError;
+        if (node->err != CLE_Ok) return;
+    } else {
+        handle->fd = dirFd;
+        handle->app = self;
+        atomic_init(&handle->refs, 1);
+    }
+
+    // entries won't move anymore, so children can keep pointers into them
+    CL_FileBatch* batch = NULL;
+    for (usize i = 0; i < node->len; ++i) {
+        CL_DirEntry* entry = &node->entries[i];
+
+        if (entry->isDir) {
+            // only decides which task scans it, the copy that is kept is chosen by CL_MergeDirNode
+            if (INSS_Insert(&self->scanned, entry->inode) == INSE_AlredyExists) {
+                entry->skipped = true;
+                continue;
+            }
+
+            CL_DirNode* child = calloc(1, sizeof(CL_DirNode));
+            if (child == NULL) {
+                node->err = CLE_AllocFailed;
+                break;
+            }
+            *child = (CL_DirNode) {
+                .app = self,
+                .path = entry->path,
+                .name = entry->name,
+                .resolved = entry->resolved,
+                .parent = CL_RetainDir(handle),
+                .depth = node->depth + 1,
+                .ignore = ignore,
+            };
+            atomic_init(&child->pending, 1);
+            entry->child = child;
+
+            // past the budget the merge submits it when it gets there, which bounds the entries held
+            if (atomic_load(&self->pendingEntries) < self->pendingEntriesBudget) CL_SubmitDirNode(self, child);
+        } else {
+            node->fileCount++;
+
+            entry->job = (CL_FileJob) {
+                .path = entry->path,
+                .name = entry->name,
+                .cfg = &self->cfg,
+            };
+            if (CL_LookupCached(self, entry)) continue;
+
+            CL_SubmitFile(self, node, entry, handle, &batch);
         }
+    }
+    if (batch != NULL) CL_SubmitFileBatch(self, batch);
 
-        struct stat st;
-        if (stat(formattedPath, &st) == -1) {
-            continue;
+    CL_ReleaseDir(handle);
+}
+
+static void CL_RunDirTask(void* arg) {
+    CL_DirNode* node = arg;
+    CL_ScanDirNode(node);
+    CL_FinishDirWork(node, 1);
+}
+
+static void CL_FreeDirNode(CL_DirNode* node) {
+    for (usize i = 0; i < node->len; ++i) {
+        CL_DirNode* child = node->entries[i].child;
+        if (node->entries[i].isDir && child != NULL) {
+            CL_FreeDirNode(child);
+            free(child);
         }
+    }
 
-        if (S_ISDIR(st.st_mode) && self->cfg.recursive.val) {
-            INode inode = { .dev = st.st_dev, .ino = st.st_ino };
-            if (!CL_ShouldIncludePath(self, resolvedPath, entry->d_name, true)) {
-                free(allocatedFormattedPath);
+    // only set when the node was never scanned
+    CL_ReleaseDir(node->parent);
+    node->parent = NULL;
+
+    atomic_fetch_sub(&node->app->pendingEntries, node->len);
+    CL_FreeEntries(node->entries, node->len);
+    node->entries = NULL;
+    node->len = 0;
+
+    IG_Free(node->ownIgnore);
+    node->ownIgnore = NULL;
+}
+
+/// Frees a subtree that is not merged, once the tasks already scanning it are done.
+static void CL_DropDirNode(CLinesApp* self, CL_DirNode* node) {
+    if (node->submitted) {
+        CL_WaitDirNode(self, node);
+        for (usize i = 0; i < node->len; ++i) {
+            CL_DirEntry* entry = &node->entries[i];
+            if (!entry->isDir || entry->child == NULL) continue;
+
+            CL_DropDirNode(self, entry->child);
+            entry->child = NULL;
+        }
+    }
+
+    CL_FreeDirNode(node);
+    free(node);
+}
+
+/**
+ * Moves the results of the tree into the list, visiting entries in the order CL_CountRecursive would.
+ * Runs while the tree is scanned: every node is waited for, merged and freed in turn, subdirectories
+ * left over the budget are submitted once they are reached.
+ * Directories are marked as seen here, so the copy kept of one reachable through symlinks is the one
+ * CL_CountRecursive keeps, the others are dropped. When that copy was not scanned (another task
+ * claimed the directory first), it is counted now the way CL_CountRecursive does.
+ */
+static CL_Error CL_MergeDirNode(CLinesApp* self, CL_DirNode* node) {
+    CL_WaitDirNode(self, node);
+    if (node->err != CLE_Ok) return node->err;
+
+    self->fileCount += node->fileCount;
+    const IgnoreRules* ignore = node->ownIgnore != NULL ? node->ownIgnore : node->ignore;
+
+    for (usize i = 0; i < node->len; ++i) {
+        CL_DirEntry* entry = &node->entries[i];
+
+        if (entry->isDir) {
+            CL_DirNode* child = entry->child;
+            if (!CL_MarkSeen(self, entry->inode)) {
+                if (child != NULL) CL_DropDirNode(self, child);
+                entry->child = NULL;
                 continue;
             }
+            self->dirCount++;
 
-            if (INS_Contains(&self->seen, inode)) {
-                free(allocatedFormattedPath);
-                free(allocatedResolved);
+            if (entry->skipped) {
+                CL_Error err = CL_CountDir(self, AT_FDCWD, entry->path, entry->name, entry->resolved, ignore, node->depth + 1);
+                if (err != CLE_Ok) return err;
                 continue;
             }
 
-            INS_Insert(&self->seen, inode);
-            self->dirCount++;
+            if (!child->submitted) CL_SubmitDirNode(self, child);
+            // after an error the rest of the tree is freed by CL_CountParallel, once its tasks are done
+            CL_Error err = CL_MergeDirNode(self, child);
+            if (err != CLE_Ok) return err;
 
-            err = CL_CountRecursive(self, formattedPath, depth + 1);
-            if (err != CLE_Ok) {
-                free(allocatedFormattedPath);
-                free(allocatedResolved);
-                goto cleanup;
-            }
-        } else if (S_ISREG(st.st_mode)) {
-            if (st.st_size == 0) continue;
+            CL_FreeDirNode(child);
+            free(child);
+            entry->child = NULL;
+            continue;
+        }
 
-            FileMeta meta = {
-                .fullPath = formattedPath,
-                .size = st.st_size,
-                .mtime = st.st_mtime,
-            };
+        CL_Error err = CL_AppendCounted(self, entry->path, entry->name, &entry->meta, &entry->job);
+        if (err != CLE_Ok) return err;
+        CL_RecordCached(self, entry);
+    }
 
-            err = CL_HandleFile(self, formattedPath, resolvedPath, entry->d_name, &meta);
-            if (err != CLE_Ok) {
-                free(allocatedFormattedPath);
-                free(allocatedResolved);
-                goto cleanup;
+    return CLE_Ok;
+}
+
+/**
+ * Counts the path using the pool: every directory is a task that workers can steal,
+ * every file found is a task as well. Gives the same list as CL_CountRecursive, and holds
+ * about CLinesApp.pendingEntriesBudget entries (plus the largest directories) at a time.
+ */
+CL_Error CL_CountParallel(CLinesApp* self, const char* path) {
+    struct stat pathStat;
+    if (stat(path, &pathStat) == -1) {
+        CL_SetErrorDetails(self, path);
+        return CLE_NoSuchFileOrDir;
+    }
+
+    if (S_ISREG(pathStat.st_mode)) {
+        FileMeta pathMeta = {
+            .fullPath = (char*)path,
+            .size = pathStat.st_size,
+            .mtime = pathStat.st_mtime,
+            .mtimeNsec = pathStat.st_mtim.tv_nsec,
+        };
+        return CL_HandleFile(self, path, path, GetBaseName(path), &pathMeta);
+    }
+
+    char* resolved = realpath(path, NULL);
+    if (resolved == NULL) {
+        CL_SetErrorDetails(self, path);
+        return CLE_NoSuchFileOrDir;
+    }
+
+    INSS_Clear(&self->scanned);
+    CL_DirNode root = { .app = self, .path = path, .name = path, .resolved = resolved, .depth = 0, .submitted = true };
+    atomic_init(&root.pending, 1);
+
+    TP_Error tperr = TP_Submit(&self->pool, CL_RunDirTask, &root);
+    if (tperr != TPE_Ok) {
+        free(resolved);
+        return CL_MapAndExceptTP(self, tperr);
+    }
+
+    // a failed merge stops early, the tasks still scanning the rest are waited for before freeing it
+    CL_Error err = CL_MergeDirNode(self, &root);
+    if (err != CLE_Ok) TP_Wait(&self->pool);
+    CL_FreeDirNode(&root);
+    free(resolved);
+    return err;
+}
+
+/// Builds a NUL terminated copy of the first len bytes of path in tmpBuf, or allocates one when it does not fit.
+static char* CL_CopyPrefix(const char* path, usize len, char* tmpBuf, char** allocatedPath) {
+    char* copy = tmpBuf;
+    if (len + 1 >= TMP_PATH_BUF_CAP) {
+        copy = *allocatedPath = malloc(len + 1);
+        if (copy == NULL) return NULL;
+    }
+
+    memcpy(copy, path, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/**
+ * Decides about a directory of tracked files, rel[0..end) relative to the counted path with
+ * its last component starting at rel + start. It is counted when it passes the filters, and
+ * its files are counted when it also is within --max-depth.
+ */
+static CL_Error CL_EnterTrackedDir(
+    CLinesApp* self, const char* resolved, const char* rel, usize start, usize end, usize depth, bool* outInclude) {
+    *outInclude = false;
+    if (!self->cfg.recursive.val) return CLE_Ok;
+
+    char tmpRelBuf[TMP_PATH_BUF_CAP];
+    char tmpResolvedBuf[TMP_PATH_BUF_CAP];
+    char* allocatedRel = NULL;
+    char* allocatedResolved = NULL;
+
+    char* dirRel = CL_CopyPrefix(rel, end, tmpRelBuf, &allocatedRel);
+    char* dirResolved = dirRel ? BuildFullPath(resolved, dirRel, tmpResolvedBuf, &allocatedResolved) : NULL;
+    if (dirResolved == NULL) {
+        free(allocatedRel);
+        return CLE_AllocFailed;
+    }
+
+    if (!CL_IsExcluded(self, dirResolved) && CL_PassesFilters(self, dirResolved, dirRel + start, true)) {
+        self->dirCount++;
+        *outInclude = depth <= self->cfg.maxDepth;
+    }
+
+    free(allocatedRel);
+    free(allocatedResolved);
+    return CLE_Ok;
+}
+
+/// Adds the tracked file rel (relative to path) to entries if it passes the filters and exists as a regular file.
+static CL_Error CL_AddTrackedFile(CLinesApp* self, const GitIndex* index, const GI_Entry* tracked, const char* path,
+    const char* resolved, const char* rel, CL_DirEntry** entries, usize* len, usize* cap) {
+    const char* slash = strrchr(rel, '/');
+    const char* name = slash ? slash + 1 : rel;
+
+    char tmpBuf[TMP_PATH_BUF_CAP];
+    char* allocatedPath = NULL;
+
+    char* fileResolved = BuildFullPath(resolved, rel, tmpBuf, &allocatedPath);
+    if (fileResolved == NULL) return CLE_AllocFailed;
+
+    bool include = !CL_IsExcluded(self, fileResolved) && CL_PassesFilters(self, fileResolved, name, false);
+    free(allocatedPath);
+    if (!include) return CLE_Ok;
+
+    allocatedPath = NULL;
+    char* formattedPath = BuildFullPath(path, rel, tmpBuf, &allocatedPath);
+    char* ownedPath = formattedPath && !allocatedPath ? strdup(formattedPath) : allocatedPath;
+    if (ownedPath == NULL) return CLE_AllocFailed;
+
+    // deleted and emptied files are skipped like in a walk, symlinks count as their target
+    struct stat st;
+    if (stat(ownedPath, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        free(ownedPath);
+        return CLE_Ok;
+    }
+
+    CL_Error err = CL_PushEntry(entries, len, cap, (CL_DirEntry) {
+        .path = ownedPath,
+        .name = ownedPath + (strlen(ownedPath) - strlen(name)),
+        .inode = { .dev = st.st_dev, .ino = st.st_ino },
+        .meta = {
+            .fullPath = ownedPath,
+            .size = st.st_size,
+            .mtime = st.st_mtime,
+            .mtimeNsec = st.st_mtim.tv_nsec,
+        },
+        .blobId = GI_IsUnchanged(index, tracked, &st) ? tracked->oid : NULL,
+    });
+    if (err != CLE_Ok) {
+        free(ownedPath);
+        return err;
+    }
+
+    self->fileCount++;
+    return CLE_Ok;
+}
+
+/**
+ * Collects the tracked files under path (resolved is its realpath inside workTree) in index
+ * order. Entries of a directory are next to each other there, so every directory is decided
+ * once, when the first file inside it comes up, and a filtered out one is skipped as a whole.
+ */
+static CL_Error CL_CollectTracked(CLinesApp* self, const GitIndex* index, const char* workTree, const char* path,
+    const char* resolved, CL_DirEntry** outEntries, usize* outLen) {
+    *outEntries = NULL;
+    *outLen = 0;
+
+    // path relative to the work tree, empty at its top
+    usize workTreeLen = strlen(workTree);
+    const char* prefix = resolved + workTreeLen;
+    if (*prefix == '/') ++prefix;
+    usize prefixLen = strlen(prefix);
+
+    CL_DirEntry* entries = NULL;
+    usize len = 0;
+    usize cap = 0;
+
+    const char* lastDir = "";
+    usize lastDirLen = 0;
+    usize excludedLen = 0; ///< length of the filtered out directory of the previous entry, 0 when none
+
+    CL_Error err = CLE_Ok;
+    for (usize i = 0; i < index->count && err == CLE_Ok; ++i) {
+        const GI_Entry* tracked = &index->entries[i];
+
+        const char* rel = tracked->path;
+        if (prefixLen > 0) {
+            if (tracked->pathLen <= prefixLen || memcmp(rel, prefix, prefixLen) != 0 || rel[prefixLen] != '/') continue;
+            rel += prefixLen + 1;
+        }
+
+        const char* slash = strrchr(rel, '/');
+        usize dirLen = slash ? (usize)(slash - rel) : 0;
+
+        // the directories shared with the previous entry were already decided
+        usize common = 0;
+        while (common < dirLen && common < lastDirLen && rel[common] == lastDir[common]) ++common;
+        bool boundary = (common == dirLen || rel[common] == '/') && (common == lastDirLen || lastDir[common] == '/');
+        if (!boundary) {
+            while (common > 0 && rel[common] != '/') --common;
+        }
+
+        bool excluded = excludedLen > 0 && common >= excludedLen;
+        if (!excluded) {
+            excludedLen = 0;
+
+            usize depth = 0;
+            for (usize j = 0; j < common; ++j) depth += rel[j] == '/';
+            if (common > 0) depth++;
+
+            for (usize start = common == 0 ? 0 : common + 1; start < dirLen;) {
+                usize end = start;
+                while (end < dirLen && rel[end] != '/') ++end;
+
+                bool include;
+                err = CL_EnterTrackedDir(self, resolved, rel, start, end, ++depth, &include);
+                if (err != CLE_Ok) break;
+                if (!include) {
+                    excludedLen = end;
+                    excluded = true;
+                    break;
+                }
+                start = end + 1;
             }
         }
 
-        free(allocatedFormattedPath);
-        free(allocatedResolved);
-        continue;
+        lastDir = rel;
+        lastDirLen = dirLen;
+        if (excluded || err != CLE_Ok) continue;
+
+        err = CL_AddTrackedFile(self, index, tracked, path, resolved, rel, &entries, &len, &cap);
     }
 
-cleanup:
-    if (closedir(dir) == -1) {
-        return CLE_CloseDirError;
+    if (err != CLE_Ok) {
+        CL_FreeEntries(entries, len);
+        return err;
     }
+
+    *outEntries = entries;
+    *outLen = len;
+    return CLE_Ok;
+}
+
+/// Counts the collected tracked files (with the pool when there is one) and appends them in order.
+static CL_Error CL_CountTracked(CLinesApp* self, CL_DirEntry* entries, usize len) {
+    const bool parallel = self->pool.workersCount > 0;
+
+    CL_FileBatch* batch = NULL;
+    for (usize i = 0; i < len; ++i) {
+        CL_DirEntry* entry = &entries[i];
+        entry->job = (CL_FileJob) {
+            .path = entry->path,
+            .name = entry->name,
+            .cfg = &self->cfg,
+        };
+        if (CL_LookupCached(self, entry) || !parallel) continue;
+
+        CL_SubmitFile(self, NULL, entry, NULL, &batch);
+    }
+
+    if (parallel) {
+        if (batch != NULL) CL_SubmitFileBatch(self, batch);
+        TP_Wait(&self->pool);
+    } else {
+        UringReader* ring = CL_ThreadRing(self);
+        if (ring != NULL) CL_CountSmallFiles(ring, AT_FDCWD, &self->cfg, entries, len);
+    }
+
+    for (usize i = 0; i < len; ++i) {
+        CL_DirEntry* entry = &entries[i];
+        if (!parallel && !entry->job.counted) {
+            entry->job.err = CL_CountFile(AT_FDCWD, entry->path, entry->name, &self->cfg, &entry->job);
+        }
+
+        CL_Error err = CL_AppendCounted(self, entry->path, entry->name, &entry->meta, &entry->job);
+        if (err != CLE_Ok) return err;
+        CL_RecordCached(self, entry);
+    }
+
+    return CLE_Ok;
+}
+
+/**
+ * Counts the files tracked by git under path (see --git), listed from the index of its
+ * repository instead of reading directories. Directories count when a tracked file is inside
+ * them, untracked files and submodules are left out, the filters apply like in a walk.
+ */
+CL_Error CL_CountGit(CLinesApp* self, const char* path) {
+    struct stat pathStat;
+    if (stat(path, &pathStat) == -1) {
+        CL_SetErrorDetails(self, path);
+        return CLE_NoSuchFileOrDir;
+    }
+
+    if (S_ISREG(pathStat.st_mode)) {
+        FileMeta pathMeta = {
+            .fullPath = (char*)path,
+            .size = pathStat.st_size,
+            .mtime = pathStat.st_mtime,
+            .mtimeNsec = pathStat.st_mtim.tv_nsec,
+        };
+        return CL_HandleFile(self, path, path, GetBaseName(path), &pathMeta);
+    }
+
+    char* resolved = realpath(path, NULL);
+    if (resolved == NULL) {
+        CL_SetErrorDetails(self, path);
+        return CLE_NoSuchFileOrDir;
+    }
+
+    char* workTree = NULL;
+    char* gitDir = NULL;
+    GI_Error gierr = GI_FindRepo(resolved, &workTree, &gitDir);
+    if (gierr != GIE_Ok) {
+        free(resolved);
+        if (gierr == GIE_AllocFailed) return CLE_AllocFailed;
+
+        CL_SetErrorDetails(self, path);
+        return CLE_NotAGitRepo;
+    }
+
+    GitIndex index;
+    gierr = GI_Load(&index, gitDir);
+    if (gierr != GIE_Ok) {
+        CL_SetErrorDetailsf(self, "%s/index: %s", gitDir,
+            gierr == GIE_Unsupported ? "unsupported version or split index" : "missing or corrupt");
+        free(resolved);
+        free(workTree);
+        free(gitDir);
+        return gierr == GIE_AllocFailed ? CLE_AllocFailed : CLE_GitIndexError;
+    }
+    MSG_ShowDebugLog("git: %zu tracked files in %s", index.count, workTree);
+
+    CL_DirEntry* entries;
+    usize len;
+    CL_Error err = CL_CollectTracked(self, &index, workTree, path, resolved, &entries, &len);
+    if (err == CLE_Ok) {
+        err = CL_CountTracked(self, entries, len);
+        CL_FreeEntries(entries, len);
+    }
+
+    GI_Destroy(&index);
+    free(resolved);
+    free(workTree);
+    free(gitDir);
     return err;
 }
+
+/// Counts the given path, using the pool when more than one job was requested.
+CL_Error CL_Count(CLinesApp* self, const char* path) {
+    if (self->cfg.gitMode.val) {
+        return CL_CountGit(self, path);
+    }
+    if (self->pool.workersCount > 0) {
+        return CL_CountParallel(self, path);
+    }
+    return CL_CountRecursive(self, path, 0);
+}
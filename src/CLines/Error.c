@@ -9,6 +9,7 @@
 #include <LocParser.h>
 #include <LocSettings.h>
 #include <StringList.h>
+#include <ThreadPool.h>
 
 #include <stdarg.h>
 #include <stdio.h>
@@ -108,19 +109,27 @@ CL_Error CL_MapAndExceptCL(CLinesApp* self, CL_Error err) {
     case CLE_ListError:
     case CLE_SetError:
     case CLE_LocError:
-        // assume CL_MapAndExceptLCL / CL_MapAndExceptCFG / CL_MapAndExceptINS alredy called
+    case CLE_PoolError:
+        // assume CL_MapAndExceptLCL / CL_MapAndExceptCFG / CL_MapAndExceptINS / CL_MapAndExceptTP alredy called
         break;
 
     case CLE_ReadDirError:
     case CLE_CloseDirError:
     case CLE_FileOpenError:
-    case CLE_FileReadError:
         if (self->errorDetails)
             MSG_ShowError("Failed to open file. (%s)", self->errorDetails);
         else
             MSG_ShowError("Failed to open file.");
         MSG_ShowTip("Are you sure you have read permissions to the specified directories?");
         break;
+
+    case CLE_FileReadError:
+        if (self->errorDetails)
+            MSG_ShowError("Failed to read file. (%s)", self->errorDetails);
+        else
+            MSG_ShowError("Failed to read file.");
+        MSG_ShowTip("Was it truncated while it was being counted?");
+        break;
     case CLE_AllocFailed:
         MSG_ShowError("Internal error.");
         MSG_ShowDebugLog("Out of memory. (malloc failed)");
@@ -140,7 +149,20 @@ CL_Error CL_MapAndExceptCL(CLinesApp* self, CL_Error err) {
         MSG_ShowError("No such file or directory: %s", self->errorDetails);
         break;
     case CLE_RegexError:
-        MSG_ShowError("Invalid Regex.");
+        if (self->errorDetails)
+            MSG_ShowError("Invalid Regex. (%s)", self->errorDetails);
+        else
+            MSG_ShowError("Invalid Regex.");
+        break;
+    case CLE_NotAGitRepo:
+        MSG_ShowError("Not inside a git repository: %s", self->errorDetails);
+        MSG_ShowTip("--git lists files from .git/index, leave it out to walk the directory instead.");
+        break;
+    case CLE_GitIndexError:
+        MSG_ShowError("Failed to read the git index. (%s)", self->errorDetails);
+        break;
+    case CLE_WatchError:
+        MSG_ShowError("Cannot watch for changes: %s", self->errorDetails);
         break;
     }
 
@@ -165,6 +187,26 @@ CL_Error CL_MapAndExceptINS(CLinesApp* self, INS_Error inerr) {
     return CLE_SetError;
 }
 
+CL_Error CL_MapAndExceptTP(CLinesApp* self, TP_Error tperr) {
+    switch (tperr) {
+    case TPE_Ok:
+        return CLE_Ok;
+    case TPE_AllocFailed:
+        MSG_ShowError("Internal error.");
+        MSG_ShowDebugLog("ThreadPool: Out of memory (malloc failed).");
+        break;
+    case TPE_ThreadError:
+        MSG_ShowError("Failed to start worker threads.");
+        break;
+    case TPE_InvalidArgument:
+        MSG_ShowError("Internal error.");
+        MSG_ShowDebugLog("ThreadPool: InvalidArgument");
+        break;
+    }
+
+    return CLE_PoolError;
+}
+
 CL_Error MapAndExceptLP(CLinesApp* self, LP_Error lperr) {
     switch (lperr) {
     case LPE_Ok:
@@ -176,6 +218,12 @@ CL_Error MapAndExceptLP(CLinesApp* self, LP_Error lperr) {
         MSG_ShowError("Error counting lines in file: %s. Unterminated string or comment", self->errorDetails);
     case LPE_FileOpenError:
         return CLE_FileOpenError;
+    case LPE_FileReadError:
+        return CLE_FileReadError;
+    case LPE_TooManyDelims:
+        MSG_ShowError("Internal error.");
+        MSG_ShowDebugLog("LocMatcher: too many delimiters in language definition.");
+        return CLE_InternalError;
     }
 
     return CLE_InternalError;
@@ -0,0 +1,670 @@
+#include <CLines/App.h>
+#include <Log.h>
+#include <Utils.h>
+
+#include <Definitions.h>
+#include <DirWatcher.h>
+#include <IgnoreRules.h>
+#include <INodeSet.h>
+#include <LineCounterList.h>
+#include <ResultCache.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Events after which a file is counted again even if its size and mtime look the same.
+#define CL_CONTENT_EVENTS (IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO)
+
+typedef struct CL_PathSlot {
+    const char* key; ///< NULL for an empty slot, owned by what the index points to
+    uint64_t hash;
+    usize index;
+} CL_PathSlot;
+
+/// Open addressing table from a path to an index (of CLinesApp.files or CL_WatchState.dirs).
+typedef struct CL_PathIndex {
+    CL_PathSlot* slots;
+    usize mask;
+    usize len;
+} CL_PathIndex;
+
+/**
+ * State of --watch: every directory the traversal entered (see CL_WatchDir) and where each
+ * counted file and directory is, so a change costs a rescan of its directory and a count
+ * of the changed files only. Files keep their place in CLinesApp.files, removed ones are
+ * swapped with the last.
+ */
+typedef struct CL_WatchState {
+    DirWatcher watcher;
+    pthread_mutex_t lock; ///< directories are recorded by workers in parallel mode
+    bool warnedLimit;
+    bool updating; ///< something changed in this round, the header is printed
+
+    CL_WatchedDir* dirs;
+    usize dirsLen;
+    usize dirsCap;
+
+    CL_PathIndex dirIndex;
+    CL_PathIndex fileIndex;
+
+    usize* byWd; ///< wd -> index in dirs + 1, 0 for watches that are gone
+    usize byWdCap;
+} CL_WatchState;
+
+static uint64_t CL_HashPath(const char* path) {
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a
+    for (const char* p = path; *p; ++p) {
+        hash ^= (unsigned char)*p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// The slot of key, or the empty slot where it would go.
+static usize CL_FindSlot(const CL_PathIndex* self, const char* key, uint64_t hash) {
+    for (usize i = hash & self->mask;; i = (i + 1) & self->mask) {
+        const CL_PathSlot* slot = &self->slots[i];
+        if (slot->key == NULL) return i;
+        if (slot->hash == hash && strcmp(slot->key, key) == 0) return i;
+    }
+}
+
+static CL_Error CL_IndexGrow(CL_PathIndex* self) {
+    usize newCap = self->slots != NULL ? (self->mask + 1) * 2 : 64;
+    CL_PathSlot* slots = calloc(newCap, sizeof(CL_PathSlot));
+    if (slots == NULL) return CLE_AllocFailed;
+
+    CL_PathIndex grown = { .slots = slots, .mask = newCap - 1, .len = self->len };
+    for (usize i = 0; self->slots != NULL && i <= self->mask; ++i) {
+        if (self->slots[i].key == NULL) continue;
+        slots[CL_FindSlot(&grown, self->slots[i].key, self->slots[i].hash)] = self->slots[i];
+    }
+
+    free(self->slots);
+    *self = grown;
+    return CLE_Ok;
+}
+
+/// Maps key to index, replacing what it was mapped to. key has to live as long as it is in the index.
+static CL_Error CL_IndexPut(CL_PathIndex* self, const char* key, usize index) {
+    if (self->slots == NULL || (self->len + 1) * 2 > self->mask + 1) {
+        CL_Error err = CL_IndexGrow(self);
+        if (err != CLE_Ok) return err;
+    }
+
+    uint64_t hash = CL_HashPath(key);
+    CL_PathSlot* slot = &self->slots[CL_FindSlot(self, key, hash)];
+    if (slot->key == NULL) self->len++;
+    *slot = (CL_PathSlot) { .key = key, .hash = hash, .index = index };
+    return CLE_Ok;
+}
+
+static bool CL_IndexGet(const CL_PathIndex* self, const char* key, usize* out) {
+    if (self->len == 0) return false;
+
+    const CL_PathSlot* slot = &self->slots[CL_FindSlot(self, key, CL_HashPath(key))];
+    if (slot->key == NULL) return false;
+
+    *out = slot->index;
+    return true;
+}
+
+static void CL_IndexRemove(CL_PathIndex* self, const char* key) {
+    if (self->len == 0) return;
+
+    usize hole = CL_FindSlot(self, key, CL_HashPath(key));
+    if (self->slots[hole].key == NULL) return;
+
+    // shift the rest of the cluster back, so lookups never stop at the hole too early
+    for (usize i = (hole + 1) & self->mask; self->slots[i].key != NULL; i = (i + 1) & self->mask) {
+        usize home = self->slots[i].hash & self->mask;
+        bool reachable = hole <= i ? (home <= hole || home > i) : (home <= hole && home > i);
+        if (!reachable) continue;
+
+        self->slots[hole] = self->slots[i];
+        hole = i;
+    }
+
+    self->slots[hole].key = NULL;
+    self->len--;
+}
+
+static void CL_IndexDestroy(CL_PathIndex* self) {
+    free(self->slots);
+    memset(self, 0, sizeof(*self));
+}
+
+/// Whether path is below the directory dir (formatted the way CL_ScanDir formats its entries).
+static bool CL_IsBelow(const char* path, const char* dir, usize dirLen) {
+    if (strncmp(path, dir, dirLen) != 0) return false;
+    if (dirLen > 0 && dir[dirLen - 1] == '/') return path[dirLen] != '\0';
+    return path[dirLen] == '/';
+}
+
+/// path/name, formatted like the entries of CL_ScanDir.
+static char* CL_JoinPath(const char* path, const char* name) {
+    usize pathLen = strlen(path);
+    bool hasTrailingSlash = pathLen > 0 && path[pathLen - 1] == '/';
+
+    usize len = pathLen + (hasTrailingSlash ? 0 : 1) + strlen(name) + 1;
+    char* joined = malloc(len);
+    if (joined != NULL) snprintf(joined, len, "%s%s%s", path, hasTrailingSlash ? "" : "/", name);
+    return joined;
+}
+
+CL_Error CL_StartWatch(CLinesApp* self) {
+    if (self->cfg.includedPaths.len > 1) {
+        CL_SetErrorDetails(self, "--watch takes a single path");
+        return CLE_WatchError;
+    }
+    if (self->cfg.gitMode.val) {
+        CL_SetErrorDetails(self, "--watch walks the directory tree, it does not work with --git");
+        return CLE_WatchError;
+    }
+
+    CL_WatchState* watch = calloc(1, sizeof(CL_WatchState));
+    if (watch == NULL) return CLE_AllocFailed;
+
+    DW_Error dwerr = DW_Init(&watch->watcher);
+    if (dwerr != DWE_Ok) {
+        free(watch);
+        if (dwerr == DWE_AllocFailed) return CLE_AllocFailed;
+
+        CL_SetErrorDetails(self, "inotify is not available");
+        return CLE_WatchError;
+    }
+
+    pthread_mutex_init(&watch->lock, NULL);
+    self->watch = watch;
+
+    // changed files are counted right when editors and log rotation truncate and rewrite them,
+    // read() just sees them shorter where a mapping would fault
+    self->cfg.mmapThreshold = 0;
+    return CLE_Ok;
+}
+
+/// Drops the record of a directory (not its entries), the last record takes its place.
+static void CL_ForgetDir(CLinesApp* self, usize at) {
+    CL_WatchState* watch = self->watch;
+    CL_WatchedDir* dir = &watch->dirs[at];
+
+    if (dir->wd >= 0) {
+        DW_Remove(&watch->watcher, dir->wd);
+        if ((usize)dir->wd < watch->byWdCap) watch->byWd[dir->wd] = 0;
+    }
+    CL_IndexRemove(&watch->dirIndex, dir->path);
+
+    // the root is not one of the counted directories
+    if (dir->depth > 0) {
+        self->dirCount--;
+        INSS_Remove(&self->seen, dir->inode);
+    }
+
+    free(dir->path);
+    free(dir->resolved);
+    IG_Free(dir->ownIgnore);
+
+    usize last = --watch->dirsLen;
+    if (at == last) return;
+
+    watch->dirs[at] = watch->dirs[last];
+    dir = &watch->dirs[at];
+    CL_IndexPut(&watch->dirIndex, dir->path, at); // only replaces the index of an existing key
+    if (dir->wd >= 0) watch->byWd[dir->wd] = at + 1;
+}
+
+void CL_StopWatch(CLinesApp* self) {
+    CL_WatchState* watch = self->watch;
+    if (watch == NULL) return;
+
+    while (watch->dirsLen > 0) CL_ForgetDir(self, watch->dirsLen - 1);
+    free(watch->dirs);
+    free(watch->byWd);
+    CL_IndexDestroy(&watch->dirIndex);
+    CL_IndexDestroy(&watch->fileIndex);
+
+    DW_Destroy(&watch->watcher);
+    pthread_mutex_destroy(&watch->lock);
+    free(watch);
+    self->watch = NULL;
+}
+
+/// Adds the record, called with the lock held.
+static CL_Error CL_AddWatchedDir(CLinesApp* self, CL_WatchedDir* dir) {
+    CL_WatchState* watch = self->watch;
+
+    if (watch->dirsLen == watch->dirsCap) {
+        usize newCap = watch->dirsCap > 0 ? watch->dirsCap * 2 : 64;
+        CL_WatchedDir* dirs = realloc(watch->dirs, newCap * sizeof(CL_WatchedDir));
+        if (dirs == NULL) return CLE_AllocFailed;
+
+        watch->dirs = dirs;
+        watch->dirsCap = newCap;
+    }
+
+    DW_Error dwerr = DW_Add(&watch->watcher, dir->path, &dir->wd);
+    if (dwerr == DWE_AllocFailed) return CLE_AllocFailed;
+    if (dwerr != DWE_Ok) {
+        dir->wd = -1;
+        if (dwerr == DWE_LimitReached && !watch->warnedLimit) {
+            MSG_ShowWarn("inotify watch limit reached, changes in some directories are not seen");
+            MSG_ShowTip("Raise fs.inotify.max_user_watches to watch all of them.");
+            watch->warnedLimit = true;
+        }
+    }
+
+    if (dir->wd >= 0 && (usize)dir->wd >= watch->byWdCap) {
+        usize newCap = watch->byWdCap > 0 ? watch->byWdCap : 64;
+        while (newCap <= (usize)dir->wd) newCap *= 2;
+
+        usize* byWd = realloc(watch->byWd, newCap * sizeof(usize));
+        if (byWd == NULL) {
+            DW_Remove(&watch->watcher, dir->wd);
+            return CLE_AllocFailed;
+        }
+        memset(byWd + watch->byWdCap, 0, (newCap - watch->byWdCap) * sizeof(usize));
+        watch->byWd = byWd;
+        watch->byWdCap = newCap;
+    }
+
+    usize at = watch->dirsLen;
+    CL_Error err = CL_IndexPut(&watch->dirIndex, dir->path, at);
+    if (err != CLE_Ok) {
+        if (dir->wd >= 0) DW_Remove(&watch->watcher, dir->wd);
+        return err;
+    }
+
+    watch->dirs[watch->dirsLen++] = *dir;
+    if (dir->wd >= 0) watch->byWd[dir->wd] = at + 1;
+    return CLE_Ok;
+}
+
+/**
+ * Records a directory entered by the traversal (open as dirFd) and starts watching it. The
+ * record takes over *ownIgnore, so the rules stay around for rescans. A directory that cannot
+ * be watched (see fs.inotify.max_user_watches) is still counted, its changes are just missed.
+ */
+CL_Error CL_WatchDir(CLinesApp* self, int dirFd, const char* path, const char* resolved, usize depth,
+    const IgnoreRules* ignore, IgnoreRules** ownIgnore) {
+    struct stat st;
+    if (fstat(dirFd, &st) != 0) return CLE_ReadDirError;
+
+    CL_WatchedDir dir = {
+        .path = strdup(path),
+        .resolved = strdup(resolved),
+        .depth = depth,
+        .inode = { .dev = st.st_dev, .ino = st.st_ino },
+        .wd = -1,
+        .ignore = ignore,
+        .ownIgnore = *ownIgnore,
+    };
+    if (dir.path == NULL || dir.resolved == NULL) {
+        free(dir.path);
+        free(dir.resolved);
+        return CLE_AllocFailed;
+    }
+
+    pthread_mutex_lock(&self->watch->lock);
+    CL_Error err = CL_AddWatchedDir(self, &dir);
+    pthread_mutex_unlock(&self->watch->lock);
+
+    if (err != CLE_Ok) {
+        free(dir.path);
+        free(dir.resolved);
+        return err;
+    }
+
+    *ownIgnore = NULL;
+    return CLE_Ok;
+}
+
+/// Prints the header of an update the first time something changes in this round.
+static void CL_BeginUpdate(CLinesApp* self) {
+    if (self->watch->updating) return;
+    self->watch->updating = true;
+
+    char stamp[16] = "";
+    time_t now = time(NULL);
+    struct tm local;
+    if (localtime_r(&now, &local) != NULL) strftime(stamp, sizeof(stamp), "%H:%M:%S", &local);
+
+    printf(BOLD "-------- %s --------" RESET "\n", stamp);
+}
+
+/// Maps the files from index start on (appended since) and prints them.
+static CL_Error CL_IndexFiles(CLinesApp* self, usize start, bool print) {
+    for (usize i = start; i < self->files.len; ++i) {
+        LineCounter f;
+        LCL_Error lcerr = LCL_Get(&self->files, i, &f);
+        if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
+
+        CL_Error err = CL_IndexPut(&self->watch->fileIndex, f.meta.fullPath, i);
+        if (err != CLE_Ok) return err;
+        if (print) CL_PrintFile(self, &f);
+    }
+    return CLE_Ok;
+}
+
+/// Removes the file at index from the list and the totals, the last file takes its place.
+static CL_Error CL_ForgetFile(CLinesApp* self, usize at) {
+    CL_WatchState* watch = self->watch;
+
+    LineCounter f;
+    LCL_Error lcerr = LCL_Get(&self->files, at, &f);
+    if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
+
+    CL_BeginUpdate(self);
+    if (self->cfg.printMode.val || (self->cfg.locEnabled.val && !self->cfg.locSummary.val && f.hasLocStat)) {
+        printf("[-] %s\n", f.toPrint);
+    }
+
+    self->linesCount -= f.lines;
+    CL_SummarizeFile(self, CL_LangOf(&f), &f.locStat, true);
+    self->fileCount--;
+    CL_IndexRemove(&watch->fileIndex, f.meta.fullPath);
+
+    lcerr = LCL_SwapRemove(&self->files, at);
+    if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
+    if (at == self->files.len) return CLE_Ok;
+
+    LCL_Get(&self->files, at, &f);
+    return CL_IndexPut(&watch->fileIndex, f.meta.fullPath, at);
+}
+
+/// Forgets the directory at path with everything below it: its files, subdirectories and their watches.
+static CL_Error CL_ForgetTree(CLinesApp* self, const char* path) {
+    CL_WatchState* watch = self->watch;
+
+    // path may belong to one of the records
+    char* dirPath = strdup(path);
+    if (dirPath == NULL) return CLE_AllocFailed;
+    usize dirLen = strlen(dirPath);
+
+    CL_Error err = CLE_Ok;
+    for (usize i = self->files.len; i > 0 && err == CLE_Ok; --i) {
+        LineCounter f;
+        LCL_Get(&self->files, i - 1, &f);
+        if (CL_IsBelow(f.meta.fullPath, dirPath, dirLen)) err = CL_ForgetFile(self, i - 1);
+    }
+
+    for (usize i = watch->dirsLen; i > 0; --i) {
+        const char* other = watch->dirs[i - 1].path;
+        if (strcmp(other, dirPath) == 0 || CL_IsBelow(other, dirPath, dirLen)) CL_ForgetDir(self, i - 1);
+    }
+
+    CL_BeginUpdate(self);
+    free(dirPath);
+    return err;
+}
+
+/// Counts a file entry that was created or may have changed, and puts it into the list.
+static CL_Error CL_UpdateFile(CLinesApp* self, CL_DirEntry* entry, uint32_t mask) {
+    CL_WatchState* watch = self->watch;
+
+    usize at;
+    bool known = CL_IndexGet(&watch->fileIndex, entry->path, &at);
+    LineCounter f;
+    if (known) {
+        LCL_Get(&self->files, at, &f);
+
+        bool sameMeta = f.meta.size == entry->meta.size && f.meta.mtime == entry->meta.mtime
+            && f.meta.mtimeNsec == entry->meta.mtimeNsec;
+        if (sameMeta && (mask & CL_CONTENT_EVENTS) == 0) return CLE_Ok;
+    }
+
+    entry->job = (CL_FileJob) {0};
+    CL_Error err = CL_CountEntry(self, entry);
+    if (err != CLE_Ok) {
+        // gone or replaced meanwhile, its next event brings it back
+        MSG_ShowDebugLog("watch: could not count %s", entry->path);
+        return known ? CL_ForgetFile(self, at) : CLE_Ok;
+    }
+
+    CL_BeginUpdate(self);
+
+    LCL_Error lcerr;
+    if (known) {
+        self->linesCount -= f.lines;
+        CL_SummarizeFile(self, CL_LangOf(&f), &f.locStat, true);
+        CL_IndexRemove(&watch->fileIndex, f.meta.fullPath);
+        lcerr = LCL_Set(&self->files, at, entry->path, entry->job.lines, &entry->meta, entry->job.locStat,
+            entry->job.hasLocStat);
+    } else {
+        at = self->files.len;
+        lcerr = LCL_Append(&self->files, entry->path, entry->job.lines, &entry->meta, entry->job.locStat,
+            entry->job.hasLocStat);
+        if (lcerr == LCLE_Ok) self->fileCount++;
+    }
+    if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
+    self->linesCount += entry->job.lines;
+    CL_SummarizeFile(self, entry->job.lang, &entry->job.locStat, false);
+
+    LCL_Get(&self->files, at, &f);
+    CL_PrintFile(self, &f);
+    return CL_IndexPut(&watch->fileIndex, f.meta.fullPath, at);
+}
+
+/// Counts a directory that showed up, with everything below it.
+static CL_Error CL_AddDir(CLinesApp* self, const CL_DirEntry* entry, const IgnoreRules* ignore, usize depth) {
+    INS_Error inerr = INSS_Insert(&self->seen, entry->inode);
+    if (inerr == INSE_AlredyExists) return CLE_Ok;
+    if (inerr != INSE_Ok) return CL_MapAndExceptINS(self, inerr);
+
+    CL_BeginUpdate(self);
+    self->dirCount++;
+
+    usize start = self->files.len;
+    CL_Error err = CL_CountDir(self, AT_FDCWD, entry->path, entry->name, entry->resolved, ignore, depth);
+    if (err != CLE_Ok && err != CLE_AllocFailed) {
+        MSG_ShowDebugLog("watch: could not count all of %s", entry->path);
+        err = CLE_Ok;
+    }
+
+    // whatever was counted is in the totals already, so it has to be found again
+    CL_Error indexErr = CL_IndexFiles(self, start, true);
+    return err != CLE_Ok ? err : indexErr;
+}
+
+static int CL_CompareEntryNames(const void* a, const void* b) {
+    return strcmp(((const CL_DirEntry*)a)->name, ((const CL_DirEntry*)b)->name);
+}
+
+/// Brings the entry name of the directory dirPath up to date, entry is its scan (NULL when it is gone).
+static CL_Error CL_UpdateEntry(CLinesApp* self, const char* dirPath, const char* name, CL_DirEntry* entry, uint32_t mask,
+    const IgnoreRules* ignore, usize depth) {
+    CL_WatchState* watch = self->watch;
+
+    char* allocatedPath = NULL;
+    const char* path = entry != NULL ? entry->path : (allocatedPath = CL_JoinPath(dirPath, name));
+    if (path == NULL) return CLE_AllocFailed;
+
+    CL_Error err = CLE_Ok;
+    usize at;
+    if (CL_IndexGet(&watch->dirIndex, path, &at)) {
+        bool sameDir = entry != NULL && entry->isDir && IN_Equals(entry->inode, watch->dirs[at].inode);
+        if (!sameDir) err = CL_ForgetTree(self, path);
+    }
+    if (err == CLE_Ok && (entry == NULL || entry->isDir) && CL_IndexGet(&watch->fileIndex, path, &at)) {
+        err = CL_ForgetFile(self, at);
+    }
+
+    if (err == CLE_Ok && entry != NULL) {
+        if (!entry->isDir) {
+            err = CL_UpdateFile(self, entry, mask);
+        } else if (!CL_IndexGet(&watch->dirIndex, entry->path, &at)) {
+            err = CL_AddDir(self, entry, ignore, depth + 1);
+        }
+    }
+
+    free(allocatedPath);
+    return err;
+}
+
+/// Applies the changes of the watched directory at index at: rescans it and updates the changed entries.
+static CL_Error CL_ApplyDirChanges(CLinesApp* self, usize at, const DW_Change* changes, usize count) {
+    CL_WatchState* watch = self->watch;
+
+    for (usize i = 0; i < count; ++i) {
+        if (changes[i].name == NULL && (changes[i].mask & (IN_DELETE_SELF | IN_MOVE_SELF))) {
+            return CL_ForgetTree(self, watch->dirs[at].path);
+        }
+    }
+
+    // the record may move while new directories are recorded
+    const CL_WatchedDir dir = watch->dirs[at];
+    char* path = strdup(dir.path);
+    char* resolved = strdup(dir.resolved);
+    if (path == NULL || resolved == NULL) {
+        free(path);
+        free(resolved);
+        return CLE_AllocFailed;
+    }
+
+    CL_Error err = CLE_Ok;
+    CL_DirEntry* entries = NULL;
+    usize len = 0;
+
+    // deleted, the event of its parent may not have been read yet. A directory that is still
+    // referenced (like the current one) never gets IN_DELETE_SELF, but it has no links left
+    struct stat st;
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1 || fstat(fd, &st) != 0 || st.st_nlink == 0) {
+        if (fd != -1) close(fd);
+        err = CL_ForgetTree(self, path);
+        goto cleanup;
+    }
+
+    err = CL_ScanDir(self, fd, path, resolved, dir.ignore, &entries, &len);
+    close(fd);
+    if (err != CLE_Ok) {
+        MSG_ShowDebugLog("watch: could not read %s", path);
+        err = err == CLE_AllocFailed ? err : CLE_Ok;
+        goto cleanup;
+    }
+    qsort(entries, len, sizeof(CL_DirEntry), CL_CompareEntryNames);
+
+    for (usize i = 0; i < count && err == CLE_Ok; ++i) {
+        if (changes[i].name == NULL) continue;
+
+        CL_DirEntry key = { .name = changes[i].name };
+        CL_DirEntry* entry = bsearch(&key, entries, len, sizeof(CL_DirEntry), CL_CompareEntryNames);
+        err = CL_UpdateEntry(self, path, changes[i].name, entry, changes[i].mask, dir.ignore, dir.depth);
+    }
+
+cleanup:
+    for (usize i = 0; i < len; ++i) {
+        free(entries[i].path);
+        free(entries[i].resolved);
+    }
+    free(entries);
+    free(path);
+    free(resolved);
+    return err;
+}
+
+/// Whether one of the changes is an ignore file, they decide about whole subtrees (see --ignore-files).
+static bool CL_TouchesIgnoreFiles(CLinesApp* self, const DW_Changes* changes) {
+    if (!self->cfg.ignoreFiles.val) return false;
+
+    static const char* const fileNames[] = IG_FILE_NAMES;
+    for (usize i = 0; i < changes->len; ++i) {
+        if (changes->data[i].name == NULL) continue;
+        for (usize j = 0; j < sizeof(fileNames) / sizeof(fileNames[0]); ++j) {
+            if (strcmp(changes->data[i].name, fileNames[j]) == 0) return true;
+        }
+    }
+    return false;
+}
+
+/// Forgets everything and counts path again, for changes that cannot be applied one by one.
+static CL_Error CL_RecountAll(CLinesApp* self, const char* path) {
+    CL_WatchState* watch = self->watch;
+
+    CL_BeginUpdate(self);
+    while (watch->dirsLen > 0) CL_ForgetDir(self, watch->dirsLen - 1);
+    CL_IndexDestroy(&watch->fileIndex);
+
+    LCL_Error lcerr = LCL_Clear(&self->files);
+    if (lcerr != LCLE_Ok) return CL_MapAndExceptLCL(self, lcerr);
+    INSS_Clear(&self->seen);
+    CL_ResetCounter(self);
+
+    CL_Error err = CL_Count(self, path);
+    if (err != CLE_Ok) return err;
+    return CL_IndexFiles(self, 0, false);
+}
+
+static CL_Error CL_ApplyChanges(CLinesApp* self, const DW_Changes* changes) {
+    CL_WatchState* watch = self->watch;
+
+    // changes come sorted by watch, so each directory is scanned once
+    for (usize i = 0; i < changes->len;) {
+        usize end = i;
+        while (end < changes->len && changes->data[end].wd == changes->data[i].wd) ++end;
+
+        int wd = changes->data[i].wd;
+        if (wd >= 0 && (usize)wd < watch->byWdCap && watch->byWd[wd] != 0) {
+            CL_Error err = CL_ApplyDirChanges(self, watch->byWd[wd] - 1, &changes->data[i], end - i);
+            if (err != CLE_Ok) return err;
+        }
+        i = end;
+    }
+    return CLE_Ok;
+}
+
+/**
+ * Keeps the totals of path (already counted with the watch started) up to date until it is
+ * deleted. Events are coalesced (see DW_Wait), then only the directories they happened in are
+ * rescanned and only the changed files counted again; the changed files (with --print or
+ * --loc) and the fresh totals are printed after every round that changed something.
+ */
+CL_Error CL_Watch(CLinesApp* self, const char* path) {
+    CL_WatchState* watch = self->watch;
+    if (watch->dirsLen == 0) {
+        CL_SetErrorDetailsf(self, "%s is not a directory", path);
+        return CLE_WatchError;
+    }
+
+    // only changed files are counted from now on, remembering them is not worth it
+    if (self->cacheEnabled) {
+        RC_Destroy(&self->cache);
+        self->cacheEnabled = false;
+    }
+
+    CL_Error err = CL_IndexFiles(self, 0, false);
+    fflush(stdout);
+
+    DW_Changes changes = {0};
+    while (err == CLE_Ok && watch->dirsLen > 0) {
+        DW_Error dwerr = DW_Wait(&watch->watcher, DW_DEFAULT_DELAY_MS, &changes);
+        if (dwerr != DWE_Ok) {
+            CL_SetErrorDetails(self, "failed to read inotify events");
+            err = dwerr == DWE_AllocFailed ? CLE_AllocFailed : CLE_WatchError;
+            break;
+        }
+
+        if (changes.overflow || CL_TouchesIgnoreFiles(self, &changes)) {
+            err = CL_RecountAll(self, path);
+        } else {
+            err = CL_ApplyChanges(self, &changes);
+        }
+
+        if (watch->updating) {
+            CL_PrintTotals(self);
+            fflush(stdout);
+            watch->updating = false;
+        }
+    }
+
+    DW_FreeChanges(&changes);
+    return err;
+}
@@ -1,5 +1,6 @@
 #include <Config.h>
 #include <Definitions.h>
+#include <FileReader.h>
 #include <StringList.h>
 #include <Utils.h>
 
@@ -31,9 +32,27 @@ CFG_Error CFG_SetDebugMode(Config* self, bool value) {
 CFG_Error CFG_SetLocEnabled(Config* self, bool value) {
     return SetSwitch(&self->locEnabled, value);
 }
+CFG_Error CFG_SetLocSummary(Config* self, bool value) {
+    return SetSwitch(&self->locSummary, value);
+}
 CFG_Error CFG_SetShowHidden(Config* self, bool value) {
     return SetSwitch(&self->showHidden, value);
 }
+CFG_Error CFG_SetIoUring(Config* self, bool value) {
+    return SetSwitch(&self->ioUring, value);
+}
+CFG_Error CFG_SetUseCache(Config* self, bool value) {
+    return SetSwitch(&self->useCache, value);
+}
+CFG_Error CFG_SetGitMode(Config* self, bool value) {
+    return SetSwitch(&self->gitMode, value);
+}
+CFG_Error CFG_SetIgnoreFiles(Config* self, bool value) {
+    return SetSwitch(&self->ignoreFiles, value);
+}
+CFG_Error CFG_SetWatch(Config* self, bool value) {
+    return SetSwitch(&self->watch, value);
+}
 
 CFG_Error CFG_SetShowHelp(Config* self, bool value) {
     return SetSwitch(&self->showHelp, value);
@@ -81,6 +100,39 @@ static inline bool parseInt(const char* input, long long* out) {
     return true;
 }
 
+// Accepts plain numbers and K/M/G suffixes (powers of 1024).
+static inline bool parseSize(const char* input, usize* out) {
+    errno = 0;
+    char* end;
+    long long val = strtoll(input, &end, 10);
+
+    if (errno == ERANGE || end == input || val < 0) return false;
+
+    usize multiplier = 1;
+    switch (*end) {
+    case '\0':
+        break;
+    case 'k': case 'K':
+        multiplier = 1024;
+        end++;
+        break;
+    case 'm': case 'M':
+        multiplier = 1024 * 1024;
+        end++;
+        break;
+    case 'g': case 'G':
+        multiplier = 1024 * 1024 * 1024;
+        end++;
+        break;
+    default:
+        return false;
+    }
+    if (*end != '\0') return false;
+
+    *out = (usize)val * multiplier;
+    return true;
+}
+
 CFG_Error CFG_SetMaxDepth(Config* self, usize maxDepth) {
     if (self->maxDepthSetted) {
         return CFGE_RedeclaredFlag;
@@ -122,7 +174,7 @@ CFG_Error CFG_SetTopStr(Config* self, const char* topStr) {
     }
 
     long long top = 0;
-    if (!parseInt(topStr, &top)) {
+    if (!parseInt(topStr, &top) || top < 0) {
         return CFGE_InvalidInputNumber;
     }
 
@@ -131,6 +183,66 @@ CFG_Error CFG_SetTopStr(Config* self, const char* topStr) {
     return CFGE_Ok;
 }
 
+CFG_Error CFG_SetJobs(Config* self, usize jobs) {
+    if (self->jobsSetted) {
+        return CFGE_RedeclaredFlag;
+    }
+
+    self->jobs = jobs;
+    self->jobsSetted = true;
+    return CFGE_Ok;
+}
+
+CFG_Error CFG_SetJobsStr(Config* self, const char* jobsStr) {
+    if (self->jobsSetted) {
+        return CFGE_RedeclaredFlag;
+    }
+
+    long long jobs = 0;
+    if (!parseInt(jobsStr, &jobs) || jobs < 0) {
+        return CFGE_InvalidInputNumber;
+    }
+
+    self->jobs = (usize)jobs;
+    self->jobsSetted = true;
+    return CFGE_Ok;
+}
+
+CFG_Error CFG_SetMmapThreshold(Config* self, usize threshold) {
+    if (self->mmapThresholdSetted) {
+        return CFGE_RedeclaredFlag;
+    }
+
+    self->mmapThreshold = threshold;
+    self->mmapThresholdSetted = true;
+    return CFGE_Ok;
+}
+
+CFG_Error CFG_SetMmapThresholdStr(Config* self, const char* thresholdStr) {
+    if (self->mmapThresholdSetted) {
+        return CFGE_RedeclaredFlag;
+    }
+
+    usize threshold = 0;
+    if (!parseSize(thresholdStr, &threshold)) {
+        return CFGE_InvalidInputNumber;
+    }
+
+    self->mmapThreshold = threshold;
+    self->mmapThresholdSetted = true;
+    return CFGE_Ok;
+}
+
+CFG_Error CFG_SetCachePath(Config* self, const char* path) {
+    if (self->cachePath != NULL) {
+        return CFGE_RedeclaredFlag;
+    }
+
+    self->cachePath = strdup(path);
+    if (self->cachePath == NULL) return CFGE_AllocFailed;
+    return CFGE_Ok;
+}
+
 CFG_Error CFG_SetReverse(Config* self, bool reverse) {
     return SetSwitch(&self->reverse, reverse);
 }
@@ -179,6 +291,8 @@ CFG_Error CFG_Init(Config* self) {
     self->errorDetails = NULL;
     self->maxDepth = 0;
     self->maxDepthSetted = false;
+    self->top = 0;
+    self->topSetted = false;
 
     self->sortMode = _SM_NotSetted;
 
@@ -212,13 +326,23 @@ CFG_Error CFG_Destroy(Config* self) {
 
     free(self->errorDetails);
     self->errorDetails = NULL;
+    free(self->cachePath);
+    self->cachePath = NULL;
 
     self->maxDepth = 0;
     self->maxDepthSetted = false;
+    self->top = 0;
+    self->topSetted = false;
     self->printMode  =  (CFG_Switch) { false, false };
     self->recursive  =  (CFG_Switch) { false, false };
     self->reverse    =  (CFG_Switch) { false, false };
     self->showHidden =  (CFG_Switch) { false, false };
+    self->ioUring    =  (CFG_Switch) { false, false };
+    self->useCache   =  (CFG_Switch) { false, false };
+    self->gitMode    =  (CFG_Switch) { false, false };
+    self->ignoreFiles = (CFG_Switch) { false, false };
+    self->watch      =  (CFG_Switch) { false, false };
+    self->locSummary =  (CFG_Switch) { false, false };
     self->sortMode = _SM_NotSetted;
 
     self->mode = CFGM_Pass;
@@ -305,12 +429,48 @@ CFG_Error CFG_HandleLongOption(Config* self, const char* flag) {
     } else if (StrEql(flag, "no-loc")) {
         CFG_Error err = CFG_SetLocEnabled(self, false);
         if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "loc-summary")) {
+        CFG_Error err = CFG_SetLocSummary(self, true);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "no-loc-summary")) {
+        CFG_Error err = CFG_SetLocSummary(self, false);
+        if (err != CFGE_Ok) return err;
     } else if (StrEql(flag, "show-hidden")) {
         CFG_Error err = CFG_SetShowHidden(self, true);
         if (err != CFGE_Ok) return err;
     } else if (StrEql(flag, "no-show-hidden")) {
         CFG_Error err = CFG_SetShowHidden(self, false);
         if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "io-uring")) {
+        CFG_Error err = CFG_SetIoUring(self, true);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "no-io-uring")) {
+        CFG_Error err = CFG_SetIoUring(self, false);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "cache")) {
+        CFG_Error err = CFG_SetUseCache(self, true);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "no-cache")) {
+        CFG_Error err = CFG_SetUseCache(self, false);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "git")) {
+        CFG_Error err = CFG_SetGitMode(self, true);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "no-git")) {
+        CFG_Error err = CFG_SetGitMode(self, false);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "ignore-files")) {
+        CFG_Error err = CFG_SetIgnoreFiles(self, true);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "no-ignore-files")) {
+        CFG_Error err = CFG_SetIgnoreFiles(self, false);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "watch")) {
+        CFG_Error err = CFG_SetWatch(self, true);
+        if (err != CFGE_Ok) return err;
+    } else if (StrEql(flag, "no-watch")) {
+        CFG_Error err = CFG_SetWatch(self, false);
+        if (err != CFGE_Ok) return err;
     }
 
     else if (StrEql(flag, "ext") || StrEql(flag, "include-ext")) {
@@ -330,6 +490,18 @@ CFG_Error CFG_HandleLongOption(Config* self, const char* flag) {
     else if (HasPrefix(flag, "max-depth=")) {
         CFG_Error err = CFG_SetMaxDepthStr(self, flag + strlen("max-depth="));
         if (err != CFGE_Ok) return err;
+    } else if (HasPrefix(flag, "top=")) {
+        CFG_Error err = CFG_SetTopStr(self, flag + strlen("top="));
+        if (err != CFGE_Ok) return err;
+    } else if (HasPrefix(flag, "jobs=")) {
+        CFG_Error err = CFG_SetJobsStr(self, flag + strlen("jobs="));
+        if (err != CFGE_Ok) return err;
+    } else if (HasPrefix(flag, "mmap-threshold=")) {
+        CFG_Error err = CFG_SetMmapThresholdStr(self, flag + strlen("mmap-threshold="));
+        if (err != CFGE_Ok) return err;
+    } else if (HasPrefix(flag, "cache=")) {
+        CFG_Error err = CFG_SetCachePath(self, flag + strlen("cache="));
+        if (err != CFGE_Ok) return err;
     } else if (HasPrefix(flag, "sort=")) {
         CFG_Error err = CFG_SetSortModeStr(self, flag + strlen("sort="), false);
         if (err != CFGE_Ok) return err;
@@ -359,7 +531,15 @@ CFG_Error CFG_SetDefauts(Config* self) {
     const bool defaultVerboseVal = false;
     const bool defaultReverseVal = false;
     const bool defaultShowHiddenVal = false;
+    const bool defaultIoUringVal = false;
+    const bool defaultUseCacheVal = false;
+    const bool defaultGitModeVal = false;
+    const bool defaultIgnoreFilesVal = false;
+    const bool defaultWatchVal = false;
+    const bool defaultLocSummaryVal = false;
     const usize defaultMaxDepthVal = 50;
+    const usize defaultJobsVal = 1;
+    const usize defaultMmapThresholdVal = FR_DEFAULT_MMAP_THRESHOLD;
     const char* const defaultPathVal = ".";
 
     CFG_Error err = CFGE_Ok;
@@ -375,10 +555,39 @@ CFG_Error CFG_SetDefauts(Config* self) {
     if (!self->showHidden.setted) {
         err = CFG_SetShowHidden(self, defaultShowHiddenVal);
     }
+    if (!self->ioUring.setted) {
+        err = CFG_SetIoUring(self, defaultIoUringVal);
+    }
+    if (!self->useCache.setted) {
+        // a cache file of its own is asked for with --cache={path} alone
+        err = CFG_SetUseCache(self, defaultUseCacheVal || self->cachePath != NULL);
+    }
+    if (!self->gitMode.setted) {
+        err = CFG_SetGitMode(self, defaultGitModeVal);
+    }
+    if (!self->ignoreFiles.setted) {
+        err = CFG_SetIgnoreFiles(self, defaultIgnoreFilesVal);
+    }
+    if (!self->watch.setted) {
+        err = CFG_SetWatch(self, defaultWatchVal);
+    }
+    if (!self->locSummary.setted) {
+        err = CFG_SetLocSummary(self, defaultLocSummaryVal);
+    }
+    if (self->locSummary.val && !self->locEnabled.setted) {
+        // the summary is made of loc statistics
+        err = CFG_SetLocEnabled(self, true);
+    }
 
     if (!self->maxDepthSetted) {
         err = CFG_SetMaxDepth(self, defaultMaxDepthVal);
     }
+    if (!self->jobsSetted) {
+        err = CFG_SetJobs(self, defaultJobsVal);
+    }
+    if (!self->mmapThresholdSetted) {
+        err = CFG_SetMmapThreshold(self, defaultMmapThresholdVal);
+    }
     if (self->includedPaths.len <= 0) {
         SL_Append(&self->includedPaths, defaultPathVal);
     }
@@ -484,7 +693,13 @@ CFG_Error CFG_DebugPrint(Config* self, FILE* out, const char* indent) {
         &self->reverse,
         &self->debugMode,
         &self->locEnabled,
+        &self->locSummary,
         &self->showHidden,
+        &self->ioUring,
+        &self->useCache,
+        &self->gitMode,
+        &self->ignoreFiles,
+        &self->watch,
         &self->showHelp,
         &self->showVersion,
         &self->showRepo,
@@ -495,7 +710,13 @@ CFG_Error CFG_DebugPrint(Config* self, FILE* out, const char* indent) {
         "reverse",
         "debugMode",
         "locEnabled",
+        "locSummary",
         "showHidden",
+        "ioUring",
+        "useCache",
+        "gitMode",
+        "ignoreFiles",
+        "watch",
         "showHelp",
         "showVersion",
         "showRepo",
@@ -510,6 +731,13 @@ CFG_Error CFG_DebugPrint(Config* self, FILE* out, const char* indent) {
     fprintf(out, "%s.maxDepth = %zu\n", indent, self->maxDepth);
     fprintf(out, "%s.maxDepthSetted = %s\n", indent, s(self->maxDepthSetted));
 
+    fprintf(out, "%s.top = %zu\n", indent, self->top);
+    fprintf(out, "%s.topSetted = %s\n", indent, s(self->topSetted));
+
+    fprintf(out, "%s.jobs = %zu\n", indent, self->jobs);
+    fprintf(out, "%s.mmapThreshold = %zu\n", indent, self->mmapThreshold);
+    fprintf(out, "%s.cachePath = '%s'\n", indent, self->cachePath);
+
     fprintf(out, "%s.sortMode = %d\n", indent, self->sortMode);
 
     fprintf(out, "%s.errorDetails = '%s'\n", indent, self->errorDetails);
@@ -0,0 +1,154 @@
+#include <DirReader.h>
+
+#include <Definitions.h>
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#    include <sys/syscall.h>
+#    if defined(SYS_getdents64)
+#        define DR_HAS_GETDENTS64
+#    endif
+#endif
+
+static const char* const backendNames[DRB_Count] = {
+    [DRB_Readdir] = "readdir",
+    [DRB_Getdents64] = "getdents64",
+};
+
+/// Set when the kernel answered ENOSYS (seccomp filters, emulators), readdir is used from then on.
+static atomic_bool getdentsMissing = false;
+
+#ifdef DR_HAS_GETDENTS64
+/// Layout of the records written by getdents64, fields are read with memcpy since buf may not be aligned.
+typedef struct DR_LinuxDirent64 {
+    uint64_t ino;
+    int64_t off;
+    unsigned short reclen;
+    unsigned char type;
+    char name[];
+} DR_LinuxDirent64;
+#endif
+
+static DR_Error DR_OpenReaddir(DirReader* self) {
+    int fd = dup(self->fd);
+    if (fd == -1) return DRE_OpenError;
+
+    self->dir = fdopendir(fd);
+    if (self->dir == NULL) {
+        close(fd);
+        return DRE_OpenError;
+    }
+
+    self->backend = DRB_Readdir;
+    return DRE_Ok;
+}
+
+DR_Error DR_OpenWith(DirReader* self, DR_Backend backend, int fd, char* buf, usize bufCap) {
+    *self = (DirReader) { .backend = backend, .fd = fd, .buf = buf, .bufCap = bufCap };
+
+    if (backend == DRB_Getdents64 && DR_IsSupported(backend) && buf != NULL && bufCap >= 512) {
+        return DRE_Ok;
+    }
+    return DR_OpenReaddir(self);
+}
+
+DR_Error DR_Open(DirReader* self, int fd, char* buf, usize bufCap) {
+    return DR_OpenWith(self, DR_BestBackend(), fd, buf, bufCap);
+}
+
+#ifdef DR_HAS_GETDENTS64
+static DR_Error DR_NextGetdents64(DirReader* self, DR_Entry* outEntry) {
+    if (self->pos >= self->len) {
+        if (self->done) return DRE_Ok;
+
+        long res = syscall(SYS_getdents64, self->fd, self->buf, self->bufCap);
+        if (res < 0) {
+            if (errno == ENOSYS && self->len == 0) {
+                // nothing was read yet, so readdir can take over from the start
+                atomic_store(&getdentsMissing, true);
+                if (DR_OpenReaddir(self) != DRE_Ok) return DRE_ReadError;
+                return DR_Next(self, outEntry);
+            }
+            return DRE_ReadError;
+        }
+        if (res == 0) {
+            self->done = true;
+            return DRE_Ok;
+        }
+
+        self->pos = 0;
+        self->len = (usize)res;
+    }
+
+    const char* record = self->buf + self->pos;
+    unsigned short reclen;
+    memcpy(&reclen, record + offsetof(DR_LinuxDirent64, reclen), sizeof(reclen));
+    if (reclen == 0 || self->pos + reclen > self->len) return DRE_ReadError;
+    memcpy(&outEntry->type, record + offsetof(DR_LinuxDirent64, type), sizeof(outEntry->type));
+    outEntry->name = record + offsetof(DR_LinuxDirent64, name);
+
+    self->pos += reclen;
+    return DRE_Ok;
+}
+#endif
+
+DR_Error DR_Next(DirReader* self, DR_Entry* outEntry) {
+    *outEntry = (DR_Entry) {0};
+
+#ifdef DR_HAS_GETDENTS64
+    if (self->backend == DRB_Getdents64) return DR_NextGetdents64(self, outEntry);
+#endif
+
+    if (self->dir == NULL) return DRE_ReadError;
+
+    errno = 0;
+    struct dirent* entry = readdir(self->dir);
+    if (entry == NULL) return errno != 0 ? DRE_ReadError : DRE_Ok;
+
+    outEntry->name = entry->d_name;
+    outEntry->type = entry->d_type;
+    return DRE_Ok;
+}
+
+DR_Error DR_Close(DirReader* self) {
+    DR_Error err = DRE_Ok;
+    if (self->dir != NULL && closedir(self->dir) == -1) err = DRE_ReadError;
+
+    self->dir = NULL;
+    self->fd = -1;
+    return err;
+}
+
+bool DR_IsSupported(DR_Backend backend) {
+    switch (backend) {
+    case DRB_Readdir:
+        return true;
+    case DRB_Getdents64:
+#ifdef DR_HAS_GETDENTS64
+        return !atomic_load(&getdentsMissing);
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+DR_Backend DR_BestBackend() {
+    return DR_IsSupported(DRB_Getdents64) ? DRB_Getdents64 : DRB_Readdir;
+}
+
+const char* DR_BackendName(DR_Backend backend) {
+    if (backend >= DRB_Count) return "unknown";
+    return backendNames[backend];
+}
@@ -0,0 +1,175 @@
+#include <DirWatcher.h>
+
+#include <Definitions.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#define DW_MASK                                                                                                        \
+    (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF     \
+        | IN_MOVE_SELF | IN_ONLYDIR)
+
+#ifndef DW_READ_BUF_SIZE
+#    define DW_READ_BUF_SIZE (64 * 1024)
+#endif
+
+DW_Error DW_Init(DirWatcher* self) {
+    self->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (self->fd == -1) return errno == ENOMEM ? DWE_AllocFailed : DWE_Unsupported;
+    return DWE_Ok;
+}
+
+void DW_Destroy(DirWatcher* self) {
+    if (self->fd != -1) close(self->fd);
+    self->fd = -1;
+}
+
+DW_Error DW_Add(DirWatcher* self, const char* path, int* outWd) {
+    *outWd = inotify_add_watch(self->fd, path, DW_MASK);
+    if (*outWd != -1) return DWE_Ok;
+
+    switch (errno) {
+    case ENOSPC:
+    case EMFILE:
+        return DWE_LimitReached;
+    case ENOMEM:
+        return DWE_AllocFailed;
+    default:
+        return DWE_WatchFailed;
+    }
+}
+
+void DW_Remove(DirWatcher* self, int wd) {
+    // the kernel already dropped watches of deleted directories
+    inotify_rm_watch(self->fd, wd);
+}
+
+void DW_FreeChanges(DW_Changes* self) {
+    for (usize i = 0; i < self->len; ++i) free(self->data[i].name);
+    free(self->data);
+    memset(self, 0, sizeof(*self));
+}
+
+static DW_Error DW_Push(DW_Changes* self, const struct inotify_event* event) {
+    if (self->len == self->cap) {
+        usize newCap = self->cap > 0 ? self->cap * 2 : 64;
+        DW_Change* data = realloc(self->data, newCap * sizeof(DW_Change));
+        if (data == NULL) return DWE_AllocFailed;
+
+        self->data = data;
+        self->cap = newCap;
+    }
+
+    char* name = NULL;
+    if (event->len > 0 && event->name[0] != '\0') {
+        name = strdup(event->name);
+        if (name == NULL) return DWE_AllocFailed;
+    }
+
+    self->data[self->len++] = (DW_Change) { .wd = event->wd, .name = name, .mask = event->mask };
+    return DWE_Ok;
+}
+
+/// Reads every pending event into out, returns DWE_Ok with nothing read when there are none.
+static DW_Error DW_ReadPending(DirWatcher* self, DW_Changes* out, bool* gotAny) {
+    char buf[DW_READ_BUF_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    for (;;) {
+        ssize_t n = read(self->fd, buf, sizeof(buf));
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return DWE_Ok;
+            return DWE_ReadFailed;
+        }
+        if (n == 0) return DWE_Ok;
+
+        for (char* p = buf; p < buf + n;) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + event->len;
+            *gotAny = true;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                out->overflow = true;
+                continue;
+            }
+            if (event->mask & IN_IGNORED) continue;
+
+            DW_Error err = DW_Push(out, event);
+            if (err != DWE_Ok) return err;
+        }
+    }
+}
+
+static int DW_CompareChanges(const void* a, const void* b) {
+    const DW_Change* ca = a;
+    const DW_Change* cb = b;
+    if (ca->wd != cb->wd) return ca->wd < cb->wd ? -1 : 1;
+    if (ca->name == NULL || cb->name == NULL) return (ca->name != NULL) - (cb->name != NULL);
+    return strcmp(ca->name, cb->name);
+}
+
+/// Sorts the changes and merges the ones of the same entry.
+static void DW_Coalesce(DW_Changes* self) {
+    if (self->len == 0) return;
+    qsort(self->data, self->len, sizeof(DW_Change), DW_CompareChanges);
+
+    usize kept = 0;
+    for (usize i = 1; i < self->len; ++i) {
+        DW_Change* last = &self->data[kept];
+        if (DW_CompareChanges(last, &self->data[i]) == 0) {
+            last->mask |= self->data[i].mask;
+            free(self->data[i].name);
+        } else {
+            self->data[++kept] = self->data[i];
+        }
+    }
+    self->len = kept + 1;
+}
+
+static int64_t DW_NowMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+DW_Error DW_Wait(DirWatcher* self, int delayMs, DW_Changes* out) {
+    for (usize i = 0; i < out->len; ++i) free(out->data[i].name);
+    out->len = 0;
+    out->overflow = false;
+
+    struct pollfd pfd = { .fd = self->fd, .events = POLLIN };
+    int64_t deadline = -1;
+
+    for (;;) {
+        int timeout = -1;
+        if (deadline >= 0) {
+            int64_t left = deadline - DW_NowMs();
+            if (left <= 0) break;
+            timeout = (int)(left < delayMs ? left : delayMs);
+        }
+
+        int ready = poll(&pfd, 1, timeout);
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+            return DWE_ReadFailed;
+        }
+        if (ready == 0) break; // quiet for delayMs
+
+        bool gotAny = false;
+        DW_Error err = DW_ReadPending(self, out, &gotAny);
+        if (err != DWE_Ok) return err;
+
+        // the window starts with the first event
+        if (gotAny && deadline < 0) deadline = DW_NowMs() + DW_MAX_DELAY_MS;
+    }
+
+    DW_Coalesce(out);
+    return DWE_Ok;
+}
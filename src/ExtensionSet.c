@@ -0,0 +1,76 @@
+#include <ExtensionSet.h>
+
+#include <Definitions.h>
+#include <StringList.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint64_t ES_Hash(const char* ext, usize len) {
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a
+    for (usize i = 0; i < len; ++i) {
+        hash ^= (unsigned char)ext[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static const ES_Slot* ES_Find(const ExtensionSet* self, const char* ext, usize len, uint64_t hash) {
+    for (usize i = hash & self->mask;; i = (i + 1) & self->mask) {
+        const ES_Slot* slot = &self->slots[i];
+        if (slot->ext == NULL) return NULL;
+        if (slot->hash == hash && slot->len == len && memcmp(slot->ext, ext, len) == 0) return slot;
+    }
+}
+
+ES_Error ES_Init(ExtensionSet* self, StringList* exts) {
+    usize cap = 16;
+    while (cap < exts->len * 2) cap *= 2;
+
+    self->slots = calloc(cap, sizeof(ES_Slot));
+    if (self->slots == NULL) return ESE_AllocFailed;
+    self->mask = cap - 1;
+    self->len = 0;
+
+    for (usize i = 0; i < exts->len; ++i) {
+        char* ext;
+        SL_Get(exts, i, &ext);
+
+        usize len = strlen(ext);
+        uint64_t hash = ES_Hash(ext, len);
+        if (ES_Find(self, ext, len, hash) != NULL) continue;
+
+        usize slot = hash & self->mask;
+        while (self->slots[slot].ext != NULL) slot = (slot + 1) & self->mask;
+
+        self->slots[slot] = (ES_Slot) { .ext = ext, .len = len, .hash = hash };
+        self->len++;
+    }
+
+    return ESE_Ok;
+}
+
+ES_Error ES_Destroy(ExtensionSet* self) {
+    free(self->slots);
+    self->slots = NULL;
+    self->mask = 0;
+    self->len = 0;
+    return ESE_Ok;
+}
+
+bool ES_Contains(const ExtensionSet* self, const char* ext, usize len) {
+    if (self->len == 0) return false;
+    return ES_Find(self, ext, len, ES_Hash(ext, len)) != NULL;
+}
+
+bool ES_MatchesName(const ExtensionSet* self, const char* name) {
+    if (self->len == 0) return false;
+
+    const char* dot = strrchr(name, '.');
+    if (dot == NULL) return false;
+
+    const char* ext = dot + 1;
+    return ES_Contains(self, ext, strlen(ext));
+}
@@ -0,0 +1,139 @@
+#include <FileReader.h>
+
+#include <Definitions.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static pthread_once_t busHandlerOnce = PTHREAD_ONCE_INIT;
+static struct sigaction prevBusAction;
+
+// the mapped block FR_ForEach is reading on this thread, if any
+static _Thread_local sigjmp_buf* busJump = NULL;
+static _Thread_local const char* busFrom = NULL;
+static _Thread_local const char* busTo = NULL;
+
+static void FR_OnBus(int sig, siginfo_t* info, void* ctx) {
+    (void)sig;
+    (void)ctx;
+
+    const char* addr = info->si_addr;
+    if (busJump != NULL && addr >= busFrom && addr < busTo) siglongjmp(*busJump, 1);
+
+    // not a file shrinking under us, the faulting access repeats and gets the previous action
+    sigaction(SIGBUS, &prevBusAction, NULL);
+}
+
+static void FR_InstallBusHandler() {
+    struct sigaction action = { .sa_sigaction = FR_OnBus, .sa_flags = SA_SIGINFO };
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGBUS, &action, &prevBusAction);
+}
+
+FR_Error FR_Open(FileReader* self, const char* path, usize mmapThreshold, char* buf, usize bufCap) {
+    return FR_OpenAt(self, AT_FDCWD, path, mmapThreshold, buf, bufCap);
+}
+
+FR_Error FR_OpenAt(FileReader* self, int dirFd, const char* path, usize mmapThreshold, char* buf, usize bufCap) {
+    *self = (FileReader) { .fd = -1, .buf = buf, .bufCap = bufCap };
+
+    self->fd = openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (self->fd == -1) return FRE_OpenError;
+
+    struct stat st;
+    if (fstat(self->fd, &st) == -1) {
+        FR_Close(self);
+        return FRE_ReadError;
+    }
+    self->size = (usize)st.st_size;
+
+    if (mmapThreshold == 0 || self->size < mmapThreshold || !S_ISREG(st.st_mode)) {
+        return FRE_Ok;
+    }
+
+    void* map = mmap(NULL, self->size, PROT_READ, MAP_PRIVATE, self->fd, 0);
+    if (map == MAP_FAILED) {
+        // not fatal, fall back to read()
+        return FRE_Ok;
+    }
+
+    pthread_once(&busHandlerOnce, FR_InstallBusHandler);
+    madvise(map, self->size, MADV_SEQUENTIAL);
+    self->map = map;
+    self->mapped = true;
+    return FRE_Ok;
+}
+
+FR_Error FR_Next(FileReader* self, const char** outData, usize* outLen) {
+    *outLen = 0;
+    if (self->done) return FRE_Ok;
+
+    if (self->mapped) {
+        *outData = self->map;
+        *outLen = self->size;
+        self->done = true;
+        return FRE_Ok;
+    }
+
+    if (self->buf == NULL || self->fd == -1) return FRE_ReadError;
+
+    isize bytesRead = read(self->fd, self->buf, self->bufCap);
+    if (bytesRead < 0) return FRE_ReadError;
+    if (bytesRead == 0) self->done = true;
+
+    *outData = self->buf;
+    *outLen = (usize)bytesRead;
+    return FRE_Ok;
+}
+
+/// Calls fn on the whole mapping, a SIGBUS inside of it lands back here.
+static FR_Error FR_CallMapped(FileReader* self, FR_BlockFn fn, void* arg) {
+    sigjmp_buf jump;
+    if (sigsetjmp(jump, 1) != 0) {
+        busJump = NULL;
+        return FRE_ReadError;
+    }
+
+    busFrom = self->map;
+    busTo = self->map + self->size;
+    busJump = &jump;
+    fn(arg, self->map, self->size);
+    busJump = NULL;
+    return FRE_Ok;
+}
+
+FR_Error FR_ForEach(FileReader* self, FR_BlockFn fn, void* arg) {
+    if (self->mapped) {
+        if (self->done) return FRE_Ok;
+        self->done = true;
+        return FR_CallMapped(self, fn, arg);
+    }
+
+    const char* data;
+    usize len;
+    for (;;) {
+        FR_Error err = FR_Next(self, &data, &len);
+        if (err != FRE_Ok) return err;
+        if (len == 0 || !fn(arg, data, len)) return FRE_Ok;
+    }
+}
+
+FR_Error FR_Close(FileReader* self) {
+    if (self->mapped) {
+        munmap(self->map, self->size);
+        self->map = NULL;
+        self->mapped = false;
+    }
+
+    if (self->fd != -1) {
+        close(self->fd);
+        self->fd = -1;
+    }
+    return FRE_Ok;
+}
@@ -0,0 +1,324 @@
+#include <GitIndex.h>
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define GI_HEADER_SIZE 12
+#define GI_CHECKSUM_SIZE GI_OID_SIZE
+
+// on-disk entry flags
+#define GI_FLAG_EXTENDED 0x4000
+#define GI_FLAG_NAME_MASK 0x0FFF
+#define GI_EXT_SKIP_WORKTREE 0x4000
+#define GI_EXT_INTENT_TO_ADD 0x2000
+
+#define GI_MODE_TYPE 0170000
+#define GI_MODE_REGULAR 0100000
+#define GI_MODE_SYMLINK 0120000
+
+static inline uint32_t GI_Read32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline uint16_t GI_Read16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/// The offset encoded varint of index version 4 (not LEB128), returns NULL past end.
+static const uint8_t* GI_ReadVarint(const uint8_t* p, const uint8_t* end, usize* out) {
+    if (p >= end) return NULL;
+
+    uint8_t c = *p++;
+    usize val = c & 127;
+    while (c & 128) {
+        if (p >= end) return NULL;
+        c = *p++;
+        val = ((val + 1) << 7) | (c & 127);
+    }
+
+    *out = val;
+    return p;
+}
+
+/// Reads the "gitdir: <path>" line of a .git file, a relative path is relative to its directory.
+static char* GI_ReadGitFile(const char* gitFile) {
+    FILE* fp = fopen(gitFile, "r");
+    if (fp == NULL) return NULL;
+
+    char line[4096];
+    bool ok = fgets(line, sizeof(line), fp) != NULL;
+    fclose(fp);
+    if (!ok || strncmp(line, "gitdir: ", 8) != 0) return NULL;
+
+    char* target = line + 8;
+    target[strcspn(target, "\r\n")] = '\0';
+    if (target[0] == '/') return realpath(target, NULL);
+
+    char* dirCopy = strdup(gitFile);
+    if (dirCopy == NULL) return NULL;
+
+    char* joined = NULL;
+    if (asprintf(&joined, "%s/%s", dirname(dirCopy), target) == -1) joined = NULL;
+    free(dirCopy);
+    if (joined == NULL) return NULL;
+
+    char* resolved = realpath(joined, NULL);
+    free(joined);
+    return resolved;
+}
+
+GI_Error GI_FindRepo(const char* dir, char** outWorkTree, char** outGitDir) {
+    usize len = strlen(dir);
+    char* buf = malloc(len + sizeof("/.git"));
+    if (buf == NULL) return GIE_AllocFailed;
+    memcpy(buf, dir, len + 1);
+
+    while (true) {
+        // buf[0..len) is the candidate work tree
+        memcpy(buf + (len == 1 ? 0 : len), "/.git", sizeof("/.git"));
+
+        char* gitDir = NULL;
+        struct stat st;
+        if (stat(buf, &st) == 0) {
+            if (S_ISDIR(st.st_mode)) gitDir = strdup(buf);
+            else if (S_ISREG(st.st_mode)) gitDir = GI_ReadGitFile(buf);
+        }
+
+        if (gitDir != NULL) {
+            char* workTree = strndup(buf, len);
+            free(buf);
+            if (workTree == NULL) {
+                free(gitDir);
+                return GIE_AllocFailed;
+            }
+
+            *outWorkTree = workTree;
+            *outGitDir = gitDir;
+            return GIE_Ok;
+        }
+
+        if (len <= 1) break;
+        while (len > 1 && buf[len - 1] != '/') --len;
+        if (len > 1) --len;
+    }
+
+    free(buf);
+    return GIE_NotARepo;
+}
+
+/// Makes sure buf can hold need bytes.
+static bool GI_Reserve(char** buf, usize* cap, usize need) {
+    if (need <= *cap) return true;
+
+    usize newCap = *cap > 0 ? *cap : 256;
+    while (newCap < need) newCap *= 2;
+
+    char* newBuf = realloc(*buf, newCap);
+    if (newBuf == NULL) return false;
+
+    *buf = newBuf;
+    *cap = newCap;
+    return true;
+}
+
+static GI_Error GI_Parse(GitIndex* self, const uint8_t* data, usize size) {
+    if (size < GI_HEADER_SIZE + GI_CHECKSUM_SIZE || memcmp(data, "DIRC", 4) != 0) return GIE_InvalidIndex;
+
+    uint32_t version = GI_Read32(data + 4);
+    if (version < 2 || version > 4) return GIE_Unsupported;
+
+    usize count = GI_Read32(data + 8);
+    const uint8_t* end = data + size - GI_CHECKSUM_SIZE;
+    if (count > (usize)(end - data) / 62) return GIE_InvalidIndex;
+
+    GI_Error err = GIE_Ok;
+    usize* offsets = malloc((count > 0 ? count : 1) * sizeof(usize));
+    self->entries = malloc((count > 0 ? count : 1) * sizeof(GI_Entry));
+    if (offsets == NULL || self->entries == NULL) {
+        free(offsets);
+        return GIE_AllocFailed;
+    }
+
+    usize pathsLen = 0, pathsCap = 0;
+
+    // the path of the previous entry on disk, version 4 paths only store what differs from it
+    char* prev = NULL;
+    usize prevLen = 0, prevCap = 0;
+
+    const uint8_t* p = data + GI_HEADER_SIZE;
+    for (usize i = 0; i < count; ++i) {
+        if (end - p < 62) {
+            err = GIE_InvalidIndex;
+            break;
+        }
+
+        uint16_t flags = GI_Read16(p + 60);
+        uint16_t extFlags = 0;
+        usize headerLen = 62;
+        if (flags & GI_FLAG_EXTENDED) {
+            if (version < 3 || end - p < 64) {
+                err = GIE_InvalidIndex;
+                break;
+            }
+            extFlags = GI_Read16(p + 62);
+            headerLen = 64;
+        }
+
+        const uint8_t* name = p + headerLen;
+        usize strip = prevLen; // whole paths before version 4
+        if (version == 4) {
+            name = GI_ReadVarint(name, end, &strip);
+            if (name == NULL || strip > prevLen) {
+                err = GIE_InvalidIndex;
+                break;
+            }
+        }
+
+        usize nameLen = strnlen((const char*)name, (usize)(end - name));
+        if (name + nameLen == end) {
+            err = GIE_InvalidIndex;
+            break;
+        }
+        if (version != 4 && (flags & GI_FLAG_NAME_MASK) < GI_FLAG_NAME_MASK && nameLen != (flags & GI_FLAG_NAME_MASK)) {
+            err = GIE_InvalidIndex;
+            break;
+        }
+
+        usize pathLen = prevLen - strip + nameLen;
+        if (!GI_Reserve(&prev, &prevCap, pathLen + 1)) {
+            err = GIE_AllocFailed;
+            break;
+        }
+        memcpy(prev + prevLen - strip, name, nameLen);
+        prev[pathLen] = '\0';
+        prevLen = pathLen;
+
+        const uint8_t* entry = p;
+        if (version == 4) {
+            p = name + nameLen + 1;
+        } else {
+            // padded with 1-8 NULs to a multiple of 8
+            usize entryLen = (headerLen + nameLen + 8) & ~(usize)7;
+            if ((usize)(end - p) < entryLen) {
+                err = GIE_InvalidIndex;
+                break;
+            }
+            p += entryLen;
+        }
+
+        uint32_t mode = GI_Read32(entry + 24);
+        uint32_t type = mode & GI_MODE_TYPE;
+        unsigned stage = (flags >> 12) & 3;
+
+        // submodules, sparse directories and files that are not checked out
+        if (type != GI_MODE_REGULAR && type != GI_MODE_SYMLINK) continue;
+        if (extFlags & GI_EXT_SKIP_WORKTREE) continue;
+
+        // a conflict has up to three stages of the same path, the file is listed once
+        if (stage != 0 && self->count > 0) {
+            const GI_Entry* last = &self->entries[self->count - 1];
+            if (last->pathLen == pathLen && memcmp(self->paths + offsets[self->count - 1], prev, pathLen) == 0) continue;
+        }
+
+        if (!GI_Reserve(&self->paths, &pathsCap, pathsLen + pathLen + 1)) {
+            err = GIE_AllocFailed;
+            break;
+        }
+        memcpy(self->paths + pathsLen, prev, pathLen + 1);
+
+        GI_Entry* out = &self->entries[self->count];
+        *out = (GI_Entry) {
+            .pathLen = pathLen,
+            .mode = mode,
+            .mtimeSec = GI_Read32(entry + 8),
+            .mtimeNsec = GI_Read32(entry + 12),
+            .ino = GI_Read32(entry + 20),
+            .size = GI_Read32(entry + 36),
+            .hasOid = stage == 0 && !(extFlags & GI_EXT_INTENT_TO_ADD),
+        };
+        memcpy(out->oid, entry + 40, GI_OID_SIZE);
+
+        offsets[self->count++] = pathsLen;
+        pathsLen += pathLen + 1;
+    }
+    free(prev);
+
+    // a split index keeps most entries in a shared index file
+    while (err == GIE_Ok && end - p >= 8) {
+        if (memcmp(p, "link", 4) == 0) err = GIE_Unsupported;
+
+        uint32_t extSize = GI_Read32(p + 4);
+        if ((usize)(end - p) - 8 < extSize) break;
+        p += 8 + extSize;
+    }
+
+    if (err == GIE_Ok) {
+        for (usize i = 0; i < self->count; ++i) self->entries[i].path = self->paths + offsets[i];
+    }
+    free(offsets);
+    return err;
+}
+
+GI_Error GI_Load(GitIndex* self, const char* gitDir) {
+    memset(self, 0, sizeof(*self));
+
+    char* indexPath = NULL;
+    if (asprintf(&indexPath, "%s/index", gitDir) == -1) return GIE_AllocFailed;
+
+    int fd = open(indexPath, O_RDONLY | O_CLOEXEC);
+    free(indexPath);
+    if (fd == -1) return GIE_ReadError;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return GIE_ReadError;
+    }
+    self->mtimeSec = st.st_mtime;
+    self->mtimeNsec = st.st_mtim.tv_nsec;
+
+    if (st.st_size == 0) {
+        close(fd);
+        return GIE_InvalidIndex;
+    }
+
+    void* map = mmap(NULL, (usize)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return GIE_ReadError;
+
+    GI_Error err = GI_Parse(self, map, (usize)st.st_size);
+    munmap(map, (usize)st.st_size);
+
+    if (err != GIE_Ok) GI_Destroy(self);
+    return err;
+}
+
+GI_Error GI_Destroy(GitIndex* self) {
+    free(self->entries);
+    free(self->paths);
+    memset(self, 0, sizeof(*self));
+    return GIE_Ok;
+}
+
+bool GI_IsUnchanged(const GitIndex* self, const GI_Entry* entry, const struct stat* st) {
+    if (!entry->hasOid || (entry->mode & GI_MODE_TYPE) != GI_MODE_REGULAR || !S_ISREG(st->st_mode)) return false;
+
+    if (entry->size != (uint32_t)st->st_size) return false;
+    if (entry->mtimeSec != (uint32_t)st->st_mtime || entry->mtimeNsec != (uint32_t)st->st_mtim.tv_nsec) return false;
+    if (entry->ino != 0 && entry->ino != (uint32_t)st->st_ino) return false;
+
+    // racily clean: written in the same tick as the index, a later change may keep the stat data
+    int64_t sec = entry->mtimeSec;
+    return sec < self->mtimeSec || (sec == self->mtimeSec && (int64_t)entry->mtimeNsec < self->mtimeNsec);
+}
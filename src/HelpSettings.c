@@ -58,6 +58,14 @@ static const HelpCategory help[] = {
                 .name = "--no-loc",
                 .desc = "Disables line-of-code (loc) mode (default)",
             },
+            (HelpItem) {
+                .name = "--loc-summary",
+                .desc = "Prints a table of files and code/comment/pp/blank lines per language instead of every file (implies --loc, files are still listed with --print)",
+            },
+            (HelpItem) {
+                .name = "--no-loc-summary",
+                .desc = "Does not print the language table (default)",
+            },
             (HelpItem) {
                 .name = "--show-hidden",
                 .desc = "Shows hidden files (default)",
@@ -73,6 +81,58 @@ static const HelpCategory help[] = {
                 .name = "--max-depth={depth}",
                 .desc = "Sets maximum depth of recursion to {depth} (default: unlimited)",
             },
+            (HelpItem) {
+                .name = "--jobs={n}",
+                .desc = "Counts files using {n} worker threads, 0 means one per CPU (default: 1)",
+            },
+            (HelpItem) {
+                .name = "--mmap-threshold={size}",
+                .desc = "Maps files of at least {size} bytes (K/M/G suffixes allowed) instead of reading them, 0 disables (default: 1M)",
+            },
+            (HelpItem) {
+                .name = "--io-uring",
+                .desc = "Reads small files in batches through io_uring where the kernel allows it",
+            },
+            (HelpItem) {
+                .name = "--no-io-uring",
+                .desc = "Reads every file with open/read/close (default)",
+            },
+            (HelpItem) {
+                .name = "--cache",
+                .desc = "Reuses the results of unchanged files from the cache file and updates it",
+            },
+            (HelpItem) {
+                .name = "--cache={path}",
+                .desc = "Uses the given cache file, implies --cache (default: .clines-cache in the current directory)",
+            },
+            (HelpItem) {
+                .name = "--no-cache",
+                .desc = "Counts every file and does not touch the cache file (default)",
+            },
+            (HelpItem) {
+                .name = "--git",
+                .desc = "Counts only files tracked by git, listed from .git/index instead of reading directories",
+            },
+            (HelpItem) {
+                .name = "--no-git",
+                .desc = "Walks the directory tree (default)",
+            },
+            (HelpItem) {
+                .name = "--ignore-files",
+                .desc = "Skips what .gitignore and .ignore files (and their nested ones) ignore, and .git directories",
+            },
+            (HelpItem) {
+                .name = "--no-ignore-files",
+                .desc = "Does not read ignore files (default)",
+            },
+            (HelpItem) {
+                .name = "--watch",
+                .desc = "Keeps running after the count, recounts changed files and prints fresh totals (files are read, not mapped)",
+            },
+            (HelpItem) {
+                .name = "--no-watch",
+                .desc = "Counts once and exits (default)",
+            },
             (HelpItem) {
                 .name = "--debug",
                 .desc = "Enables debug mode",
@@ -186,7 +246,7 @@ static const HelpCategory help[] = {
 
             (HelpItem) {
                 .name = "--top={n}",
-                .desc = "Shows only the top {n} files (TODO!)",
+                .desc = "Shows only the first {n} files in the order of the output",
             },
 
             FINISH,
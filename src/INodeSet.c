@@ -1,4 +1,5 @@
 #include <INodeSet.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -149,6 +150,20 @@ INS_Error INS_Insert(INodeSet* self, INode fi) {
     return INSE_Ok;
 }
 
+INS_Error INS_Remove(INodeSet* self, INode fi) {
+    usize index = INS_ComputeIndex(self, fi);
+    for (INS_Entry** link = &self->buckets[index]; *link != NULL; link = &(*link)->next) {
+        if (!self->eqlFunc((*link)->key, fi)) continue;
+
+        INS_Entry* entry = *link;
+        *link = entry->next;
+        free(entry);
+        self->size--;
+        break;
+    }
+    return INSE_Ok;
+}
+
 INS_Error INS_InsertFrom(INodeSet* self, const INodeSet* src) {
     if (self->cap < src->size) {
         INS_Error err = INS_Rehash(self, src->size + 1);
@@ -165,3 +180,83 @@ INS_Error INS_InsertFrom(INodeSet* self, const INodeSet* src) {
     }
     return INSE_Ok;
 }
+
+// bucket indices use the low bits of the hash, so shards are picked from a remixed one
+static inline usize INSS_ComputeShard(const INodeSharedSet* self, INode fi) {
+    uint64_t hash = (uint64_t)IN_Hash(fi);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return (usize)(hash % self->shardsCount);
+}
+
+INS_Error INSS_Init(INodeSharedSet* self, usize shardsCount) {
+    self->shardsCount = 0;
+    self->shards = calloc(shardsCount, sizeof(INSS_Shard));
+    if (self->shards == NULL) return INSE_AllocFailed;
+
+    for (usize i = 0; i < shardsCount; ++i) {
+        INS_Error err = INS_DefaultInit(&self->shards[i].set);
+        if (err != INSE_Ok) {
+            INSS_Destroy(self);
+            return err;
+        }
+        pthread_mutex_init(&self->shards[i].lock, NULL);
+        self->shardsCount++;
+    }
+
+    return INSE_Ok;
+}
+
+INS_Error INSS_DefaultInit(INodeSharedSet* self) {
+    const usize DEFAULT_SHARDS_COUNT = 64;
+    return INSS_Init(self, DEFAULT_SHARDS_COUNT);
+}
+
+INS_Error INSS_Clear(INodeSharedSet* self) {
+    for (usize i = 0; i < self->shardsCount; ++i) {
+        pthread_mutex_lock(&self->shards[i].lock);
+        INS_Clear(&self->shards[i].set);
+        pthread_mutex_unlock(&self->shards[i].lock);
+    }
+    return INSE_Ok;
+}
+
+INS_Error INSS_Destroy(INodeSharedSet* self) {
+    for (usize i = 0; i < self->shardsCount; ++i) {
+        INS_Destroy(&self->shards[i].set);
+        pthread_mutex_destroy(&self->shards[i].lock);
+    }
+
+    free(self->shards);
+    self->shards = NULL;
+    self->shardsCount = 0;
+    return INSE_Ok;
+}
+
+bool INSS_Contains(INodeSharedSet* self, INode fi) {
+    INSS_Shard* shard = &self->shards[INSS_ComputeShard(self, fi)];
+
+    pthread_mutex_lock(&shard->lock);
+    bool res = INS_Contains(&shard->set, fi);
+    pthread_mutex_unlock(&shard->lock);
+    return res;
+}
+
+INS_Error INSS_Insert(INodeSharedSet* self, INode fi) {
+    INSS_Shard* shard = &self->shards[INSS_ComputeShard(self, fi)];
+
+    pthread_mutex_lock(&shard->lock);
+    INS_Error err = INS_Insert(&shard->set, fi);
+    pthread_mutex_unlock(&shard->lock);
+    return err;
+}
+
+INS_Error INSS_Remove(INodeSharedSet* self, INode fi) {
+    INSS_Shard* shard = &self->shards[INSS_ComputeShard(self, fi)];
+
+    pthread_mutex_lock(&shard->lock);
+    INS_Error err = INS_Remove(&shard->set, fi);
+    pthread_mutex_unlock(&shard->lock);
+    return err;
+}
@@ -0,0 +1,360 @@
+#include <IgnoreRules.h>
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef IG_PATH_BUF_CAP
+#    ifdef PATH_MAX
+#        define IG_PATH_BUF_CAP (PATH_MAX + 256)
+#    else
+#        define IG_PATH_BUF_CAP 4352
+#    endif
+#endif
+
+static bool IG_HasGlobChars(const char* s) {
+    return strpbrk(s, "*?[\\") != NULL;
+}
+
+static int IG_CompareLiterals(const void* a, const void* b) {
+    const IG_Literal* la = a;
+    const IG_Literal* lb = b;
+    int cmp = strcmp(la->text, lb->text);
+    if (cmp != 0) return cmp;
+    return la->rule < lb->rule ? -1 : (la->rule > lb->rule ? 1 : 0);
+}
+
+/// Cuts the next line out of text (in place), returns NULL at the end.
+static char* IG_NextLine(char** cursor, char* end) {
+    char* line = *cursor;
+    if (line >= end) return NULL;
+
+    char* nl = memchr(line, '\n', (usize)(end - line));
+    if (nl == NULL) nl = end;
+    *nl = '\0';
+    *cursor = nl + 1;
+
+    if (nl > line && nl[-1] == '\r') nl[-1] = '\0';
+    return line;
+}
+
+/// Turns a line into a rule, returns false for blank lines and comments.
+static bool IG_ParseLine(char* line, IG_Rule* out) {
+    if (line[0] == '#') return false;
+
+    // trailing spaces are dropped unless escaped
+    usize len = strlen(line);
+    while (len > 0 && line[len - 1] == ' ' && !(len >= 2 && line[len - 2] == '\\')) --len;
+    line[len] = '\0';
+
+    *out = (IG_Rule) {0};
+    if (line[0] == '!') {
+        out->negated = true;
+        ++line;
+        --len;
+    }
+    if (len > 0 && line[len - 1] == '/') {
+        out->dirOnly = true;
+        line[--len] = '\0';
+    }
+
+    // a slash anywhere but at the end anchors the pattern to the directory
+    out->anchored = strchr(line, '/') != NULL;
+    if (line[0] == '/') ++line;
+    if (line[0] == '\0') return false;
+
+    out->pattern = line;
+    out->prefixLen = strcspn(line, "*?[\\");
+    return true;
+}
+
+IG_Error IG_Parse(IgnoreRules* self, const char* text, usize len) {
+    memset(self, 0, sizeof(*self));
+
+    self->text = malloc(len + 1);
+    if (self->text == NULL) return IGE_AllocFailed;
+    memcpy(self->text, text, len);
+    self->text[len] = '\0';
+
+    usize cap = 1;
+    for (usize i = 0; i < len; ++i) cap += text[i] == '\n';
+
+    self->rules = malloc(cap * sizeof(IG_Rule));
+    self->names = malloc(cap * sizeof(IG_Literal));
+    self->exts = malloc(cap * sizeof(IG_Literal));
+    self->globs = malloc(cap * sizeof(uint32_t));
+    if (self->rules == NULL || self->names == NULL || self->exts == NULL || self->globs == NULL) {
+        IG_Destroy(self);
+        return IGE_AllocFailed;
+    }
+
+    char* cursor = self->text;
+    char* end = self->text + len;
+    char* line;
+    while ((line = IG_NextLine(&cursor, end)) != NULL) {
+        IG_Rule rule;
+        if (!IG_ParseLine(line, &rule)) continue;
+
+        uint32_t index = (uint32_t)self->count;
+        self->rules[self->count++] = rule;
+
+        const char* p = rule.pattern;
+        if (!rule.anchored && !IG_HasGlobChars(p)) {
+            self->names[self->namesCount++] = (IG_Literal) { .text = p, .rule = index };
+        } else if (!rule.anchored && p[0] == '*' && p[1] == '.' && p[2] != '\0' && !IG_HasGlobChars(p + 2)
+                   && strchr(p + 2, '.') == NULL) {
+            self->exts[self->extsCount++] = (IG_Literal) { .text = p + 2, .rule = index };
+        } else {
+            self->globs[self->globsCount++] = index;
+        }
+    }
+
+    qsort(self->names, self->namesCount, sizeof(IG_Literal), IG_CompareLiterals);
+    qsort(self->exts, self->extsCount, sizeof(IG_Literal), IG_CompareLiterals);
+    return IGE_Ok;
+}
+
+void IG_Destroy(IgnoreRules* self) {
+    free(self->text);
+    free(self->rules);
+    free(self->names);
+    free(self->exts);
+    free(self->globs);
+    memset(self, 0, sizeof(*self));
+}
+
+void IG_Free(IgnoreRules* self) {
+    if (self == NULL) return;
+    IG_Destroy(self);
+    free(self);
+}
+
+/// Appends the ignore file name (relative to dirFd) to the text, skipping it when it can't be read.
+static IG_Error IG_ReadFile(int dirFd, const char* name, char** text, usize* len) {
+    int fd = openat(dirFd, name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return IGE_Ok;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || st.st_size > IG_MAX_FILE_SIZE) {
+        close(fd);
+        return IGE_Ok;
+    }
+
+    char* grown = realloc(*text, *len + (usize)st.st_size + 1);
+    if (grown == NULL) {
+        close(fd);
+        return IGE_AllocFailed;
+    }
+    *text = grown;
+
+    usize got = 0;
+    while (got < (usize)st.st_size) {
+        ssize_t n = read(fd, grown + *len + got, (usize)st.st_size - got);
+        if (n <= 0) break;
+        got += (usize)n;
+    }
+    close(fd);
+
+    *len += got;
+    grown[(*len)++] = '\n';
+    return IGE_Ok;
+}
+
+IG_Error IG_Load(int dirFd, const char* path, const IgnoreRules* parent, IgnoreRules** out) {
+    *out = NULL;
+
+    static const char* const fileNames[] = IG_FILE_NAMES;
+    char* text = NULL;
+    usize len = 0;
+    for (usize i = 0; i < sizeof(fileNames) / sizeof(fileNames[0]); ++i) {
+        if (IG_ReadFile(dirFd, fileNames[i], &text, &len) != IGE_Ok) {
+            free(text);
+            return IGE_AllocFailed;
+        }
+    }
+    if (text == NULL) return IGE_Ok;
+
+    IgnoreRules* rules = malloc(sizeof(IgnoreRules));
+    IG_Error err = rules != NULL ? IG_Parse(rules, text, len) : IGE_AllocFailed;
+    free(text);
+    if (err != IGE_Ok) {
+        free(rules);
+        return err;
+    }
+    if (rules->count == 0) {
+        IG_Free(rules);
+        return IGE_Ok;
+    }
+
+    rules->dirLen = strlen(path);
+    rules->parent = parent;
+    *out = rules;
+    return IGE_Ok;
+}
+
+/// The last rule of the table for text that applies, -1 if there is none.
+static int64_t IG_FindLiteral(const IgnoreRules* self, const IG_Literal* table, usize count, const char* text, bool isDir) {
+    usize lo = 0, hi = count;
+    while (lo < hi) {
+        usize mid = lo + (hi - lo) / 2;
+        if (strcmp(table[mid].text, text) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+
+    // equal texts are sorted by rule, the last one that applies wins
+    usize last = lo;
+    while (last < count && strcmp(table[last].text, text) == 0) ++last;
+    for (usize i = last; i > lo; --i) {
+        const IG_Rule* rule = &self->rules[table[i - 1].rule];
+        if (!rule->dirOnly || isDir) return table[i - 1].rule;
+    }
+    return -1;
+}
+
+/// The last rule of self that matches the entry, -1 if there is none.
+static int64_t IG_LastMatch(const IgnoreRules* self, const char* dirPath, const char* name, bool isDir) {
+    int64_t best = IG_FindLiteral(self, self->names, self->namesCount, name, isDir);
+
+    const char* ext = strrchr(name, '.');
+    if (ext != NULL && self->extsCount > 0) {
+        int64_t rule = IG_FindLiteral(self, self->exts, self->extsCount, ext + 1, isDir);
+        if (rule > best) best = rule;
+    }
+
+    // the path relative to the directory of the rules, built for the first anchored rule
+    char relBuf[IG_PATH_BUF_CAP];
+    const char* rel = NULL;
+
+    for (usize i = self->globsCount; i > 0; --i) {
+        uint32_t index = self->globs[i - 1];
+        if ((int64_t)index <= best) break;
+
+        const IG_Rule* rule = &self->rules[index];
+        if (rule->dirOnly && !isDir) continue;
+
+        const char* text = name;
+        if (rule->anchored) {
+            if (rel == NULL) {
+                const char* relDir = dirPath + self->dirLen;
+                if (*relDir == '/') ++relDir;
+
+                rel = name;
+                if (*relDir != '\0') {
+                    int n = snprintf(relBuf, sizeof(relBuf), "%s/%s", relDir, name);
+                    rel = n > 0 && (usize)n < sizeof(relBuf) ? relBuf : "";
+                }
+            }
+            text = rel;
+        }
+
+        if (strncmp(text, rule->pattern, rule->prefixLen) != 0) continue;
+        if (IG_GlobMatch(rule->pattern, text)) return index;
+    }
+    return best;
+}
+
+bool IG_IsIgnored(const IgnoreRules* rules, const char* dirPath, const char* name, bool isDir) {
+    for (const IgnoreRules* level = rules; level != NULL; level = level->parent) {
+        int64_t match = IG_LastMatch(level, dirPath, name, isDir);
+        if (match >= 0) return !level->rules[match].negated;
+    }
+    return false;
+}
+
+/// Matches the bracket expression at *p (just after the '['), moving *p past it. Returns false if it is not closed.
+static bool IG_MatchClass(const char** p, char c, bool* matched) {
+    const char* s = *p;
+    bool negate = *s == '!' || *s == '^';
+    if (negate) ++s;
+
+    bool found = false;
+    bool first = true;
+    while (*s != '\0' && (*s != ']' || first)) {
+        first = false;
+
+        unsigned char lo = (unsigned char)*s;
+        if (lo == '\\' && s[1] != '\0') lo = (unsigned char)*++s;
+        ++s;
+
+        unsigned char hi = lo;
+        if (*s == '-' && s[1] != ']' && s[1] != '\0') {
+            ++s;
+            if (*s == '\\' && s[1] != '\0') ++s;
+            hi = (unsigned char)*s++;
+        }
+
+        if ((unsigned char)c >= lo && (unsigned char)c <= hi) found = true;
+    }
+    if (*s != ']') return false;
+
+    *p = s + 1;
+    *matched = found != negate;
+    return true;
+}
+
+static bool IG_MatchFrom(const char* pattern, const char* p, const char* t) {
+    while (*p != '\0') {
+        char c = *p;
+
+        if (c == '*') {
+            // a whole "**" component crosses directories
+            if (p[1] == '*' && (p == pattern || p[-1] == '/') && (p[2] == '/' || p[2] == '\0')) {
+                if (p[2] == '\0') return true;
+
+                for (const char* s = t;; ++s) {
+                    if (IG_MatchFrom(pattern, p + 3, s)) return true;
+                    s = strchr(s, '/');
+                    if (s == NULL) return false;
+                }
+            }
+
+            while (*p == '*') ++p;
+            if (*p == '\0') return strchr(t, '/') == NULL;
+
+            for (const char* s = t;; ++s) {
+                if (IG_MatchFrom(pattern, p, s)) return true;
+                if (*s == '\0' || *s == '/') return false;
+            }
+        }
+
+        if (*t == '\0') return false;
+
+        if (c == '?') {
+            if (*t == '/') return false;
+            ++p;
+            ++t;
+            continue;
+        }
+
+        if (c == '[') {
+            const char* q = p + 1;
+            bool matched;
+            if (IG_MatchClass(&q, *t, &matched)) {
+                if (!matched || *t == '/') return false;
+                p = q;
+                ++t;
+                continue;
+            }
+            // not closed, a literal '['
+        }
+
+        if (c == '\\' && p[1] != '\0') c = *++p;
+        if (c != *t) return false;
+        ++p;
+        ++t;
+    }
+
+    return *t == '\0';
+}
+
+bool IG_GlobMatch(const char* pattern, const char* text) {
+    return IG_MatchFrom(pattern, pattern, text);
+}
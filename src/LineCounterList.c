@@ -7,39 +7,89 @@
 #include <stdlib.h>
 #include <string.h>
 
-LCL_Error LCL_AllocBuf(LineCounterList* self, usize newCap) {
-    LineCounter* newData = malloc(newCap * sizeof(LineCounter));
-    if (newData == NULL) return LCLE_AllocFailed;
+/// Reallocates a column to newCap elements, the ones below both sizes are kept.
+static bool LCL_ResizeColumn(void** column, usize elemSize, usize newCap) {
+    if (newCap == 0) {
+        free(*column);
+        *column = NULL;
+        return true;
+    }
 
-    free(self->data);
-    self->data = newData;
-    self->cap = newCap;
-    return LCLE_Ok;
+    void* resized = realloc(*column, newCap * elemSize);
+    if (resized == NULL) return false;
+    *column = resized;
+    return true;
 }
 
-LCL_Error LCL_Resize(LineCounterList* self, usize newCap) {
-    LineCounter* newData = malloc(newCap * sizeof(LineCounter));
-    if (newData == NULL) return LCLE_AllocFailed;
+/// Resizes every column there is to newCap, see LCL_Resize.
+static bool LCL_ResizeColumns(LineCounterList* self, usize newCap) {
+    bool ok = LCL_ResizeColumn((void**)&self->toPrint, sizeof(char*), newCap)
+        && LCL_ResizeColumn((void**)&self->lines, sizeof(usize), newCap)
+        && LCL_ResizeColumn((void**)&self->size, sizeof(off_t), newCap)
+        && LCL_ResizeColumn((void**)&self->mtime, sizeof(time_t), newCap)
+        && LCL_ResizeColumn((void**)&self->mtimeNsec, sizeof(long), newCap)
+        && LCL_ResizeColumn((void**)&self->order, sizeof(uint32_t), newCap);
+
+    if (ok && self->fullPath != NULL) ok = LCL_ResizeColumn((void**)&self->fullPath, sizeof(char*), newCap);
+    if (ok && self->hasLocStat != NULL) {
+        ok = LCL_ResizeColumn((void**)&self->hasLocStat, sizeof(bool), newCap)
+            && LCL_ResizeColumn((void**)&self->emptyLines, sizeof(usize), newCap)
+            && LCL_ResizeColumn((void**)&self->commentLines, sizeof(usize), newCap)
+            && LCL_ResizeColumn((void**)&self->codeLines, sizeof(usize), newCap)
+            && LCL_ResizeColumn((void**)&self->preprocessorLines, sizeof(usize), newCap);
+    }
+    return ok;
+}
+
+static void LCL_FreeColumns(LineCounterList* self) {
+    free(self->toPrint);
+    free(self->fullPath);
+    free(self->lines);
+    free(self->size);
+    free(self->mtime);
+    free(self->mtimeNsec);
+    free(self->hasLocStat);
+    free(self->emptyLines);
+    free(self->commentLines);
+    free(self->codeLines);
+    free(self->preprocessorLines);
+    free(self->order);
+
+    StringArena strings = self->strings;
+    memset(self, 0, sizeof(LineCounterList));
+    self->strings = strings;
+}
 
-    memcpy(newData, self->data, self->len * sizeof(LineCounter));
+/// Drops the counters (not their paths) and allocates room for newCap of them.
+LCL_Error LCL_AllocBuf(LineCounterList* self, usize newCap) {
+    LCL_FreeColumns(self);
+    return LCL_Resize(self, newCap);
+}
 
-    free(self->data);
-    self->data = newData;
+LCL_Error LCL_Resize(LineCounterList* self, usize newCap) {
+    if (newCap < self->len) return LCLE_InvalidArgument;
+    if (newCap > LCL_MAX_LEN) return LCLE_AllocFailed;
+
+    // when growing fails the columns grown so far are just bigger than cap, when shrinking
+    // fails the column keeps its old size, which is fine the same way
+    if (!LCL_ResizeColumns(self, newCap) && newCap > self->cap) return LCLE_AllocFailed;
     self->cap = newCap;
     return LCLE_Ok;
 }
 
 LCL_Error LCL_Expand(LineCounterList* self) {
     if (self->len == self->cap) {
-        return LCL_Resize(self, self->len > 0 ? self->len * 2 : 8);
+        if (self->len == LCL_MAX_LEN) return LCLE_AllocFailed;
+
+        usize newCap = self->len > 0 ? self->len * 2 : 8;
+        return LCL_Resize(self, newCap < LCL_MAX_LEN ? newCap : LCL_MAX_LEN);
     }
     return LCLE_Ok;
 }
 
 LCL_Error LCL_Init(LineCounterList* self) {
-    self->len = 0;
-    self->cap = 0;
-    self->data = NULL;
+    memset(self, 0, sizeof(LineCounterList));
+    SA_Init(&self->strings);
     return LCLE_Ok;
 }
 
@@ -56,16 +106,8 @@ LCL_Error LCL_InitReserved(LineCounterList* self, usize minCap) {
 }
 
 LCL_Error LCL_Clear(LineCounterList* self) {
-    for (LineCounter* c = self->data; c < self->data + self->len; ++c) {
-        free(c->toPrint);
-        free(c->meta.fullPath);
-    }
-
-    free(self->data);
-    self->data = NULL;
-    self->len = 0;
-    self->cap = 0;
-
+    SA_Clear(&self->strings);
+    LCL_FreeColumns(self);
     return LCLE_Ok;
 }
 
@@ -82,29 +124,16 @@ LCL_Error LCL_Shrink(LineCounterList* self) {
 LCL_Error LCL_Copy(LineCounterList* dst, const LineCounterList* src) {
     if (src == dst) return LCLE_Ok;
 
-    LCL_Error err = LCL_AllocBuf(dst, src->cap);
+    LCL_Error err = LCL_InitReserved(dst, src->cap);
     if (err != LCLE_Ok) return err;
 
-    dst->len = 0;
     for (usize i = 0; i < src->len; ++i) {
-        dst->data[i].lines = src->data[i].lines;
-
-        dst->data[i].toPrint = strdup(src->data[i].toPrint);
-        if (dst->data[i].toPrint == NULL) return LCLE_AllocFailed; // LCL_Destroy should free alredy allocated strings
-
-        FileMeta* srcMeta = &src->data[i].meta;
-        dst->data[i].meta = (FileMeta) {
-            .fullPath = strdup(srcMeta->fullPath),
-            .mtime = srcMeta->mtime,
-            .size = srcMeta->size,
-        };
-
-        if (dst->data[i].meta.fullPath == NULL) {
-            return LCLE_AllocFailed; // LCL_Destroy should free alredy allocated paths
-        }
-
-        dst->len++;
+        LineCounter c;
+        LCL_Get(src, i, &c);
+        err = LCL_Append(dst, c.toPrint, c.lines, &c.meta, c.locStat, c.hasLocStat);
+        if (err != LCLE_Ok) return err; // LCL_Destroy frees what was copied
     }
+    if (src->len > 0) memcpy(dst->order, src->order, src->len * sizeof(uint32_t));
 
     return LCLE_Ok;
 }
@@ -113,210 +142,592 @@ LCL_Error LCL_Copy(LineCounterList* dst, const LineCounterList* src) {
 //        if it does, you need to call @ref LCL_Destroy before this operation
 LCL_Error LCL_Move(LineCounterList* dst, LineCounterList* src) {
     memcpy(dst, src, sizeof(LineCounterList));
-    memset(src, 0, sizeof(LineCounterList));
+    LCL_Init(src);
+    return LCLE_Ok;
+}
+
+/// Copies toPrint and fullPath into the arena, once when they are the same string (the usual case).
+static LCL_Error LCL_StorePaths(LineCounterList* self, const char* toPrint, const char* fullPath, char** outToPrint, char** outFullPath) {
+    if (SA_Dup(&self->strings, toPrint, outToPrint) != SAE_Ok) return LCLE_AllocFailed;
+
+    if (fullPath == toPrint || strcmp(fullPath, toPrint) == 0) {
+        *outFullPath = *outToPrint;
+        return LCLE_Ok;
+    }
+    return SA_Dup(&self->strings, fullPath, outFullPath) == SAE_Ok ? LCLE_Ok : LCLE_AllocFailed;
+}
+
+/// Adds the fullPath column for the first counter whose fullPath differs from toPrint.
+static LCL_Error LCL_AddFullPathColumn(LineCounterList* self) {
+    self->fullPath = malloc((self->cap > 0 ? self->cap : 1) * sizeof(char*));
+    if (self->fullPath == NULL) return LCLE_AllocFailed;
+
+    if (self->len > 0) memcpy(self->fullPath, self->toPrint, self->len * sizeof(char*));
+    return LCLE_Ok;
+}
+
+/// Adds the LocStat columns for the first counter that has one.
+static LCL_Error LCL_AddLocColumns(LineCounterList* self) {
+    usize cap = self->cap > 0 ? self->cap : 1;
+    self->hasLocStat = calloc(cap, sizeof(bool));
+    self->emptyLines = malloc(cap * sizeof(usize));
+    self->commentLines = malloc(cap * sizeof(usize));
+    self->codeLines = malloc(cap * sizeof(usize));
+    self->preprocessorLines = malloc(cap * sizeof(usize));
+
+    if (self->hasLocStat == NULL || self->emptyLines == NULL || self->commentLines == NULL || self->codeLines == NULL
+        || self->preprocessorLines == NULL) {
+        free(self->hasLocStat);
+        free(self->emptyLines);
+        free(self->commentLines);
+        free(self->codeLines);
+        free(self->preprocessorLines);
+        self->hasLocStat = NULL;
+        self->emptyLines = self->commentLines = self->codeLines = self->preprocessorLines = NULL;
+        return LCLE_AllocFailed;
+    }
     return LCLE_Ok;
 }
 
+/// Fills row index of the columns, the paths are already in the arena.
+static LCL_Error LCL_WriteRow(LineCounterList* self, usize index, char* toPrint, char* fullPath, usize lines, const FileMeta* meta,
+    const LocStat* locStat, bool hasLocStat) {
+    if (fullPath != toPrint && self->fullPath == NULL) {
+        LCL_Error err = LCL_AddFullPathColumn(self);
+        if (err != LCLE_Ok) return err;
+    }
+    if (hasLocStat && self->hasLocStat == NULL) {
+        LCL_Error err = LCL_AddLocColumns(self);
+        if (err != LCLE_Ok) return err;
+    }
+
+    self->toPrint[index] = toPrint;
+    if (self->fullPath != NULL) self->fullPath[index] = fullPath;
+    self->lines[index] = lines;
+    self->size[index] = meta->size;
+    self->mtime[index] = meta->mtime;
+    self->mtimeNsec[index] = meta->mtimeNsec;
+
+    if (self->hasLocStat != NULL) {
+        self->hasLocStat[index] = hasLocStat;
+        self->emptyLines[index] = hasLocStat ? locStat->emptyLines : 0;
+        self->commentLines[index] = hasLocStat ? locStat->commentLines : 0;
+        self->codeLines[index] = hasLocStat ? locStat->codeLines : 0;
+        self->preprocessorLines[index] = hasLocStat ? locStat->preprocessorLines : 0;
+    }
+    return LCLE_Ok;
+}
+
+static inline const char* LCL_FullPath(const LineCounterList* self, usize index) {
+    return self->fullPath != NULL ? self->fullPath[index] : self->toPrint[index];
+}
+
 LCL_Error LCL_Append(LineCounterList* self, const char* name, usize lines, FileMeta* meta, LocStat locStat, bool hasLocStat) {
     LCL_Error err = LCL_Expand(self);
     if (err != LCLE_Ok) return err;
 
-    char* dname = strdup(name);
-    if (dname == NULL) return LCLE_AllocFailed;
+    char* toPrint;
+    char* fullPath;
+    err = LCL_StorePaths(self, name, meta->fullPath, &toPrint, &fullPath);
+    if (err != LCLE_Ok) return err;
 
-    self->data[self->len++] = (LineCounter) {
-        .toPrint = dname,
-        .lines = lines,
-        .meta = (FileMeta) {
-            .fullPath = strdup(meta->fullPath),
-            .mtime = meta->mtime,
-            .size = meta->size,
-        },
-        .hasLocStat = hasLocStat,
-        .locStat = locStat,
-    };
-    if (self->data[self->len - 1].meta.fullPath == NULL) {
-        return LCLE_AllocFailed;
-    }
+    err = LCL_WriteRow(self, self->len, toPrint, fullPath, lines, meta, &locStat, hasLocStat);
+    if (err != LCLE_Ok) return err;
+
+    self->order[self->len] = (uint32_t)self->len;
+    self->len++;
     return LCLE_Ok;
 }
 
 LCL_Error LCL_Set(LineCounterList* self, usize index, const char* toPrint, usize lines, FileMeta* meta, LocStat locStat, bool hasLocStat) {
     if (index >= self->len) return LCLE_IndexOutOfRange;
 
-    free(self->data[index].toPrint);
-    self->data[index].toPrint = strdup(toPrint);
-    if (self->data[index].toPrint == NULL) {
-        return LCLE_AllocFailed;
+    // the same file counted again keeps its paths, anything else would grow the arena
+    char* storedToPrint = self->toPrint[index];
+    char* storedFullPath = (char*)LCL_FullPath(self, index);
+    if (strcmp(storedToPrint, toPrint) != 0 || strcmp(storedFullPath, meta->fullPath) != 0) {
+        LCL_Error err = LCL_StorePaths(self, toPrint, meta->fullPath, &storedToPrint, &storedFullPath);
+        if (err != LCLE_Ok) return err;
     }
 
-    self->data[index].lines = lines;
-    self->data[index].meta = (FileMeta) {
-        .fullPath = strdup(meta->fullPath),
-        .mtime = meta->mtime,
-        .size = meta->size,
-    };
-    if (self->data[index].meta.fullPath == NULL) {
-        return LCLE_AllocFailed;
+    return LCL_WriteRow(self, index, storedToPrint, storedFullPath, lines, meta, &locStat, hasLocStat);
+}
+
+LCL_Error LCL_SwapRemove(LineCounterList* self, usize index) {
+    if (index >= self->len) return LCLE_IndexOutOfRange;
+    const usize last = self->len - 1;
+
+    if (index != last) {
+        self->toPrint[index] = self->toPrint[last];
+        if (self->fullPath != NULL) self->fullPath[index] = self->fullPath[last];
+        self->lines[index] = self->lines[last];
+        self->size[index] = self->size[last];
+        self->mtime[index] = self->mtime[last];
+        self->mtimeNsec[index] = self->mtimeNsec[last];
+        if (self->hasLocStat != NULL) {
+            self->hasLocStat[index] = self->hasLocStat[last];
+            self->emptyLines[index] = self->emptyLines[last];
+            self->commentLines[index] = self->commentLines[last];
+            self->codeLines[index] = self->codeLines[last];
+            self->preprocessorLines[index] = self->preprocessorLines[last];
+        }
+    }
+
+    // the last row is now at index, the removed one leaves the order
+    usize removedPos = 0;
+    for (usize pos = 0; pos < self->len; ++pos) {
+        if (self->order[pos] == index) removedPos = pos;
+        if (self->order[pos] == last) self->order[pos] = (uint32_t)index;
     }
+    memmove(self->order + removedPos, self->order + removedPos + 1, (last - removedPos) * sizeof(uint32_t));
 
-    self->data[index].hasLocStat = hasLocStat;
-    self->data[index].locStat = locStat;
+    self->len--;
     return LCLE_Ok;
 }
 
-LCL_Error LCL_Get(LineCounterList* self, usize index, LineCounter** out) {
+LCL_Error LCL_Get(const LineCounterList* self, usize index, LineCounter* out) {
     if (index >= self->len) return LCLE_IndexOutOfRange;
 
-    *out = &self->data[index];
+    bool hasLocStat = self->hasLocStat != NULL && self->hasLocStat[index];
+    *out = (LineCounter) {
+        .toPrint = self->toPrint[index],
+        .lines = self->lines[index],
+        .meta = (FileMeta) {
+            .fullPath = (char*)LCL_FullPath(self, index),
+            .size = self->size[index],
+            .mtime = self->mtime[index],
+            .mtimeNsec = self->mtimeNsec[index],
+        },
+        .hasLocStat = hasLocStat,
+    };
+    if (hasLocStat) {
+        out->locStat = (LocStat) {
+            .emptyLines = self->emptyLines[index],
+            .commentLines = self->commentLines[index],
+            .codeLines = self->codeLines[index],
+            .preprocessorLines = self->preprocessorLines[index],
+            .totalLines = self->lines[index],
+        };
+    }
     return LCLE_Ok;
 }
 
-static int cmpByLines(const void* p1, const void* p2) {
-    usize lines1 = ((const LineCounter*)p1)->lines;
-    usize lines2 = ((const LineCounter*)p2)->lines;
-
-    if (lines1 < lines2) return -1;
-    if (lines1 > lines2) return 1;
-    return 0;
+LCL_Error LCL_GetOrdered(const LineCounterList* self, usize pos, LineCounter* out) {
+    if (pos >= self->len) return LCLE_IndexOutOfRange;
+    return LCL_Get(self, self->order[pos], out);
 }
 
-static int cmpByLinesReversed(const void* p1, const void* p2) {
-    return -cmpByLines(p1, p2);
+#ifndef LCL_SMALL_SORT
+#    define LCL_SMALL_SORT 16 ///< below this many keys an insertion sort is used
+#endif
+
+/// A row with the integer key it is sorted by.
+typedef struct LCL_IntKey {
+    uint64_t key;
+    uint32_t row;
+} LCL_IntKey;
+
+/// A row with the string key it is sorted by.
+typedef struct LCL_StrKey {
+    uint64_t word; ///< characters of key at the current depth, see LCL_LoadWord
+    const char* key;
+    uint32_t row;
+    uint32_t lines; ///< of the row when ties are ordered by them, UINT32_MAX for that many or more
+} LCL_StrKey;
+
+/// Maps a signed value to an unsigned key in the same order.
+static inline uint64_t LCL_SignedKey(int64_t value) {
+    return (uint64_t)value ^ ((uint64_t)1 << 63);
 }
 
-static int cmpByName(const void* p1, const void* p2) {
-    const LineCounter* a = (const LineCounter*)p1;
-    const LineCounter* b = (const LineCounter*)p2;
+/**
+ * Stable LSD radix sort by key, a byte per pass. Passes where every key has the same byte are
+ * skipped, so small keys (lines counts, sizes) cost only a few. The result ends up in keys,
+ * tmp must have room for n keys.
+ */
+static void LCL_RadixSort(LCL_IntKey* keys, LCL_IntKey* tmp, usize n) {
+    usize counts[8][256] = {0};
+
+    for (usize i = 0; i < n; ++i) {
+        uint64_t key = keys[i].key;
+        for (usize b = 0; b < 8; ++b) counts[b][(key >> (b * 8)) & 0xff]++;
+    }
 
-    const char* name1 = strrchr(a->meta.fullPath, '/');
-    const char* name2 = strrchr(b->meta.fullPath, '/');
+    LCL_IntKey* src = keys;
+    LCL_IntKey* dst = tmp;
+    for (usize b = 0; b < 8; ++b) {
+        const usize shift = b * 8;
+        if (counts[b][(src[0].key >> shift) & 0xff] == n) continue;
+
+        usize offsets[256];
+        usize sum = 0;
+        for (usize d = 0; d < 256; ++d) {
+            offsets[d] = sum;
+            sum += counts[b][d];
+        }
 
-    name1 = name1 ? name1 + 1 : a->meta.fullPath;
-    name2 = name2 ? name2 + 1 : b->meta.fullPath;
+        for (usize i = 0; i < n; ++i) dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
 
-    int cmp = strcmp(name1, name2);
-    if (cmp != 0) return cmp;
+        LCL_IntKey* swap = src;
+        src = dst;
+        dst = swap;
+    }
 
-    // tie-break by lines count
-    if (a->lines < b->lines) return -1;
-    if (a->lines > b->lines) return 1;
-    return 0;
+    if (src != keys) memcpy(keys, src, n * sizeof(LCL_IntKey));
+}
+
+/// Sorts rows by an integer column, descending keys are just inverted.
+static LCL_Error LCL_SortByInt(LineCounterList* self, CFG_SortMode mode, bool reverse) {
+    LCL_IntKey* keys = malloc(2 * self->len * sizeof(LCL_IntKey));
+    if (keys == NULL) return LCLE_AllocFailed;
+
+    const uint64_t flip = reverse ? UINT64_MAX : 0;
+    for (usize row = 0; row < self->len; ++row) {
+        uint64_t key = 0;
+        switch (mode) {
+        case SM_Lines:
+            key = self->lines[row];
+            break;
+        case SM_Size:
+            key = LCL_SignedKey(self->size[row]);
+            break;
+        default:
+            key = LCL_SignedKey(self->mtime[row]);
+            break;
+        }
+        keys[row] = (LCL_IntKey) { .key = key ^ flip, .row = (uint32_t)row };
+    }
+
+    LCL_RadixSort(keys, keys + self->len, self->len);
+    for (usize pos = 0; pos < self->len; ++pos) self->order[pos] = keys[pos].row;
+
+    free(keys);
+    return LCLE_Ok;
 }
 
-static int cmpByNameReversed(const void* p1, const void* p2) {
-    return -cmpByName(p1, p2);
+/**
+ * How the string sort orders keys, dir is 1 or -1 for reversed. Radix passes move keys between
+ * keys and tmp instead of copying them back every time, so a group may be sorted in either of
+ * them, but always ends up at its place in keys (see LCL_Home).
+ */
+typedef struct LCL_StrSort {
+    int dir;
+    const usize* lines; ///< equal strings are ordered by lines (in dir) before rows, or NULL
+    bool failed; ///< a scratch buffer could not be allocated
+
+    LCL_StrKey* keys; ///< all keys being sorted
+    LCL_StrKey* tmp;  ///< as many keys, for the radix passes
+    usize len;
+} LCL_StrSort;
+
+/// The same place as keys in the other buffer of the sort.
+static inline LCL_StrKey* LCL_Other(const LCL_StrSort* sort, LCL_StrKey* keys) {
+    if (keys >= sort->keys && keys < sort->keys + sort->len) return sort->tmp + (keys - sort->keys);
+    return sort->keys + (keys - sort->tmp);
 }
 
-static int cmpByExt(const void* p1, const void* p2) {
-    const char* path1 = ((const LineCounter*)p1)->meta.fullPath;
-    const char* path2 = ((const LineCounter*)p2)->meta.fullPath;
+/// Where the sorted keys have to end up.
+static inline LCL_StrKey* LCL_Home(const LCL_StrSort* sort, LCL_StrKey* keys) {
+    if (keys >= sort->keys && keys < sort->keys + sort->len) return keys;
+    return sort->keys + (keys - sort->tmp);
+}
 
-    const char* ext1 = GetExtension(path1);
-    const char* ext2 = GetExtension(path2);
+/// Moves keys sorted in tmp to their place in keys.
+static inline void LCL_MoveHome(const LCL_StrSort* sort, LCL_StrKey* keys, usize n) {
+    if (n == 0) return;
+    LCL_StrKey* home = LCL_Home(sort, keys);
+    if (home != keys) memcpy(home, keys, n * sizeof(LCL_StrKey));
+}
 
-    return strcmp(ext1, ext2);
+/// Lines of the row of key, the column is only read for the few that don't fit the key.
+static inline usize LCL_TieLines(const LCL_StrSort* sort, const LCL_StrKey* key) {
+    return key->lines != UINT32_MAX ? key->lines : sort->lines[key->row];
 }
 
-static int cmpByExtReversed(const void* p1, const void* p2) {
-    return -cmpByExt(p1, p2);
+static inline int LCL_CompareTies(const LCL_StrSort* sort, const LCL_StrKey* a, const LCL_StrKey* b) {
+    if (sort->lines != NULL) {
+        usize linesA = LCL_TieLines(sort, a);
+        usize linesB = LCL_TieLines(sort, b);
+        if (linesA != linesB) return (linesA < linesB ? -1 : 1) * sort->dir;
+    }
+    return a->row < b->row ? -1 : (a->row > b->row ? 1 : 0);
 }
 
-static int cmpByPath(const void* p1, const void* p2) {
-    const char* path1 = ((const LineCounter*)p1)->meta.fullPath;
-    const char* path2 = ((const LineCounter*)p2)->meta.fullPath;
+/// Compares two keys whose first depth characters are equal, by their loaded words first.
+static inline int LCL_CompareStrKeys(const LCL_StrSort* sort, const LCL_StrKey* a, const LCL_StrKey* b, usize depth) {
+    if (a->word != b->word) return (a->word < b->word ? -1 : 1) * sort->dir;
+    if ((a->word & 0xff) == 0) return LCL_CompareTies(sort, a, b);
 
-    return strcmp(path1, path2);
+    int cmp = strcmp(a->key + depth + 8, b->key + depth + 8);
+    if (cmp != 0) return cmp * sort->dir;
+    return LCL_CompareTies(sort, a, b);
 }
 
-static int cmpByPathReversed(const void* p1, const void* p2) {
-    return -cmpByPath(p1, p2);
+/// Sorts keys whose words at depth are loaded and moves them home.
+static void LCL_InsertionSort(const LCL_StrSort* sort, LCL_StrKey* keys, usize n, usize depth) {
+    for (usize i = 1; i < n; ++i) {
+        LCL_StrKey key = keys[i];
+        usize j = i;
+        while (j > 0 && LCL_CompareStrKeys(sort, &keys[j - 1], &key, depth) > 0) {
+            keys[j] = keys[j - 1];
+            --j;
+        }
+        keys[j] = key;
+    }
+    LCL_MoveHome(sort, keys, n);
 }
 
-static int cmpByMTime(const void* p1, const void* p2) {
-    time_t mtime1 = ((const LineCounter*)p1)->meta.mtime;
-    time_t mtime2 = ((const LineCounter*)p2)->meta.mtime;
+/**
+ * Orders keys with equal strings by lines (if needed) and row: a stable radix sort by row,
+ * then one by lines. Keys still in row order (see LCL_SortStrKeys) skip the first one. Large
+ * groups are rare (a common name or extension) and get their own scratch buffers.
+ */
+static void LCL_SortTies(LCL_StrSort* sort, LCL_StrKey* keys, usize n, bool rowOrder) {
+    if (rowOrder && sort->lines == NULL) {
+        LCL_MoveHome(sort, keys, n);
+        return;
+    }
+    if (n <= LCL_SMALL_SORT) {
+        LCL_InsertionSort(sort, keys, n, 0);
+        return;
+    }
+
+    LCL_IntKey* ties = malloc(2 * n * sizeof(LCL_IntKey));
+    LCL_StrKey* sorted = malloc(n * sizeof(LCL_StrKey));
+    if (ties == NULL || sorted == NULL) {
+        free(ties);
+        free(sorted);
+        sort->failed = true;
+        return;
+    }
+
+    // rows are indexes into keys from here on
+    for (usize i = 0; i < n; ++i) ties[i] = (LCL_IntKey) { .key = keys[i].row, .row = (uint32_t)i };
+    if (!rowOrder) LCL_RadixSort(ties, ties + n, n);
+
+    if (sort->lines != NULL) {
+        const uint64_t flip = sort->dir < 0 ? UINT64_MAX : 0;
+        for (usize i = 0; i < n; ++i) ties[i].key = LCL_TieLines(sort, &keys[ties[i].row]) ^ flip;
+        LCL_RadixSort(ties, ties + n, n);
+    }
 
-    if (mtime1 < mtime2) return -1;
-    if (mtime1 > mtime2) return 1;
-    return 0;
+    for (usize i = 0; i < n; ++i) sorted[i] = keys[ties[i].row];
+    memcpy(LCL_Home(sort, keys), sorted, n * sizeof(LCL_StrKey));
+
+    free(ties);
+    free(sorted);
 }
 
-static int cmpByMTimeReversed(const void* p1, const void* p2) {
-    return -cmpByMTime(p1, p2);
+/// The next 8 characters of s as a big-endian word, zero after the end of the string.
+static inline uint64_t LCL_LoadWord(const char* s) {
+    uint64_t word = 0;
+    for (usize i = 0; i < 8; ++i) {
+        unsigned char c = (unsigned char)s[i];
+        word |= (uint64_t)c << (56 - 8 * i);
+        if (c == '\0') break;
+    }
+    return word;
 }
 
-static int cmpBySize(const void* p1, const void* p2) {
-    off_t size1 = ((const LineCounter*)p1)->meta.size;
-    off_t size2 = ((const LineCounter*)p2)->meta.size;
+#ifndef LCL_PREFETCH_DISTANCE
+#    define LCL_PREFETCH_DISTANCE 16
+#endif
 
-    if (size1 < size2) return -1;
-    if (size1 > size2) return 1;
-    return 0;
+static void LCL_LoadWords(LCL_StrKey* keys, usize n, usize depth) {
+    // the strings are all over the arena by now, asking for them early hides most of the misses
+    for (usize i = 0; i < n; ++i) {
+        if (i + LCL_PREFETCH_DISTANCE < n) __builtin_prefetch(keys[i + LCL_PREFETCH_DISTANCE].key + depth);
+        keys[i].word = LCL_LoadWord(keys[i].key + depth);
+    }
 }
 
-static int cmpBySizeReversed(const void* p1, const void* p2) {
-    return -cmpBySize(p1, p2);
+static inline void LCL_SwapStrKeys(LCL_StrKey* a, LCL_StrKey* b) {
+    LCL_StrKey tmp = *a;
+    *a = *b;
+    *b = tmp;
 }
 
-LCL_Error LCL_SortBy(LineCounterList* self, CFG_SortMode mode, bool reverse) {
-    if (mode == SM_NotSort) {
-        if (reverse) {
-            for (usize i = 0; i < self->len/2; ++i) {
-                LineCounter tmp = self->data[i];
-                self->data[i] = self->data[self->len - i - 1];
-                self->data[self->len - i - 1] = tmp;
+#ifndef LCL_RADIX_SORT
+#    define LCL_RADIX_SORT 256 ///< from this many keys on words are radix sorted
+#endif
+
+static void LCL_SortStrKeys(LCL_StrSort* sort, LCL_StrKey* keys, usize n, usize depth, bool rowOrder);
+
+/// Sorts keys whose words at depth are equal, by the rest of their strings.
+static void LCL_SortEqualWords(LCL_StrSort* sort, LCL_StrKey* keys, usize n, usize depth, uint64_t word, bool rowOrder) {
+    if (n <= 1) {
+        LCL_MoveHome(sort, keys, n);
+    } else if ((word & 0xff) == 0) {
+        // the strings end in this word
+        LCL_SortTies(sort, keys, n, rowOrder);
+    } else {
+        LCL_LoadWords(keys, n, depth + 8);
+        LCL_SortStrKeys(sort, keys, n, depth + 8, rowOrder);
+    }
+}
+
+/**
+ * MSD radix sort of many keys by the first byte their words differ in, a stable pass into
+ * buckets of the other buffer that are then sorted on their own. Bytes every key shares (a
+ * common directory prefix) are skipped after a single pass over the words.
+ */
+static void LCL_RadixSortWords(LCL_StrSort* sort, LCL_StrKey* keys, usize n, usize depth, bool rowOrder) {
+    const uint64_t flip = sort->dir < 0 ? UINT64_MAX : 0;
+
+    uint64_t diff = 0;
+    for (usize i = 1; i < n; ++i) diff |= keys[i].word ^ keys[0].word;
+    if (diff == 0) {
+        LCL_SortEqualWords(sort, keys, n, depth, keys[0].word, rowOrder);
+        return;
+    }
+
+    // the bytes before the first different one are shared, and not the end of the strings
+    const usize shift = 56 - (usize)(__builtin_clzll(diff) / 8) * 8;
+    usize counts[256] = {0};
+    for (usize i = 0; i < n; ++i) counts[((keys[i].word ^ flip) >> shift) & 0xff]++;
+
+    usize offsets[256];
+    usize sum = 0;
+    for (usize d = 0; d < 256; ++d) {
+        offsets[d] = sum;
+        sum += counts[d];
+    }
+
+    LCL_StrKey* dst = LCL_Other(sort, keys);
+    for (usize i = 0; i < n; ++i) dst[offsets[((keys[i].word ^ flip) >> shift) & 0xff]++] = keys[i];
+
+    for (usize d = 0, start = 0; d < 256; start += counts[d++]) {
+        usize count = counts[d];
+        if (count == 0) continue;
+
+        LCL_StrKey* bucket = dst + start;
+        if (((bucket[0].word >> shift) & 0xff) == 0) {
+            LCL_SortEqualWords(sort, bucket, count, depth, bucket[0].word, rowOrder);
+        } else {
+            LCL_SortStrKeys(sort, bucket, count, depth, rowOrder);
+        }
+    }
+}
+
+/**
+ * Multikey quicksort (Bentley & Sedgewick) over 8 characters at a time: keys are split by
+ * their word at depth into smaller, equal and greater ones, and only the equal ones move on
+ * to the next word. Words are loaded once per level, so strings are mostly compared through
+ * keys already in cache instead of a strcmp per comparison. Large groups are split by a radix
+ * sort instead, which is stable: keys still in row order (as they start) stay in it, so their
+ * ties need less work. Words at depth must be loaded.
+ */
+static void LCL_SortStrKeys(LCL_StrSort* sort, LCL_StrKey* keys, usize n, usize depth, bool rowOrder) {
+    if (n >= LCL_RADIX_SORT) {
+        LCL_RadixSortWords(sort, keys, n, depth, rowOrder);
+        return;
+    }
+
+    while (n > LCL_SMALL_SORT) {
+        // median of three
+        uint64_t a = keys[0].word;
+        uint64_t b = keys[n / 2].word;
+        uint64_t c = keys[n - 1].word;
+        uint64_t pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+
+        // [0, lt) before the pivot, [lt, gt) equal, [gt, n) after it, in the direction of the sort
+        usize lt = 0, i = 0, gt = n;
+        while (i < gt) {
+            uint64_t word = keys[i].word;
+            int cmp = (word < pivot ? -1 : (word > pivot ? 1 : 0)) * sort->dir;
+            if (cmp < 0) {
+                LCL_SwapStrKeys(&keys[lt++], &keys[i++]);
+            } else if (cmp > 0) {
+                LCL_SwapStrKeys(&keys[i], &keys[--gt]);
+            } else {
+                ++i;
             }
         }
-        return LCLE_Ok;
+
+        LCL_SortStrKeys(sort, keys, lt, depth, false);
+        LCL_SortEqualWords(sort, keys + lt, gt - lt, depth, pivot, false);
+
+        keys += gt;
+        n -= gt;
     }
+    LCL_InsertionSort(sort, keys, n, depth);
+}
 
-    typedef int CmpCallback(const void*, const void*);
-    CmpCallback* cmp = NULL;
+/// Sorts rows by path, name or extension, found once per row instead of once per comparison.
+static LCL_Error LCL_SortByStr(LineCounterList* self, CFG_SortMode mode, bool reverse) {
+    LCL_StrKey* keys = malloc(2 * self->len * sizeof(LCL_StrKey));
+    if (keys == NULL) return LCLE_AllocFailed;
+
+    for (usize row = 0; row < self->len; ++row) {
+        const char* path = LCL_FullPath(self, row);
+
+        LCL_StrKey* key = &keys[row];
+        *key = (LCL_StrKey) { .key = path, .row = (uint32_t)row };
+        if (mode == SM_Name) {
+            const char* name = strrchr(path, '/');
+            key->key = name ? name + 1 : path;
+            key->lines = self->lines[row] < UINT32_MAX ? (uint32_t)self->lines[row] : UINT32_MAX;
+        } else if (mode == SM_Ext) {
+            const char* ext = GetExtension(path);
+            key->key = ext ? ext : "";
+        }
+    }
+
+    LCL_StrSort sort = {
+        .dir = reverse ? -1 : 1,
+        .lines = mode == SM_Name ? self->lines : NULL,
+        .keys = keys,
+        .tmp = keys + self->len,
+        .len = self->len,
+    };
+    LCL_LoadWords(keys, self->len, 0);
+    LCL_SortStrKeys(&sort, keys, self->len, 0, true);
+    if (!sort.failed) {
+        for (usize pos = 0; pos < self->len; ++pos) self->order[pos] = keys[pos].row;
+    }
+
+    free(keys);
+    return sort.failed ? LCLE_AllocFailed : LCLE_Ok;
+}
+
+/**
+ * Sorts the order column, reverse only flips the direction of the keys: ties (equal keys)
+ * always keep the order rows were appended in. Integer keys go through a radix sort, string
+ * keys through a multikey quicksort (radix sorting large groups).
+ */
+LCL_Error LCL_SortBy(LineCounterList* self, CFG_SortMode mode, bool reverse) {
+    // rows start in the order they were appended, so ties always keep it
+    for (usize pos = 0; pos < self->len; ++pos) self->order[pos] = (uint32_t)pos;
 
     switch (mode) {
+    case SM_NotSort:
+        if (reverse) {
+            for (usize i = 0; i < self->len / 2; ++i) {
+                uint32_t tmp = self->order[i];
+                self->order[i] = self->order[self->len - i - 1];
+                self->order[self->len - i - 1] = tmp;
+            }
+        }
+        return LCLE_Ok;
     case SM_Lines:
-        cmp = reverse ? cmpByLinesReversed : cmpByLines;
-        break;
+    case SM_MTime:
+    case SM_Size:
+        return self->len > 0 ? LCL_SortByInt(self, mode, reverse) : LCLE_Ok;
     case SM_Path:
-        cmp = reverse ? cmpByPathReversed : cmpByPath;
-        break;
     case SM_Name:
-        cmp = reverse ? cmpByNameReversed : cmpByName;
-        break;
     case SM_Ext:
-        cmp = reverse ? cmpByExtReversed : cmpByExt;
-        break;
-    case SM_MTime:
-        cmp = reverse ? cmpByMTimeReversed : cmpByMTime;
-        break;
-    case SM_Size:
-        cmp = reverse ? cmpBySizeReversed : cmpBySize;
-        break;
+        return self->len > 0 ? LCL_SortByStr(self, mode, reverse) : LCLE_Ok;
     default:
         return LCLE_InvalidArgument;
     }
-
-    if (cmp == NULL) return LCLE_InvalidArgument;
-
-    qsort(self->data, self->len, sizeof(LineCounter), cmp);
-    return LCLE_Ok;
 }
 
 LCL_Error LCL_Print(const LineCounterList* self, FILE* out) {
-    if (self->len == 0) {
-        fputc('[', out);
-        fputc(']', out);
-        return LCLE_Ok;
-    }
-
     fputc('[', out);
-
-    fprintf(out, "%s: %zu", self->data[0].toPrint, self->data[0].lines);
-    for (LineCounter* c = self->data + 1; c < self->data + self->len; ++c) {
-        fprintf(out, ", %s: %zu", c->toPrint, c->lines);
+    for (usize pos = 0; pos < self->len; ++pos) {
+        uint32_t row = self->order[pos];
+        fprintf(out, pos > 0 ? ", %s: %zu" : "%s: %zu", self->toPrint[row], self->lines[row]);
     }
-
     fputc(']', out);
     return LCLE_Ok;
 }
@@ -0,0 +1,133 @@
+#include <LocMatcher.h>
+
+#include <LocSettings.h>
+
+#include <Definitions.h>
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint16_t LM_NewNode(LocMatcher* self, uint8_t byte) {
+    if (self->nodesCount >= LM_MAX_NODES) return 0;
+
+    uint16_t idx = (uint16_t)self->nodesCount++;
+    self->nodes[idx] = (LM_Node) { .byte = byte };
+    return idx;
+}
+
+static uint16_t LM_FindChild(const LocMatcher* self, uint16_t node, uint8_t byte) {
+    for (uint16_t child = self->nodes[node].child; child != 0; child = self->nodes[child].next) {
+        if (self->nodes[child].byte == byte) return child;
+    }
+    return 0;
+}
+
+static LM_Error LM_Add(LocMatcher* self, LM_Kind kind, const char* str, const StringDelimPair* pair) {
+    usize len = strlen(str);
+    if (len == 0) return LME_Ok;
+    if (self->delimsCount >= LM_MAX_DELIMS) return LME_TooManyDelims;
+
+    usize idx = self->delimsCount++;
+    self->delims[idx] = (LM_Delim) { .kind = kind, .str = str, .pair = pair, .len = len };
+
+    uint8_t byte = (uint8_t)str[0];
+    uint16_t node = self->first[byte];
+    if (node == 0) {
+        if ((node = LM_NewNode(self, byte)) == 0) return LME_TooManyDelims;
+        self->first[byte] = node;
+    }
+
+    for (usize i = 1; i < len; ++i) {
+        byte = (uint8_t)str[i];
+        uint16_t child = LM_FindChild(self, node, byte);
+        if (child == 0) {
+            if ((child = LM_NewNode(self, byte)) == 0) return LME_TooManyDelims;
+            self->nodes[child].next = self->nodes[node].child;
+            self->nodes[node].child = child;
+        }
+        node = child;
+    }
+
+    // an earlier delimiter with the same text keeps its priority
+    if (self->nodes[node].delim == 0) {
+        self->nodes[node].delim = (uint8_t)(idx + 1);
+    }
+    return LME_Ok;
+}
+
+static LM_Error LM_AddAll(LocMatcher* self, LM_Kind kind, const char** delims) {
+    if (delims == NULL) return LME_Ok;
+
+    for (usize i = 0; delims[i] != NULL; ++i) {
+        LM_Error err = LM_Add(self, kind, delims[i], NULL);
+        if (err != LME_Ok) return err;
+    }
+    return LME_Ok;
+}
+
+LM_Error LM_Compile(LocMatcher* self, const LocEntry* lang) {
+    memset(self, 0, sizeof(*self));
+    self->lang = lang;
+    self->nodesCount = 1;
+
+    LM_Error err;
+    if ((err = LM_AddAll(self, LMK_String, lang->stringDelims)) != LME_Ok) return err;
+    if ((err = LM_AddAll(self, LMK_MultilineString, lang->multilineStringDelims)) != LME_Ok) return err;
+    if ((err = LM_AddAll(self, LMK_Char, lang->charDelims)) != LME_Ok) return err;
+    if ((err = LM_AddAll(self, LMK_Comment, lang->commentStarts)) != LME_Ok) return err;
+
+    if (lang->multilineCommentDelimPairs != NULL) {
+        for (const StringDelimPair* p = lang->multilineCommentDelimPairs; p->start != NULL; ++p) {
+            if ((err = LM_Add(self, LMK_MultilineComment, p->start, p)) != LME_Ok) return err;
+        }
+    }
+
+    return LM_AddAll(self, LMK_PPDirective, lang->ppDirectiveStarts);
+}
+
+const LM_Delim* LM_Match(const LocMatcher* self, const char* str, usize len) {
+    if (len == 0) return NULL;
+
+    uint16_t node = self->first[(unsigned char)str[0]];
+    uint8_t best = 0;
+
+    for (usize i = 1; node != 0; ++i) {
+        uint8_t delim = self->nodes[node].delim;
+        if (delim != 0 && (best == 0 || delim < best)) best = delim;
+
+        if (i >= len) break;
+        node = LM_FindChild(self, node, (uint8_t)str[i]);
+    }
+
+    return best != 0 ? &self->delims[best - 1] : NULL;
+}
+
+static LocMatcher* compiled = NULL;
+static pthread_once_t compiledOnce = PTHREAD_ONCE_INIT;
+
+static void LM_CompileAll() {
+    usize count = GetLocEntriesCount();
+    LocMatcher* matchers = calloc(count, sizeof(LocMatcher));
+    if (matchers == NULL) return;
+
+    const LocEntry* entries = GetLocEntries();
+    for (usize i = 0; i < count; ++i) {
+        if (LM_Compile(&matchers[i], &entries[i]) != LME_Ok) {
+            // LM_For returns NULL for it, so the caller reports the entry
+            matchers[i].lang = NULL;
+        }
+    }
+    compiled = matchers;
+}
+
+const LocMatcher* LM_For(const LocEntry* lang) {
+    pthread_once(&compiledOnce, LM_CompileAll);
+
+    const LocEntry* entries = GetLocEntries();
+    if (compiled == NULL || lang < entries || lang >= entries + GetLocEntriesCount()) return NULL;
+
+    const LocMatcher* matcher = &compiled[lang - entries];
+    return matcher->lang == lang ? matcher : NULL;
+}
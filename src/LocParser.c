@@ -1,9 +1,12 @@
 #include <LocParser.h>
 
+#include <LocMatcher.h>
 #include <LocSettings.h>
 #include <LocUtils.h>
 
+#include <ByteScan.h>
 #include <Definitions.h>
+#include <FileReader.h>
 #include <Utils.h>
 
 #include <ctype.h>
@@ -12,6 +15,8 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include <fcntl.h>
+
 LP_Error LP_Init(LocParser* self) {
     self->state = LPS_Default;
     self->continueSingleLineComment = false;
@@ -20,11 +25,25 @@ LP_Error LP_Init(LocParser* self) {
     self->hasCode = false;
     self->hasComment = false;
     self->hasPPDirective = false;
+
+    self->matcherLang = NULL;
+    self->matcher = NULL;
+
+    self->carry = NULL;
+    self->carryLen = 0;
+    self->carryCap = 0;
+
+    self->mmapThreshold = FR_DEFAULT_MMAP_THRESHOLD;
     return LPE_Ok;
 }
 
 LP_Error LP_Destroy(LocParser* self) {
     self->state = (LP_State) 0;
+
+    free(self->carry);
+    self->carry = NULL;
+    self->carryLen = 0;
+    self->carryCap = 0;
     return LPE_Ok;
 }
 
@@ -55,6 +74,24 @@ static inline bool IsAllSpace(const char* line, usize len) {
     return true;
 }
 
+// lines handed to LP_ParseLine are not NUL-terminated, so the prefix checks are bounded by the line length
+static inline bool LineHasPrefix(const char* str, usize len, const char* prefix, usize prefixLen) {
+    return len >= prefixLen && memcmp(str, prefix, prefixLen) == 0;
+}
+
+static const LocMatcher* LP_GetMatcher(LocParser* self, const LocEntry* lang) {
+    if (self->matcherLang == lang) return self->matcher;
+
+    const LocMatcher* matcher = LM_For(lang);
+    if (matcher == NULL) {
+        matcher = LM_Compile(&self->localMatcher, lang) == LME_Ok ? &self->localMatcher : NULL;
+    }
+
+    self->matcherLang = lang;
+    self->matcher = matcher;
+    return matcher;
+}
+
 LP_Error LP_ParseLine(LocParser* self, const LocEntry* lang, const char* line, usize len, LocStat* result) {
     if (IsAllSpace(line, len)) {
         self->hasCode = false;
@@ -90,6 +127,9 @@ LP_Error LP_ParseLine(LocParser* self, const LocEntry* lang, const char* line, u
         return LPE_Ok;
     }
 
+    const LocMatcher* matcher = LP_GetMatcher(self, lang);
+    if (matcher == NULL) return LPE_TooManyDelims;
+
     usize i = 0;
     while (i < len && isspace(line[i])) ++i;
 
@@ -97,53 +137,59 @@ LP_Error LP_ParseLine(LocParser* self, const LocEntry* lang, const char* line, u
         const char* ptr = &line[i];
         char current = line[i];
 
-        const char* s;
-        const StringDelimPair* p;
+        const LM_Delim* d;
 
         switch (self->state) {
         case LPS_Default:
-            if ((s = StartsWithAny(ptr, lang->stringDelims))) {
+            if (!LM_IsCandidate(matcher, current) || (d = LM_Match(matcher, ptr, len - i)) == NULL) {
+                if (!isspace(current)) {
+                    self->hasCode = true;
+                }
+                break;
+            }
+
+            switch (d->kind) {
+            case LMK_String:
                 self->state = LPS_InString;
-                self->lastStringDelim = s;
+                self->lastStringDelim = d->str;
+                self->lastDelimLen = d->len;
                 self->hasCode = true;
-                i += strlen(s) - 1;
+                i += d->len - 1;
                 break;
-            }
 
-            if ((s = StartsWithAny(ptr, lang->multilineStringDelims))) {
+            case LMK_MultilineString:
                 self->state = LPS_InMultilineString;
-                self->lastMultilineStringDelim = s;
+                self->lastMultilineStringDelim = d->str;
+                self->lastDelimLen = d->len;
                 self->hasCode = true;
-                i += strlen(s) - 1;
+                i += d->len - 1;
                 break;
-            }
 
-            if ((s = StartsWithAny(ptr, lang->charDelims))) {
+            case LMK_Char:
                 self->state = LPS_InChar;
-                self->lastCharDelim = s;
+                self->lastCharDelim = d->str;
+                self->lastDelimLen = d->len;
                 self->hasCode = true;
-                i += strlen(s) - 1;
+                i += d->len - 1;
                 break;
-            }
 
-            if ((s = StartsWithAny(ptr, lang->commentStarts))) {
+            case LMK_Comment:
                 if (lang->allowCommentContinues) {
                     bool hasBackslash = len > 0 && line[len - 1] == '\\';
                     self->continueSingleLineComment = hasBackslash;
                 }
                 self->hasComment = true;
                 goto end;
-            }
 
-            if ((p = StartsWithAnyPair(ptr, lang->multilineCommentDelimPairs))) {
+            case LMK_MultilineComment:
                 self->state = LPS_InMultilineComment;
-                self->lastMultilineCommentDelimPair = p;
+                self->lastMultilineCommentDelimPair = d->pair;
+                self->lastDelimLen = strlen(d->pair->end);
                 self->hasComment = true;
-                i += strlen(p->start) - 1;
+                i += d->len - 1;
                 break;
-            }
 
-            if ((s = StartsWithAny(ptr, lang->ppDirectiveStarts))) {
+            case LMK_PPDirective:
                 if (lang->allowPPDirectiveContinues) {
                     bool hasBackslash = len > 0 && line[len - 1] == '\\';
                     self->continuePPDirective = hasBackslash;
@@ -151,44 +197,49 @@ LP_Error LP_ParseLine(LocParser* self, const LocEntry* lang, const char* line, u
                 self->hasPPDirective = true;
                 goto fixAndEnd;
             }
-
-            if (!isspace(current)) {
-                self->hasCode = true;
-            }
-
             break;
 
         case LPS_InString:
-            if (current == '\\' && i + 1 < len) {
+            // nothing but a backslash or the closing delimiter changes the state, jump to the next one
+            i += BS_FindAny2(ptr, len - i, '\\', self->lastStringDelim[0]);
+            if (i >= len) break;
+
+            if (line[i] == '\\' && i + 1 < len) {
                 i++; // skip escaped character
                 break;
             }
-            if (HasPrefix(ptr, self->lastStringDelim)) {
+            if (LineHasPrefix(&line[i], len - i, self->lastStringDelim, self->lastDelimLen)) {
                 self->state = LPS_Default;
-                i += strlen(self->lastStringDelim) - 1;
+                i += self->lastDelimLen - 1;
             }
             break;
 
         case LPS_InMultilineString:
             self->hasCode = true;
-            if (current == '\\' && i + 1 < len) {
+            i += BS_FindAny2(ptr, len - i, '\\', self->lastMultilineStringDelim[0]);
+            if (i >= len) break;
+
+            if (line[i] == '\\' && i + 1 < len) {
                 i++; // skip escaped character
                 break;
             }
-            if (HasPrefix(ptr, self->lastMultilineStringDelim)) {
+            if (LineHasPrefix(&line[i], len - i, self->lastMultilineStringDelim, self->lastDelimLen)) {
                 self->state = LPS_Default;
-                i += strlen(self->lastMultilineStringDelim) - 1;
+                i += self->lastDelimLen - 1;
             }
             break;
 
         case LPS_InChar:
-            if (current == '\\' && i + 1 < len) {
+            i += BS_FindAny2(ptr, len - i, '\\', self->lastCharDelim[0]);
+            if (i >= len) break;
+
+            if (line[i] == '\\' && i + 1 < len) {
                 i++; // skip escaped character
                 break;
             }
-            if (HasPrefix(ptr, self->lastCharDelim)) {
+            if (LineHasPrefix(&line[i], len - i, self->lastCharDelim, self->lastDelimLen)) {
                 self->state = LPS_Default;
-                i += strlen(self->lastCharDelim) - 1;
+                i += self->lastDelimLen - 1;
             }
             break;
 
@@ -196,14 +247,20 @@ LP_Error LP_ParseLine(LocParser* self, const LocEntry* lang, const char* line, u
             self->hasComment = true;
             goto end;
 
-        case LPS_InMultilineComment:
+        case LPS_InMultilineComment: {
             self->hasComment = true;
-            if (HasPrefix(ptr, self->lastMultilineCommentDelimPair->end)) {
+
+            const char* end = self->lastMultilineCommentDelimPair->end;
+            i += BS_FindAny2(ptr, len - i, end[0], end[0]);
+            if (i >= len) break;
+
+            if (LineHasPrefix(&line[i], len - i, end, self->lastDelimLen)) {
                 self->state = LPS_Default;
-                i += strlen(self->lastMultilineCommentDelimPair->end) - 1;
+                i += self->lastDelimLen - 1;
             }
             break;
         }
+        }
     }
 
 fixAndEnd:
@@ -216,29 +273,12 @@ end:
 }
 
 LP_Error LP_ParseCode(LocParser* self, const LocEntry* lang, const char* code, LocStat* result) {
-    const char* lineStart = code;
-    const char* lineEnd = code;
-
-    while (*lineEnd) {
-        if (*lineEnd == '\n') {
-            LocStat res = {0};
-            LP_Error err = LP_ParseLine(self, lang, lineStart, lineEnd - lineStart, &res);
-            if (err != LPE_Ok) return err;
-
-            MergeResults(result, &res);
-            lineStart = lineEnd + 1;
-        }
-        lineEnd++;
-    }
+    LP_Error err = LP_ParseBuffer(self, lang, code, strlen(code), result);
+    if (err != LPE_Ok) return err;
 
     // process last line if it doesn't end with newline
-    if (lineEnd > lineStart) {
-        LocStat res = {0};
-        LP_Error err = LP_ParseLine(self, lang, lineStart, lineEnd - lineStart, &res);
-        if (err != LPE_Ok) return err;
-
-        MergeResults(result, &res);
-    }
+    err = LP_Finish(self, lang, result);
+    if (err != LPE_Ok) return err;
 
     if (self->state != LPS_Default) {
         return LPE_Unterminated;
@@ -247,77 +287,98 @@ LP_Error LP_ParseCode(LocParser* self, const LocEntry* lang, const char* code, L
     return LPE_Ok;
 }
 
-#ifndef LINE_BUF_SIZE
-#    define LINE_BUF_SIZE 4096
-#endif
+static LP_Error LP_AppendCarry(LocParser* self, const char* data, usize len) {
+    if (self->carryLen + len > self->carryCap) {
+        usize newCap = self->carryCap > 0 ? self->carryCap : 256;
+        while (newCap < self->carryLen + len) newCap *= 2;
 
-LP_Error LP_ParseFile(LocParser* self, const LocEntry* lang, const char* path, LocStat* result) {
-    FILE* fp = fopen(path, "r");
-    if (fp == NULL) {
-        return LPE_FileOpenError;
+        char* newCarry = realloc(self->carry, newCap);
+        if (newCarry == NULL) return LPE_AllocFailed;
+
+        self->carry = newCarry;
+        self->carryCap = newCap;
     }
 
-    char buf[LINE_BUF_SIZE];
-    char* line = buf;
-    usize totalLen = 0;
-    usize cap = sizeof(buf);
-    bool usingBuf = true;
+    memcpy(self->carry + self->carryLen, data, len);
+    self->carryLen += len;
+    return LPE_Ok;
+}
 
-    while (!feof(fp)) {
-        line = buf;
-        totalLen = 0;
-        cap = sizeof(buf);
-        usingBuf = true;
+LP_Error LP_ParseBuffer(LocParser* self, const LocEntry* lang, const char* buf, usize len, LocStat* result) {
+    const char* p = buf;
+    const char* end = buf + len;
 
-        while (fgets(line + totalLen, cap - totalLen, fp)) {
-            usize len = strlen(line + totalLen);
-            totalLen += len;
+    if (self->carryLen > 0) {
+        // finish the line started in the previous block
+        const char* nl = memchr(p, '\n', end - p);
+        if (nl == NULL) return LP_AppendCarry(self, p, end - p);
 
-            if (line[totalLen - 1] == '\n' || feof(fp)) {
-                break;
-            }
+        LP_Error err = LP_AppendCarry(self, p, nl - p);
+        if (err != LPE_Ok) return err;
 
-            if (usingBuf) {
-                cap = totalLen * 2;
-                char* tmp = malloc(cap);
-                if (tmp == NULL) {
-                    fclose(fp);
-                    return LPE_AllocFailed;
-                }
+        err = LP_ParseLine(self, lang, self->carry, self->carryLen, result);
+        self->carryLen = 0;
+        if (err != LPE_Ok) return err;
+        p = nl + 1;
+    }
 
-                memcpy(tmp, buf, totalLen);
-                line = tmp;
-                usingBuf = false;
-            } else {
-                cap *= 2;
-                char* tmp = realloc(line, cap);
-                if (tmp == NULL) {
-                    free(line);
-                    fclose(fp);
-                    return LPE_AllocFailed;
-                }
-                line = tmp;
-            }
-        }
+    while (p < end) {
+        const char* nl = memchr(p, '\n', end - p);
+        if (nl == NULL) return LP_AppendCarry(self, p, end - p);
 
-        if (totalLen == 0 && feof(fp)) {
-            break;
-        }
+        LP_Error err = LP_ParseLine(self, lang, p, nl - p, result);
+        if (err != LPE_Ok) return err;
+        p = nl + 1;
+    }
 
-        // Strip newline if present
-        if (totalLen > 0 && line[totalLen - 1] == '\n') {
-            totalLen--;
-        }
+    return LPE_Ok;
+}
 
-        LocStat res = {0};
-        LP_ParseLine(self, lang, line, totalLen, &res);
-        MergeResults(result, &res);
+LP_Error LP_Finish(LocParser* self, const LocEntry* lang, LocStat* result) {
+    if (self->carryLen == 0) return LPE_Ok;
 
-        if (!usingBuf) {
-            free(line);
-        }
+    LP_Error err = LP_ParseLine(self, lang, self->carry, self->carryLen, result);
+    self->carryLen = 0;
+    return err;
+}
+
+#ifndef LP_READ_BUF_SIZE
+#    define LP_READ_BUF_SIZE (64 * 1024)
+#endif
+
+LP_Error LP_ParseFile(LocParser* self, const LocEntry* lang, const char* path, LocStat* result) {
+    return LP_ParseFileAt(self, lang, AT_FDCWD, path, result);
+}
+
+typedef struct LP_FileParse {
+    LocParser* self;
+    const LocEntry* lang;
+    LocStat* result;
+    LP_Error err;
+} LP_FileParse;
+
+static bool LP_ParseBlock(void* arg, const char* data, usize len) {
+    LP_FileParse* parse = arg;
+    parse->err = LP_ParseBuffer(parse->self, parse->lang, data, len, parse->result);
+    return parse->err == LPE_Ok;
+}
+
+LP_Error LP_ParseFileAt(LocParser* self, const LocEntry* lang, int dirFd, const char* path, LocStat* result) {
+    char buf[LP_READ_BUF_SIZE];
+    FileReader reader;
+    if (FR_OpenAt(&reader, dirFd, path, self->mmapThreshold, buf, sizeof(buf)) != FRE_Ok) {
+        return LPE_FileOpenError;
     }
 
-    fclose(fp);
-    return LPE_Ok;
+    LP_FileParse parse = { .self = self, .lang = lang, .result = result, .err = LPE_Ok };
+    FR_Error frerr = FR_ForEach(&reader, LP_ParseBlock, &parse);
+    FR_Close(&reader);
+
+    if (frerr != FRE_Ok) {
+        // a block may have been cut short, whatever was carried over is not a line of the file
+        self->carryLen = 0;
+        return LPE_FileReadError;
+    }
+    if (parse.err != LPE_Ok) return parse.err;
+    return LP_Finish(self, lang, result);
 }
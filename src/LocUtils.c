@@ -3,40 +3,144 @@
 
 #include <Utils.h>
 
+#include <ctype.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
 #include <stdbool.h>
 
-bool GetLocLangFor(const char* filename, const LocEntry** out) {
-    if (filename == NULL || out == NULL) {
-        return false;
+typedef struct LangSlot {
+    const char* key; ///< NULL for an empty slot
+    usize keyLen;
+    uint64_t hash;
+    const LocEntry* entry;
+} LangSlot;
+
+/// Open addressing table from an extension or a file name to its LocEntry.
+typedef struct LangTable {
+    LangSlot* slots;
+    usize mask;
+    bool ignoreCase;
+} LangTable;
+
+static LangTable extensionsTable = { .ignoreCase = true };
+static LangTable namesTable = { .ignoreCase = false };
+static pthread_once_t tablesOnce = PTHREAD_ONCE_INIT;
+
+static uint64_t LangHash(const char* key, usize len, bool ignoreCase) {
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a
+    for (usize i = 0; i < len; ++i) {
+        unsigned char c = (unsigned char)key[i];
+        hash ^= ignoreCase ? (unsigned char)tolower(c) : c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool LangKeyEql(const LangSlot* slot, const char* key, usize len, bool ignoreCase) {
+    if (slot->keyLen != len) return false;
+    return ignoreCase ? strncasecmp(slot->key, key, len) == 0 : memcmp(slot->key, key, len) == 0;
+}
+
+static const LangSlot* LangTableFind(const LangTable* self, const char* key, usize len) {
+    if (self->slots == NULL) return NULL;
+
+    uint64_t hash = LangHash(key, len, self->ignoreCase);
+    for (usize i = hash & self->mask;; i = (i + 1) & self->mask) {
+        const LangSlot* slot = &self->slots[i];
+        if (slot->key == NULL) return NULL;
+        if (slot->hash == hash && LangKeyEql(slot, key, len, self->ignoreCase)) return slot;
     }
+}
+
+static void LangTableInsert(LangTable* self, const char* key, const LocEntry* entry) {
+    usize len = strlen(key);
+    // the first LocEntry claiming a key keeps it, same as the old linear scan
+    if (LangTableFind(self, key, len) != NULL) return;
+
+    uint64_t hash = LangHash(key, len, self->ignoreCase);
+    usize i = hash & self->mask;
+    while (self->slots[i].key != NULL) i = (i + 1) & self->mask;
 
-    const char* fileext = GetExtension(filename);
+    self->slots[i] = (LangSlot) { .key = key, .keyLen = len, .hash = hash, .entry = entry };
+}
+
+static bool LangTableInit(LangTable* self, usize keysCount) {
+    usize cap = 16;
+    while (cap < keysCount * 2) cap *= 2; // load factor stays under 1/2
 
-    const LocEntry* locEntries = GetLocEntries();
-    for (usize i = 0; i < GetLocEntriesCount(); ++i) {
-        const LocEntry* entry = &locEntries[i];
+    self->slots = calloc(cap, sizeof(LangSlot));
+    self->mask = cap - 1;
+    return self->slots != NULL;
+}
 
-        if (fileext != NULL && entry->extensions != NULL) {
+static usize CountKeys(const char** keys) {
+    usize count = 0;
+    if (keys != NULL) {
+        while (keys[count] != NULL) count++;
+    }
+    return count;
+}
+
+static void BuildLangTables() {
+    const LocEntry* entries = GetLocEntries();
+    const usize entriesCount = GetLocEntriesCount();
+
+    usize extensionsCount = 0, namesCount = 0;
+    for (usize i = 0; i < entriesCount; ++i) {
+        extensionsCount += CountKeys(entries[i].extensions);
+        namesCount += CountKeys(entries[i].names);
+    }
+
+    if (!LangTableInit(&extensionsTable, extensionsCount) || !LangTableInit(&namesTable, namesCount)) {
+        free(extensionsTable.slots);
+        free(namesTable.slots);
+        extensionsTable.slots = namesTable.slots = NULL;
+        return;
+    }
+
+    for (usize i = 0; i < entriesCount; ++i) {
+        const LocEntry* entry = &entries[i];
+        if (entry->extensions != NULL) {
             for (const char** ext = entry->extensions; *ext != NULL; ++ext) {
-                if (StrEql(fileext, *ext)) {
-                    *out = entry;
-                    return true;
-                }
+                LangTableInsert(&extensionsTable, *ext, entry);
             }
         }
-
         if (entry->names != NULL) {
             for (const char** name = entry->names; *name != NULL; ++name) {
-                if (StrEql(filename, *name)) {
-                    *out = entry;
-                    return true;
-                }
+                LangTableInsert(&namesTable, *name, entry);
             }
         }
     }
+}
 
+bool GetLocLangFor(const char* filename, const LocEntry** out) {
+    if (filename == NULL || out == NULL) {
+        return false;
+    }
+
+    pthread_once(&tablesOnce, BuildLangTables);
     *out = NULL;
+
+    const usize len = strlen(filename);
+    const LangSlot* slot = LangTableFind(&namesTable, filename, len);
+    if (slot != NULL) {
+        *out = slot->entry;
+        return true;
+    }
+
+    // the longest extension wins, so "x.d.ts" tries "d.ts" before "ts"
+    for (const char* dot = memchr(filename, '.', len); dot != NULL; dot = strchr(dot + 1, '.')) {
+        const char* ext = dot + 1;
+        slot = LangTableFind(&extensionsTable, ext, len - (usize)(ext - filename));
+        if (slot != NULL) {
+            *out = slot->entry;
+            return true;
+        }
+    }
+
     return false;
 }
@@ -0,0 +1,211 @@
+#include <NewlineCount.h>
+
+#include <Definitions.h>
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#    define NC_X86 1
+#    include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#    define NC_NEON 1
+#    include <arm_neon.h>
+#endif
+
+static usize NC_CountScalar(const char* buf, usize len) {
+    usize count = 0;
+    for (usize i = 0; i < len; ++i) {
+        if (buf[i] == '\n') count++;
+    }
+    return count;
+}
+
+static usize NC_CountSwar(const char* buf, usize len) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t low7 = 0x7f7f7f7f7f7f7f7fULL;
+    const uint64_t newlines = ones * '\n';
+
+    usize count = 0;
+    usize i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, buf + i, sizeof(word));
+
+        // bytes equal to '\n' become zero, then get their high bit set (exact, no false positives)
+        uint64_t x = word ^ newlines;
+        uint64_t zeros = ~(((x & low7) + low7) | x | low7);
+        count += (usize)__builtin_popcountll(zeros);
+    }
+
+    return count + NC_CountScalar(buf + i, len - i);
+}
+
+#ifdef NC_X86
+
+__attribute__((target("sse2"))) static usize NC_CountSSE2(const char* buf, usize len) {
+    const __m128i newlines = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+
+    usize count = 0;
+    usize i = 0;
+    while (i + 16 <= len) {
+        // per-byte counters overflow after 255 iterations
+        __m128i acc = _mm_setzero_si128();
+        usize blockEnd = len - i > 255 * 16 ? i + 255 * 16 : len;
+
+        for (; i + 16 <= blockEnd; i += 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(buf + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(chunk, newlines));
+        }
+
+        __m128i sums = _mm_sad_epu8(acc, zero);
+        count += (usize)_mm_extract_epi16(sums, 0) + (usize)_mm_extract_epi16(sums, 4);
+    }
+
+    return count + NC_CountScalar(buf + i, len - i);
+}
+
+__attribute__((target("avx2"))) static usize NC_CountAVX2(const char* buf, usize len) {
+    const __m256i newlines = _mm256_set1_epi8('\n');
+    const __m256i zero = _mm256_setzero_si256();
+
+    usize count = 0;
+    usize i = 0;
+    while (i + 32 <= len) {
+        __m256i acc = _mm256_setzero_si256();
+        usize blockEnd = len - i > 255 * 32 ? i + 255 * 32 : len;
+
+        for (; i + 32 <= blockEnd; i += 32) {
+            __m256i chunk = _mm256_loadu_si256((const __m256i*)(buf + i));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(chunk, newlines));
+        }
+
+        __m256i sums = _mm256_sad_epu8(acc, zero);
+        count += (usize)_mm256_extract_epi64(sums, 0) + (usize)_mm256_extract_epi64(sums, 1)
+            + (usize)_mm256_extract_epi64(sums, 2) + (usize)_mm256_extract_epi64(sums, 3);
+    }
+
+    return count + NC_CountScalar(buf + i, len - i);
+}
+
+__attribute__((target("avx512f,avx512bw"))) static usize NC_CountAVX512(const char* buf, usize len) {
+    const __m512i newlines = _mm512_set1_epi8('\n');
+
+    usize count = 0;
+    usize i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i chunk = _mm512_loadu_si512((const void*)(buf + i));
+        count += (usize)__builtin_popcountll(_mm512_cmpeq_epi8_mask(chunk, newlines));
+    }
+
+    if (i < len) {
+        __mmask64 tail = ~0ULL >> (64 - (len - i));
+        __m512i chunk = _mm512_maskz_loadu_epi8(tail, (const void*)(buf + i));
+        count += (usize)__builtin_popcountll(_mm512_mask_cmpeq_epi8_mask(tail, chunk, newlines));
+    }
+
+    return count;
+}
+
+#endif // NC_X86
+
+#ifdef NC_NEON
+
+static usize NC_CountNEON(const char* buf, usize len) {
+    const uint8x16_t newlines = vdupq_n_u8('\n');
+
+    usize count = 0;
+    usize i = 0;
+    while (i + 16 <= len) {
+        uint8x16_t acc = vdupq_n_u8(0);
+        usize blockEnd = len - i > 255 * 16 ? i + 255 * 16 : len;
+
+        for (; i + 16 <= blockEnd; i += 16) {
+            uint8x16_t chunk = vld1q_u8((const uint8_t*)(buf + i));
+            acc = vsubq_u8(acc, vceqq_u8(chunk, newlines));
+        }
+
+        count += vaddlvq_u8(acc);
+    }
+
+    return count + NC_CountScalar(buf + i, len - i);
+}
+
+#endif // NC_NEON
+
+static NC_CountFunc* const kernels[NCK_Count] = {
+    [NCK_Scalar] = NC_CountScalar,
+    [NCK_Swar] = NC_CountSwar,
+#ifdef NC_X86
+    [NCK_SSE2] = NC_CountSSE2,
+    [NCK_AVX2] = NC_CountAVX2,
+    [NCK_AVX512] = NC_CountAVX512,
+#endif
+#ifdef NC_NEON
+    [NCK_NEON] = NC_CountNEON,
+#endif
+};
+
+static const char* const kernelNames[NCK_Count] = {
+    [NCK_Scalar] = "scalar",
+    [NCK_Swar] = "swar",
+    [NCK_SSE2] = "sse2",
+    [NCK_AVX2] = "avx2",
+    [NCK_AVX512] = "avx512bw",
+    [NCK_NEON] = "neon",
+};
+
+bool NC_IsSupported(NC_Kernel kernel) {
+    if (kernel >= NCK_Count || kernels[kernel] == NULL) return false;
+
+#ifdef NC_X86
+    __builtin_cpu_init();
+    switch (kernel) {
+    case NCK_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case NCK_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case NCK_AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    default:
+        break;
+    }
+#endif
+
+    return true;
+}
+
+NC_Kernel NC_BestKernel() {
+    const NC_Kernel preferred[] = { NCK_AVX512, NCK_AVX2, NCK_NEON, NCK_SSE2, NCK_Swar };
+    for (usize i = 0; i < sizeof(preferred) / sizeof(preferred[0]); ++i) {
+        if (NC_IsSupported(preferred[i])) return preferred[i];
+    }
+    return NCK_Scalar;
+}
+
+const char* NC_KernelName(NC_Kernel kernel) {
+    if (kernel >= NCK_Count) return "unknown";
+    return kernelNames[kernel];
+}
+
+usize NC_CountWith(NC_Kernel kernel, const char* buf, usize len) {
+    if (!NC_IsSupported(kernel)) kernel = NCK_Scalar;
+    return kernels[kernel](buf, len);
+}
+
+static NC_CountFunc* bestKernel = NC_CountScalar;
+static pthread_once_t bestKernelOnce = PTHREAD_ONCE_INIT;
+
+static void NC_ResolveBestKernel() {
+    bestKernel = kernels[NC_BestKernel()];
+}
+
+usize NC_Count(const char* buf, usize len) {
+    pthread_once(&bestKernelOnce, NC_ResolveBestKernel);
+    return bestKernel(buf, len);
+}
@@ -0,0 +1,146 @@
+#include <PathTrie.h>
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int PT_CompareName(const PT_Node* node, const char* name, usize len) {
+    usize n = node->nameLen < len ? node->nameLen : len;
+    int cmp = memcmp(node->name, name, n);
+    if (cmp != 0) return cmp;
+    return node->nameLen < len ? -1 : (node->nameLen > len ? 1 : 0);
+}
+
+/// Binary search, returns the index of the child or the index it should be inserted at.
+static usize PT_FindIndex(const PT_Node* node, const char* name, usize len, bool* found) {
+    usize lo = 0, hi = node->childrenCount;
+    while (lo < hi) {
+        usize mid = lo + (hi - lo) / 2;
+        int cmp = PT_CompareName(node->children[mid], name, len);
+        if (cmp == 0) {
+            *found = true;
+            return mid;
+        }
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+
+    *found = false;
+    return lo;
+}
+
+static void PT_FreeChildren(PT_Node* node) {
+    for (usize i = 0; i < node->childrenCount; ++i) {
+        PT_FreeChildren(node->children[i]);
+        free(node->children[i]->name);
+        free(node->children[i]);
+    }
+
+    free(node->children);
+    node->children = NULL;
+    node->childrenCount = 0;
+    node->childrenCap = 0;
+}
+
+PT_Error PT_Init(PathTrie* self) {
+    memset(self, 0, sizeof(*self));
+    return PTE_Ok;
+}
+
+PT_Error PT_Destroy(PathTrie* self) {
+    PT_FreeChildren(&self->root);
+    self->root.terminal = false;
+    return PTE_Ok;
+}
+
+static PT_Node* PT_AddChild(PT_Node* node, usize at, const char* name, usize len) {
+    if (node->childrenCount == node->childrenCap) {
+        usize newCap = node->childrenCap > 0 ? node->childrenCap * 2 : 4;
+        PT_Node** children = realloc(node->children, newCap * sizeof(PT_Node*));
+        if (children == NULL) return NULL;
+
+        node->children = children;
+        node->childrenCap = newCap;
+    }
+
+    PT_Node* child = calloc(1, sizeof(PT_Node));
+    if (child == NULL) return NULL;
+
+    child->name = strndup(name, len);
+    if (child->name == NULL) {
+        free(child);
+        return NULL;
+    }
+    child->nameLen = len;
+
+    memmove(&node->children[at + 1], &node->children[at], (node->childrenCount - at) * sizeof(PT_Node*));
+    node->children[at] = child;
+    node->childrenCount++;
+    return child;
+}
+
+PT_Error PT_Insert(PathTrie* self, const char* path) {
+    PT_Node* node = &self->root;
+
+    const char* p = path;
+    while (!node->terminal) {
+        while (*p == '/') ++p;
+        if (*p == '\0') break;
+
+        const char* end = strchr(p, '/');
+        usize len = end ? (usize)(end - p) : strlen(p);
+
+        bool found;
+        usize at = PT_FindIndex(node, p, len, &found);
+        PT_Node* child = found ? node->children[at] : PT_AddChild(node, at, p, len);
+        if (child == NULL) return PTE_AllocFailed;
+
+        node = child;
+        p += len;
+    }
+
+    if (!node->terminal) {
+        // everything below is covered now, the longer paths are not needed anymore
+        node->terminal = true;
+        PT_FreeChildren(node);
+    }
+    return PTE_Ok;
+}
+
+const PT_Node* PT_Child(const PT_Node* node, const char* name, usize len) {
+    if (node->childrenCount == 0) return NULL;
+
+    bool found;
+    usize at = PT_FindIndex(node, name, len, &found);
+    return found ? node->children[at] : NULL;
+}
+
+const PT_Node* PT_Walk(const PT_Node* node, const char* path, bool* covered) {
+    *covered = false;
+
+    const char* p = path;
+    while (node != NULL) {
+        if (node->terminal) {
+            *covered = true;
+            return node;
+        }
+
+        while (*p == '/') ++p;
+        if (*p == '\0') return node;
+
+        const char* end = strchr(p, '/');
+        usize len = end ? (usize)(end - p) : strlen(p);
+
+        node = PT_Child(node, p, len);
+        p += len;
+    }
+    return NULL;
+}
+
+bool PT_CoversFrom(const PT_Node* node, const char* path) {
+    bool covered;
+    PT_Walk(node, path, &covered);
+    return covered;
+}
@@ -0,0 +1,217 @@
+#include <RegexSet.h>
+
+#include <Definitions.h>
+#include <StringList.h>
+
+#include <ctype.h>
+#include <regex.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/// Unescapes a pattern without any special BRE characters, returns false if it has some.
+static bool RS_ParseLiteral(const char* pattern, RS_Literal* out) {
+    usize n = strlen(pattern);
+    usize i = 0;
+
+    out->kind = RSLK_Substring;
+    if (n > 0 && pattern[0] == '^') {
+        out->kind = RSLK_Prefix;
+        i++;
+    }
+
+    char* text = malloc(n + 1);
+    if (text == NULL) return false;
+
+    usize len = 0;
+    for (; i < n; ++i) {
+        char c = pattern[i];
+        if (c == '\\') {
+            if (i + 1 < n && strchr(".*[]\\^$", pattern[i + 1]) != NULL) {
+                text[len++] = pattern[++i];
+                continue;
+            }
+            goto notLiteral; // \( \{ \| \1 \w and friends
+        }
+
+        if (c == '$' && i == n - 1) {
+            out->kind = out->kind == RSLK_Prefix ? RSLK_Exact : RSLK_Suffix;
+            break;
+        }
+        if (strchr(".[*^$", c) != NULL) goto notLiteral;
+
+        text[len++] = c;
+    }
+
+    text[len] = '\0';
+    out->text = text;
+    out->len = len;
+    return true;
+
+notLiteral:
+    free(text);
+    return false;
+}
+
+static bool RS_HasBackReference(const char* pattern) {
+    for (const char* p = pattern; *p; ++p) {
+        if (*p != '\\') continue;
+        if (p[1] >= '1' && p[1] <= '9') return true;
+        if (p[1] != '\0') ++p;
+    }
+    return false;
+}
+
+static bool RS_ContainsIgnoreCase(const char* str, usize strLen, const char* sub, usize subLen) {
+    if (subLen == 0) return true;
+    if (strLen < subLen) return false;
+
+    const int first = tolower((unsigned char)sub[0]);
+    for (usize i = 0; i + subLen <= strLen; ++i) {
+        if (tolower((unsigned char)str[i]) != first) continue;
+        if (strncasecmp(str + i, sub, subLen) == 0) return true;
+    }
+    return false;
+}
+
+static bool RS_LiteralMatches(const RS_Literal* lit, const char* str, usize strLen) {
+    switch (lit->kind) {
+    case RSLK_Substring:
+        return RS_ContainsIgnoreCase(str, strLen, lit->text, lit->len);
+    case RSLK_Prefix:
+        return strLen >= lit->len && strncasecmp(str, lit->text, lit->len) == 0;
+    case RSLK_Suffix:
+        return strLen >= lit->len && strncasecmp(str + strLen - lit->len, lit->text, lit->len) == 0;
+    case RSLK_Exact:
+        return strLen == lit->len && strncasecmp(str, lit->text, lit->len) == 0;
+    }
+    return false;
+}
+
+static RS_Error RS_BuildCombined(RegexSet* self, StringList* patterns, const bool* isRegex) {
+    usize cap = 1;
+    usize count = 0;
+    for (usize i = 0; i < patterns->len; ++i) {
+        if (!isRegex[i]) continue;
+
+        char* pattern;
+        SL_Get(patterns, i, &pattern);
+        cap += strlen(pattern) + 6; // \( \) \|
+        count++;
+    }
+    if (count == 0) return RSE_Ok;
+
+    char* joined = malloc(cap);
+    if (joined == NULL) return RSE_AllocFailed;
+
+    char* p = joined;
+    for (usize i = 0; i < patterns->len; ++i) {
+        if (!isRegex[i]) continue;
+
+        char* pattern;
+        SL_Get(patterns, i, &pattern);
+        if (p != joined) p = stpcpy(p, "\\|");
+        p = stpcpy(stpcpy(stpcpy(p, "\\("), pattern), "\\)");
+    }
+
+    int res = regcomp(&self->combined, joined, REG_ICASE | REG_NOSUB);
+    free(joined);
+    if (res != 0) return RSE_InvalidRegex;
+
+    self->hasCombined = true;
+    return RSE_Ok;
+}
+
+RS_Error RS_Init(RegexSet* self, StringList* patterns) {
+    memset(self, 0, sizeof(*self));
+    self->len = patterns->len;
+    if (patterns->len == 0) return RSE_Ok;
+
+    self->literals = malloc(patterns->len * sizeof(RS_Literal));
+    self->separate = malloc(patterns->len * sizeof(regex_t));
+    bool* isRegex = calloc(patterns->len, sizeof(bool));
+    if (self->literals == NULL || self->separate == NULL || isRegex == NULL) {
+        free(isRegex);
+        RS_Destroy(self);
+        return RSE_AllocFailed;
+    }
+
+    RS_Error err = RSE_Ok;
+    for (usize i = 0; i < patterns->len; ++i) {
+        char* pattern;
+        SL_Get(patterns, i, &pattern);
+
+        // every pattern is compiled on its own first, so an invalid one is reported by name
+        regex_t re;
+        if (regcomp(&re, pattern, REG_ICASE | REG_NOSUB) != 0) {
+            self->invalidPattern = pattern;
+            err = RSE_InvalidRegex;
+            break;
+        }
+
+        if (RS_ParseLiteral(pattern, &self->literals[self->literalsCount])) {
+            self->literalsCount++;
+            regfree(&re);
+        } else if (RS_HasBackReference(pattern)) {
+            self->separate[self->separateCount++] = re;
+        } else {
+            isRegex[i] = true;
+            regfree(&re);
+        }
+    }
+
+    if (err == RSE_Ok && (err = RS_BuildCombined(self, patterns, isRegex)) == RSE_InvalidRegex) {
+        // should not happen with valid parts, but matching them one by one is always correct
+        err = RSE_Ok;
+        for (usize i = 0; i < patterns->len && err == RSE_Ok; ++i) {
+            if (!isRegex[i]) continue;
+
+            char* pattern;
+            SL_Get(patterns, i, &pattern);
+            if (regcomp(&self->separate[self->separateCount], pattern, REG_ICASE | REG_NOSUB) != 0) {
+                err = RSE_InvalidRegex;
+            } else {
+                self->separateCount++;
+            }
+        }
+    }
+
+    free(isRegex);
+    if (err != RSE_Ok) {
+        const char* invalid = self->invalidPattern;
+        RS_Destroy(self);
+        self->invalidPattern = invalid;
+    }
+    return err;
+}
+
+RS_Error RS_Destroy(RegexSet* self) {
+    for (usize i = 0; i < self->literalsCount; ++i) free(self->literals[i].text);
+    free(self->literals);
+
+    if (self->hasCombined) regfree(&self->combined);
+
+    for (usize i = 0; i < self->separateCount; ++i) regfree(&self->separate[i]);
+    free(self->separate);
+
+    memset(self, 0, sizeof(*self));
+    return RSE_Ok;
+}
+
+bool RS_Matches(const RegexSet* self, const char* str) {
+    if (self->len == 0) return false;
+
+    const usize len = strlen(str);
+    for (usize i = 0; i < self->literalsCount; ++i) {
+        if (RS_LiteralMatches(&self->literals[i], str, len)) return true;
+    }
+
+    if (self->hasCombined && regexec(&self->combined, str, 0, NULL, 0) == 0) return true;
+
+    for (usize i = 0; i < self->separateCount; ++i) {
+        if (regexec(&self->separate[i], str, 0, NULL, 0) == 0) return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,256 @@
+#include <ResultCache.h>
+
+#include <Definitions.h>
+#include <LocSettings.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int64_t RC_NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int RC_CompareId(uint64_t devA, uint64_t inoA, uint64_t devB, uint64_t inoB) {
+    if (devA != devB) return devA < devB ? -1 : 1;
+    if (inoA != inoB) return inoA < inoB ? -1 : 1;
+    return 0;
+}
+
+static int RC_CompareRecords(const void* a, const void* b) {
+    const RC_Record* ra = a;
+    const RC_Record* rb = b;
+    return RC_CompareId(ra->dev, ra->ino, rb->dev, rb->ino);
+}
+
+RC_Error RC_Init(ResultCache* self) {
+    memset(self, 0, sizeof(*self));
+    self->startedNs = RC_NowNs();
+    return RCE_Ok;
+}
+
+RC_Error RC_Destroy(ResultCache* self) {
+    if (self->map != NULL) munmap(self->map, self->mapSize);
+    free(self->fresh);
+    free(self->racy);
+    memset(self, 0, sizeof(*self));
+    return RCE_Ok;
+}
+
+static uint64_t RC_HashStr(uint64_t hash, const char* str) {
+    // FNV-1a, the terminating NUL included so that lists of strings hash unambiguously
+    if (str == NULL) str = "";
+    do {
+        hash ^= (unsigned char)*str;
+        hash *= 1099511628211ULL;
+    } while (*str++ != '\0');
+    return hash;
+}
+
+static uint64_t RC_HashStrs(uint64_t hash, const char** strs) {
+    for (; strs != NULL && *strs != NULL; ++strs) hash = RC_HashStr(hash, *strs);
+    return RC_HashStr(hash, NULL);
+}
+
+/// Hash of everything in the language table that changes how lines of a mode are counted.
+static uint64_t RC_LangHash() {
+    uint64_t hash = 14695981039346656037ULL;
+
+    const LocEntry* entries = GetLocEntries();
+    for (usize i = 0; i < GetLocEntriesCount(); ++i) {
+        const LocEntry* lang = &entries[i];
+        hash = RC_HashStr(hash, lang->langName);
+        hash = RC_HashStrs(hash, lang->stringDelims);
+        hash = RC_HashStrs(hash, lang->multilineStringDelims);
+        hash = RC_HashStrs(hash, lang->charDelims);
+        hash = RC_HashStrs(hash, lang->commentStarts);
+        hash = RC_HashStrs(hash, lang->ppDirectiveStarts);
+        for (const StringDelimPair* p = lang->multilineCommentDelimPairs; p != NULL && p->start != NULL; ++p) {
+            hash = RC_HashStr(RC_HashStr(hash, p->start), p->end);
+        }
+        hash = RC_HashStr(hash, lang->allowCommentContinues ? "c" : "");
+        hash = RC_HashStr(hash, lang->allowPPDirectiveContinues ? "p" : "");
+    }
+    return hash;
+}
+
+static bool RC_IsValid(const RC_Header* header, usize size) {
+    if (memcmp(header->magic, RC_MAGIC, sizeof(header->magic)) != 0) return false;
+    if (header->version != RC_VERSION || header->byteOrder != RC_BYTE_ORDER) return false;
+    if (header->recordSize != sizeof(RC_Record) || header->langCount != GetLocEntriesCount()) return false;
+    if (header->langHash != RC_LangHash()) return false;
+    return header->count == (size - sizeof(RC_Header)) / sizeof(RC_Record)
+        && (size - sizeof(RC_Header)) % sizeof(RC_Record) == 0;
+}
+
+RC_Error RC_Load(ResultCache* self, const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return RCE_Ok;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (usize)st.st_size < sizeof(RC_Header)) {
+        close(fd);
+        return RCE_Ok;
+    }
+
+    void* map = mmap(NULL, (usize)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return RCE_Ok;
+
+    const RC_Header* header = map;
+    if (!RC_IsValid(header, (usize)st.st_size)) {
+        munmap(map, (usize)st.st_size);
+        return RCE_Ok;
+    }
+
+    self->map = map;
+    self->mapSize = (usize)st.st_size;
+    self->records = (const RC_Record*)((const char*)map + sizeof(RC_Header));
+    self->count = header->count;
+    return RCE_Ok;
+}
+
+bool RC_Lookup(const ResultCache* self, const RC_Key* key, RC_Value* out) {
+    usize lo = 0, hi = self->count;
+    while (lo < hi) {
+        usize mid = lo + (hi - lo) / 2;
+        const RC_Record* rec = &self->records[mid];
+
+        int cmp = RC_CompareId(rec->dev, rec->ino, key->dev, key->ino);
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else if (cmp > 0) {
+            hi = mid;
+        } else {
+            if (rec->size != key->size || rec->mtimeNs != key->mtimeNs || rec->mode != key->mode) return false;
+
+            out->lines = rec->lines;
+            out->locStat = (LocStat) {
+                .emptyLines = rec->emptyLines,
+                .commentLines = rec->commentLines,
+                .codeLines = rec->codeLines,
+                .preprocessorLines = rec->preprocessorLines,
+                .totalLines = rec->lines,
+            };
+            return true;
+        }
+    }
+    return false;
+}
+
+static RC_Error RC_PushTo(RC_Record** records, usize* len, usize* cap, const RC_Record* record) {
+    if (*len == *cap) {
+        usize newCap = *cap > 0 ? *cap * 2 : 256;
+        RC_Record* grown = realloc(*records, newCap * sizeof(RC_Record));
+        if (grown == NULL) return RCE_AllocFailed;
+
+        *records = grown;
+        *cap = newCap;
+    }
+
+    (*records)[(*len)++] = *record;
+    return RCE_Ok;
+}
+
+static RC_Error RC_Push(ResultCache* self, const RC_Record* record) {
+    return RC_PushTo(&self->fresh, &self->freshLen, &self->freshCap, record);
+}
+
+RC_Error RC_Add(ResultCache* self, const RC_Key* key, const RC_Value* value) {
+    if (key->dev != RC_BLOB_DEV && key->mtimeNs >= self->startedNs - RC_RACY_NS) {
+        // not saved, but the loaded record of the file is not valid anymore either
+        return RC_PushTo(&self->racy, &self->racyLen, &self->racyCap, &(RC_Record) { .dev = key->dev, .ino = key->ino });
+    }
+
+    return RC_Push(self, &(RC_Record) {
+        .dev = key->dev,
+        .ino = key->ino,
+        .size = key->size,
+        .mtimeNs = key->mtimeNs,
+        .mode = key->mode,
+        .lines = value->lines,
+        .emptyLines = value->locStat.emptyLines,
+        .commentLines = value->locStat.commentLines,
+        .codeLines = value->locStat.codeLines,
+        .preprocessorLines = value->locStat.preprocessorLines,
+    });
+}
+
+RC_Error RC_Save(ResultCache* self, const char* path) {
+    qsort(self->fresh, self->freshLen, sizeof(RC_Record), RC_CompareRecords);
+
+    // the same file reached through several paths (hard links, repeated arguments)
+    usize count = 0;
+    for (usize i = 0; i < self->freshLen; ++i) {
+        if (count > 0 && RC_CompareRecords(&self->fresh[count - 1], &self->fresh[i]) == 0) continue;
+        self->fresh[count++] = self->fresh[i];
+    }
+    self->freshLen = count;
+
+    // blob records sort last, the ones of this run are found in the tail
+    usize blobsStart = count;
+    while (blobsStart > 0 && self->fresh[blobsStart - 1].dev == RC_BLOB_DEV) --blobsStart;
+
+    for (usize i = self->count; i > 0 && self->records[i - 1].dev == RC_BLOB_DEV && self->freshLen < 2 * count; --i) {
+        const RC_Record* old = &self->records[i - 1];
+        if (bsearch(old, self->fresh + blobsStart, count - blobsStart, sizeof(RC_Record), RC_CompareRecords)) continue;
+        if (RC_Push(self, old) != RCE_Ok) break;
+    }
+
+    // files this run did not visit keep their records, the visited ones were counted again
+    if (self->racyLen > 0) qsort(self->racy, self->racyLen, sizeof(RC_Record), RC_CompareRecords);
+    for (usize i = 0; i < self->count && self->records[i].dev != RC_BLOB_DEV && self->freshLen < RC_MAX_RECORDS; ++i) {
+        const RC_Record* old = &self->records[i];
+        if (blobsStart > 0 && bsearch(old, self->fresh, blobsStart, sizeof(RC_Record), RC_CompareRecords)) continue;
+        if (self->racyLen > 0 && bsearch(old, self->racy, self->racyLen, sizeof(RC_Record), RC_CompareRecords)) continue;
+        if (RC_Push(self, old) != RCE_Ok) break;
+    }
+
+    if (self->freshLen > count) {
+        count = self->freshLen;
+        qsort(self->fresh, count, sizeof(RC_Record), RC_CompareRecords);
+    }
+
+    RC_Header header = {
+        .version = RC_VERSION,
+        .byteOrder = RC_BYTE_ORDER,
+        .recordSize = sizeof(RC_Record),
+        .langCount = (uint32_t)GetLocEntriesCount(),
+        .langHash = RC_LangHash(),
+        .startedNs = self->startedNs,
+        .count = count,
+    };
+    memcpy(header.magic, RC_MAGIC, sizeof(header.magic));
+
+    usize tmpLen = strlen(path) + 32;
+    char* tmpPath = malloc(tmpLen);
+    if (tmpPath == NULL) return RCE_AllocFailed;
+    snprintf(tmpPath, tmpLen, "%s.%ld.tmp", path, (long)getpid());
+
+    FILE* fp = fopen(tmpPath, "wb");
+    if (fp == NULL) {
+        free(tmpPath);
+        return RCE_WriteError;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    if (ok && count > 0) ok = fwrite(self->fresh, sizeof(RC_Record), count, fp) == count;
+    if (fclose(fp) != 0) ok = false;
+
+    // readers keep their old mapping, the file is replaced at once
+    if (ok && rename(tmpPath, path) != 0) ok = false;
+    if (!ok) unlink(tmpPath);
+
+    free(tmpPath);
+    return ok ? RCE_Ok : RCE_WriteError;
+}
@@ -0,0 +1,80 @@
+#include <StringArena.h>
+
+#include <Definitions.h>
+
+#include <string.h>
+
+#include <sys/mman.h>
+
+SA_Error SA_Init(StringArena* self) {
+    self->head = NULL;
+    self->bytes = 0;
+    return SAE_Ok;
+}
+
+SA_Error SA_Destroy(StringArena* self) {
+    return SA_Clear(self);
+}
+
+SA_Error SA_Clear(StringArena* self) {
+    SA_Chunk* chunk = self->head;
+    while (chunk != NULL) {
+        SA_Chunk* next = chunk->next;
+        munmap(chunk, chunk->size);
+        chunk = next;
+    }
+
+    self->head = NULL;
+    self->bytes = 0;
+    return SAE_Ok;
+}
+
+static SA_Chunk* SA_MapChunk(usize size) {
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) return NULL;
+
+    SA_Chunk* chunk = map;
+    chunk->size = size;
+    chunk->used = sizeof(SA_Chunk);
+    return chunk;
+}
+
+SA_Error SA_DupN(StringArena* self, const char* str, usize len, char** out) {
+    const usize need = len + 1;
+
+    SA_Chunk* chunk = self->head;
+    if (chunk == NULL || chunk->size - chunk->used < need) {
+        if (need > SA_CHUNK_SIZE / 4) {
+            // a mapping of its own, kept behind the head so its free space is not wasted
+            chunk = SA_MapChunk(sizeof(SA_Chunk) + need);
+            if (chunk == NULL) return SAE_AllocFailed;
+
+            if (self->head != NULL) {
+                chunk->next = self->head->next;
+                self->head->next = chunk;
+            } else {
+                chunk->next = NULL;
+                self->head = chunk;
+            }
+        } else {
+            chunk = SA_MapChunk(SA_CHUNK_SIZE);
+            if (chunk == NULL) return SAE_AllocFailed;
+
+            chunk->next = self->head;
+            self->head = chunk;
+        }
+    }
+
+    char* dst = (char*)chunk + chunk->used;
+    memcpy(dst, str, len);
+    dst[len] = '\0';
+    chunk->used += need;
+    self->bytes += need;
+
+    *out = dst;
+    return SAE_Ok;
+}
+
+SA_Error SA_Dup(StringArena* self, const char* str, char** out) {
+    return SA_DupN(self, str, strlen(str), out);
+}
@@ -0,0 +1,276 @@
+#include <ThreadPool.h>
+
+#include <Definitions.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static _Thread_local isize currentWorker = -1;
+static _Thread_local ThreadPool* currentPool = NULL;
+
+static TP_Error TPD_Init(TP_Deque* self) {
+    const usize DEFAULT_INIT_CAP = 64;
+
+    self->data = malloc(DEFAULT_INIT_CAP * sizeof(TP_Task));
+    if (self->data == NULL) return TPE_AllocFailed;
+
+    self->head = 0;
+    self->len = 0;
+    self->cap = DEFAULT_INIT_CAP;
+
+    if (pthread_mutex_init(&self->lock, NULL) != 0) {
+        free(self->data);
+        self->data = NULL;
+        return TPE_ThreadError;
+    }
+    return TPE_Ok;
+}
+
+static void TPD_Destroy(TP_Deque* self) {
+    pthread_mutex_destroy(&self->lock);
+    free(self->data);
+    self->data = NULL;
+    self->len = 0;
+    self->cap = 0;
+}
+
+// expects self->lock to be held
+static TP_Error TPD_Grow(TP_Deque* self) {
+    usize newCap = self->cap * 2;
+    TP_Task* newData = malloc(newCap * sizeof(TP_Task));
+    if (newData == NULL) return TPE_AllocFailed;
+
+    for (usize i = 0; i < self->len; ++i) {
+        newData[i] = self->data[(self->head + i) % self->cap];
+    }
+
+    free(self->data);
+    self->data = newData;
+    self->head = 0;
+    self->cap = newCap;
+    return TPE_Ok;
+}
+
+static TP_Error TPD_PushBottom(TP_Deque* self, TP_Task task) {
+    pthread_mutex_lock(&self->lock);
+
+    if (self->len == self->cap) {
+        TP_Error err = TPD_Grow(self);
+        if (err != TPE_Ok) {
+            pthread_mutex_unlock(&self->lock);
+            return err;
+        }
+    }
+
+    self->data[(self->head + self->len) % self->cap] = task;
+    self->len++;
+
+    pthread_mutex_unlock(&self->lock);
+    return TPE_Ok;
+}
+
+static bool TPD_PopBottom(TP_Deque* self, TP_Task* out) {
+    pthread_mutex_lock(&self->lock);
+
+    bool found = self->len > 0;
+    if (found) {
+        self->len--;
+        *out = self->data[(self->head + self->len) % self->cap];
+    }
+
+    pthread_mutex_unlock(&self->lock);
+    return found;
+}
+
+static bool TPD_StealTop(TP_Deque* self, TP_Task* out) {
+    pthread_mutex_lock(&self->lock);
+
+    bool found = self->len > 0;
+    if (found) {
+        *out = self->data[self->head];
+        self->head = (self->head + 1) % self->cap;
+        self->len--;
+    }
+
+    pthread_mutex_unlock(&self->lock);
+    return found;
+}
+
+static bool TP_FindTask(ThreadPool* self, usize index, TP_Task* out) {
+    if (TPD_PopBottom(&self->deques[index], out)) goto found;
+
+    // nothing to do locally, try to steal starting from the next worker
+    for (usize i = 1; i < self->workersCount; ++i) {
+        usize victim = (index + i) % self->workersCount;
+        if (TPD_StealTop(&self->deques[victim], out)) goto found;
+    }
+
+    return false;
+
+found:
+    atomic_fetch_sub(&self->queued, 1);
+    return true;
+}
+
+static void TP_FinishTask(ThreadPool* self) {
+    if (atomic_fetch_sub(&self->pending, 1) == 1) {
+        pthread_mutex_lock(&self->lock);
+        pthread_cond_broadcast(&self->allDone);
+        pthread_mutex_unlock(&self->lock);
+    }
+}
+
+static void* TP_WorkerMain(void* arg) {
+    TP_Worker* worker = arg;
+    ThreadPool* self = worker->pool;
+
+    currentWorker = (isize)worker->index;
+    currentPool = self;
+
+    for (;;) {
+        TP_Task task;
+        if (TP_FindTask(self, worker->index, &task)) {
+            task.func(task.arg);
+            TP_FinishTask(self);
+            continue;
+        }
+
+        pthread_mutex_lock(&self->lock);
+        while (atomic_load(&self->queued) == 0 && !self->stopping) {
+            pthread_cond_wait(&self->workAvailable, &self->lock);
+        }
+        bool stop = self->stopping && atomic_load(&self->queued) == 0;
+        pthread_mutex_unlock(&self->lock);
+
+        if (stop) break;
+    }
+
+    return NULL;
+}
+
+usize TP_DefaultWorkersCount() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (usize)n : 1;
+}
+
+isize TP_CurrentWorker() {
+    return currentWorker;
+}
+
+TP_Error TP_Init(ThreadPool* self, usize workersCount) {
+    memset(self, 0, sizeof(ThreadPool));
+    if (workersCount == 0) return TPE_InvalidArgument;
+
+    self->workers = calloc(workersCount, sizeof(TP_Worker));
+    self->deques = calloc(workersCount, sizeof(TP_Deque));
+    if (self->workers == NULL || self->deques == NULL) {
+        free(self->workers);
+        free(self->deques);
+        memset(self, 0, sizeof(ThreadPool));
+        return TPE_AllocFailed;
+    }
+
+    atomic_init(&self->queued, 0);
+    atomic_init(&self->pending, 0);
+    atomic_init(&self->nextDeque, 0);
+    pthread_mutex_init(&self->lock, NULL);
+    pthread_cond_init(&self->workAvailable, NULL);
+    pthread_cond_init(&self->allDone, NULL);
+
+    for (usize i = 0; i < workersCount; ++i) {
+        TP_Error err = TPD_Init(&self->deques[i]);
+        if (err != TPE_Ok) {
+            TP_Destroy(self);
+            return err;
+        }
+        self->workersCount++;
+    }
+
+    for (usize i = 0; i < workersCount; ++i) {
+        self->workers[i] = (TP_Worker) { .pool = self, .index = i };
+        if (pthread_create(&self->workers[i].thread, NULL, TP_WorkerMain, &self->workers[i]) != 0) {
+            // only the first `i` workers are running, make TP_Destroy join just them
+            usize started = i;
+            pthread_mutex_lock(&self->lock);
+            self->stopping = true;
+            pthread_cond_broadcast(&self->workAvailable);
+            pthread_mutex_unlock(&self->lock);
+            for (usize j = 0; j < started; ++j) pthread_join(self->workers[j].thread, NULL);
+
+            for (usize j = 0; j < self->workersCount; ++j) TPD_Destroy(&self->deques[j]);
+            free(self->workers);
+            free(self->deques);
+            memset(self, 0, sizeof(ThreadPool));
+            return TPE_ThreadError;
+        }
+    }
+
+    return TPE_Ok;
+}
+
+TP_Error TP_Destroy(ThreadPool* self) {
+    if (self->workers == NULL) return TPE_Ok;
+
+    pthread_mutex_lock(&self->lock);
+    self->stopping = true;
+    pthread_cond_broadcast(&self->workAvailable);
+    pthread_mutex_unlock(&self->lock);
+
+    for (usize i = 0; i < self->workersCount; ++i) {
+        if (self->workers[i].pool != NULL) pthread_join(self->workers[i].thread, NULL);
+    }
+    for (usize i = 0; i < self->workersCount; ++i) {
+        TPD_Destroy(&self->deques[i]);
+    }
+
+    pthread_cond_destroy(&self->allDone);
+    pthread_cond_destroy(&self->workAvailable);
+    pthread_mutex_destroy(&self->lock);
+
+    free(self->workers);
+    free(self->deques);
+    memset(self, 0, sizeof(ThreadPool));
+    return TPE_Ok;
+}
+
+TP_Error TP_Submit(ThreadPool* self, TP_TaskFunc* func, void* arg) {
+    if (self->workersCount == 0 || func == NULL) return TPE_InvalidArgument;
+
+    usize index;
+    if (currentPool == self) {
+        index = (usize)currentWorker;
+    } else {
+        index = atomic_fetch_add(&self->nextDeque, 1) % self->workersCount;
+    }
+
+    // counted before the task is published, a thief may pop it right away
+    atomic_fetch_add(&self->pending, 1);
+    atomic_fetch_add(&self->queued, 1);
+
+    TP_Error err = TPD_PushBottom(&self->deques[index], (TP_Task) { func, arg });
+    if (err != TPE_Ok) {
+        atomic_fetch_sub(&self->queued, 1);
+        TP_FinishTask(self);
+        return err;
+    }
+
+    pthread_mutex_lock(&self->lock);
+    pthread_cond_signal(&self->workAvailable);
+    pthread_mutex_unlock(&self->lock);
+    return TPE_Ok;
+}
+
+TP_Error TP_Wait(ThreadPool* self) {
+    if (self->workersCount == 0) return TPE_Ok;
+
+    pthread_mutex_lock(&self->lock);
+    while (atomic_load(&self->pending) > 0) {
+        pthread_cond_wait(&self->allDone, &self->lock);
+    }
+    pthread_mutex_unlock(&self->lock);
+    return TPE_Ok;
+}
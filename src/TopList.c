@@ -0,0 +1,213 @@
+#include <TopList.h>
+
+#include <Definitions.h>
+#include <Utils.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+TL_Error TL_Init(TopList* self, usize limit, CFG_SortMode mode, bool reverse) {
+    memset(self, 0, sizeof(TopList));
+    self->limit = limit < LCL_MAX_LEN ? limit : LCL_MAX_LEN;
+    self->mode = mode;
+    self->reverse = reverse;
+    self->compactAt = SA_CHUNK_SIZE;
+
+    LCL_Init(&self->list);
+    return TLE_Ok;
+}
+
+TL_Error TL_Destroy(TopList* self) {
+    LCL_Destroy(&self->list);
+    free(self->heap);
+    free(self->offeredAt);
+    memset(self, 0, sizeof(TopList));
+    return TLE_Ok;
+}
+
+static const char* TL_Name(const char* path) {
+    const char* name = strrchr(path, '/');
+    return name ? name + 1 : path;
+}
+
+static const char* TL_Extension(const char* path) {
+    const char* ext = GetExtension(path);
+    return ext ? ext : "";
+}
+
+static inline int TL_CompareInts(long long a, long long b) {
+    return (a > b) - (a < b);
+}
+
+/// Compares two counters the way LCL_SortBy orders them, < 0 when a comes first.
+static int TL_Compare(const TopList* self, const LineCounter* a, uint64_t aAt, const LineCounter* b, uint64_t bAt) {
+    int cmp = 0;
+    switch (self->mode) {
+    case SM_Lines:
+        cmp = (a->lines > b->lines) - (a->lines < b->lines);
+        break;
+    case SM_Size:
+        cmp = TL_CompareInts(a->meta.size, b->meta.size);
+        break;
+    case SM_MTime:
+        cmp = TL_CompareInts(a->meta.mtime, b->meta.mtime);
+        break;
+    case SM_Path:
+        cmp = strcmp(a->meta.fullPath, b->meta.fullPath);
+        break;
+    case SM_Name:
+        cmp = strcmp(TL_Name(a->meta.fullPath), TL_Name(b->meta.fullPath));
+        if (cmp == 0) cmp = (a->lines > b->lines) - (a->lines < b->lines);
+        break;
+    case SM_Ext:
+        cmp = strcmp(TL_Extension(a->meta.fullPath), TL_Extension(b->meta.fullPath));
+        break;
+    default:
+        // unsorted, reverse makes the last counters the first ones
+        cmp = (aAt > bAt) - (aAt < bAt);
+        return self->reverse ? -cmp : cmp;
+    }
+
+    if (cmp != 0) return self->reverse ? -cmp : cmp;
+    return (aAt > bAt) - (aAt < bAt);
+}
+
+static int TL_CompareRows(const TopList* self, uint32_t a, uint32_t b) {
+    LineCounter ca, cb;
+    LCL_Get(&self->list, a, &ca);
+    LCL_Get(&self->list, b, &cb);
+    return TL_Compare(self, &ca, self->offeredAt[a], &cb, self->offeredAt[b]);
+}
+
+static void TL_SiftUp(TopList* self, usize i) {
+    while (i > 0) {
+        usize parent = (i - 1) / 2;
+        if (TL_CompareRows(self, self->heap[parent], self->heap[i]) >= 0) break;
+
+        uint32_t tmp = self->heap[parent];
+        self->heap[parent] = self->heap[i];
+        self->heap[i] = tmp;
+        i = parent;
+    }
+}
+
+static void TL_SiftDown(TopList* self, usize i) {
+    const usize len = self->list.len;
+    for (;;) {
+        usize last = i;
+        usize left = 2 * i + 1;
+        usize right = left + 1;
+        if (left < len && TL_CompareRows(self, self->heap[left], self->heap[last]) > 0) last = left;
+        if (right < len && TL_CompareRows(self, self->heap[right], self->heap[last]) > 0) last = right;
+        if (last == i) break;
+
+        uint32_t tmp = self->heap[last];
+        self->heap[last] = self->heap[i];
+        self->heap[i] = tmp;
+        i = last;
+    }
+}
+
+static TL_Error TL_Reserve(TopList* self, usize minCap) {
+    if (minCap <= self->cap) return TLE_Ok;
+
+    usize newCap = self->cap > 0 ? self->cap * 2 : 16;
+    if (newCap < minCap) newCap = minCap;
+    if (newCap > self->limit) newCap = self->limit;
+
+    uint32_t* heap = realloc(self->heap, newCap * sizeof(uint32_t));
+    if (heap == NULL) return TLE_AllocFailed;
+    self->heap = heap;
+
+    uint64_t* offeredAt = realloc(self->offeredAt, newCap * sizeof(uint64_t));
+    if (offeredAt == NULL) return TLE_AllocFailed;
+    self->offeredAt = offeredAt;
+
+    self->cap = newCap;
+    return TLE_Ok;
+}
+
+/// Copies the kept counters into a fresh arena, so the paths of dropped ones don't pile up.
+static TL_Error TL_Compact(TopList* self) {
+    LineCounterList compacted;
+    if (LCL_Copy(&compacted, &self->list) != LCLE_Ok) {
+        LCL_Destroy(&compacted);
+        return TLE_AllocFailed;
+    }
+
+    LCL_Destroy(&self->list);
+    LCL_Move(&self->list, &compacted);
+
+    self->compactAt = self->list.strings.bytes * 2;
+    if (self->compactAt < SA_CHUNK_SIZE) self->compactAt = SA_CHUNK_SIZE;
+    return TLE_Ok;
+}
+
+TL_Error TL_Offer(TopList* self, const char* name, usize lines, FileMeta* meta, LocStat locStat, bool hasLocStat) {
+    if (self->limit == 0) return TLE_Ok;
+    const uint64_t at = self->offered++;
+
+    if (self->list.len < self->limit) {
+        if (TL_Reserve(self, self->list.len + 1) != TLE_Ok) return TLE_AllocFailed;
+        if (LCL_Append(&self->list, name, lines, meta, locStat, hasLocStat) != LCLE_Ok) return TLE_AllocFailed;
+
+        uint32_t row = (uint32_t)(self->list.len - 1);
+        self->heap[row] = row;
+        self->offeredAt[row] = at;
+        TL_SiftUp(self, row);
+        return TLE_Ok;
+    }
+
+    LineCounter offered = {
+        .toPrint = (char*)name,
+        .lines = lines,
+        .meta = *meta,
+        .hasLocStat = hasLocStat,
+        .locStat = locStat,
+    };
+    uint32_t root = self->heap[0];
+    LineCounter last;
+    LCL_Get(&self->list, root, &last);
+    if (TL_Compare(self, &offered, at, &last, self->offeredAt[root]) >= 0) return TLE_Ok;
+
+    // the offered counter takes the row of the last one
+    if (LCL_Set(&self->list, root, name, lines, meta, locStat, hasLocStat) != LCLE_Ok) return TLE_AllocFailed;
+    self->offeredAt[root] = at;
+    TL_SiftDown(self, 0);
+
+    if (self->list.strings.bytes >= self->compactAt) return TL_Compact(self);
+    return TLE_Ok;
+}
+
+typedef struct TL_Offered {
+    uint64_t at;
+    uint32_t row;
+} TL_Offered;
+
+static int TL_CompareOffered(const void* a, const void* b) {
+    const TL_Offered* oa = a;
+    const TL_Offered* ob = b;
+    return (oa->at > ob->at) - (oa->at < ob->at);
+}
+
+TL_Error TL_MoveTo(TopList* self, LineCounterList* dst) {
+    const usize len = self->list.len;
+
+    TL_Offered* rows = malloc((len > 0 ? len : 1) * sizeof(TL_Offered));
+    if (rows == NULL) return TLE_AllocFailed;
+    for (usize row = 0; row < len; ++row) rows[row] = (TL_Offered) { .at = self->offeredAt[row], .row = (uint32_t)row };
+    qsort(rows, len, sizeof(TL_Offered), TL_CompareOffered);
+
+    TL_Error err = TLE_Ok;
+    for (usize i = 0; i < len && err == TLE_Ok; ++i) {
+        LineCounter c;
+        LCL_Get(&self->list, rows[i].row, &c);
+        if (LCL_Append(dst, c.toPrint, c.lines, &c.meta, c.locStat, c.hasLocStat) != LCLE_Ok) err = TLE_AllocFailed;
+    }
+    free(rows);
+
+    LCL_Clear(&self->list);
+    self->offered = 0;
+    self->compactAt = SA_CHUNK_SIZE;
+    return err;
+}
@@ -0,0 +1,311 @@
+#include <UringReader.h>
+
+#include <Definitions.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#    if __has_include(<linux/io_uring.h>)
+#        define UR_HAS_IO_URING
+#    endif
+#endif
+
+#ifdef UR_HAS_IO_URING
+
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+
+/// Every file is a chain of three requests, user_data tells which one completed.
+typedef enum UR_Op {
+    URO_Open = 0,
+    URO_Read,
+    URO_Close,
+} UR_Op;
+
+#    define UR_USER_DATA(slot, op) (((uint64_t)(slot) << 2) | (op))
+
+typedef struct UR_Slot {
+    usize file;
+    int openRes;
+    int readRes;
+    unsigned pending; ///< completions still missing for the chain
+} UR_Slot;
+
+static int UR_Setup(unsigned entries, struct io_uring_params* params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int UR_Enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+static int UR_Register(int fd, unsigned opcode, void* arg, unsigned nrArgs) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+
+static UR_Error UR_InitRing(UringReader* self) {
+    *self = (UringReader) { .ringFd = -1 };
+
+    struct io_uring_params params = {0};
+    self->ringFd = UR_Setup(UR_QUEUE_DEPTH * 3, &params);
+    if (self->ringFd < 0) {
+        self->ringFd = -1;
+        return URE_SetupFailed;
+    }
+    self->entries = params.sq_entries;
+
+    self->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    self->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (self->cqRingSize > self->sqRingSize) self->sqRingSize = self->cqRingSize;
+        self->cqRingSize = self->sqRingSize;
+    }
+
+    self->sqRing = mmap(NULL, self->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->ringFd, IORING_OFF_SQ_RING);
+    if (self->sqRing == MAP_FAILED) goto fail;
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        self->cqRing = self->sqRing;
+    } else {
+        self->cqRing = mmap(NULL, self->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->ringFd, IORING_OFF_CQ_RING);
+        if (self->cqRing == MAP_FAILED) goto fail;
+    }
+
+    self->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    self->sqes = mmap(NULL, self->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->ringFd, IORING_OFF_SQES);
+    if (self->sqes == MAP_FAILED) goto fail;
+
+    char* sq = self->sqRing;
+    self->sqHead = (unsigned*)(sq + params.sq_off.head);
+    self->sqTail = (unsigned*)(sq + params.sq_off.tail);
+    self->sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    self->sqArray = (unsigned*)(sq + params.sq_off.array);
+
+    char* cq = self->cqRing;
+    self->cqHead = (unsigned*)(cq + params.cq_off.head);
+    self->cqTail = (unsigned*)(cq + params.cq_off.tail);
+    self->cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    self->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    // a sparse table of direct descriptors, one per slot
+    int fds[UR_QUEUE_DEPTH];
+    for (usize i = 0; i < UR_QUEUE_DEPTH; ++i) fds[i] = -1;
+    if (UR_Register(self->ringFd, IORING_REGISTER_FILES, fds, UR_QUEUE_DEPTH) != 0) goto fail;
+
+    self->slots = malloc((usize)UR_QUEUE_DEPTH * UR_SLOT_SIZE);
+    if (self->slots == NULL) goto fail;
+
+    return URE_Ok;
+
+fail:
+    if (self->sqes == MAP_FAILED) self->sqes = NULL;
+    if (self->cqRing == MAP_FAILED) self->cqRing = NULL;
+    if (self->sqRing == MAP_FAILED) self->sqRing = NULL;
+    UR_Destroy(self);
+    return URE_SetupFailed;
+}
+
+UR_Error UR_Init(UringReader* self) {
+    if (!UR_IsSupported()) {
+        *self = (UringReader) { .ringFd = -1 };
+        return URE_Unsupported;
+    }
+    return UR_InitRing(self);
+}
+
+UR_Error UR_Destroy(UringReader* self) {
+    if (self->sqes != NULL) munmap(self->sqes, self->sqesSize);
+    if (self->cqRing != NULL && self->cqRing != self->sqRing) munmap(self->cqRing, self->cqRingSize);
+    if (self->sqRing != NULL) munmap(self->sqRing, self->sqRingSize);
+    if (self->ringFd != -1) close(self->ringFd);
+
+    // after the ring is closed, so the kernel is done with the slots
+    free(self->slots);
+
+    *self = (UringReader) { .ringFd = -1 };
+    return URE_Ok;
+}
+
+static struct io_uring_sqe* UR_GetSqe(UringReader* self) {
+    unsigned tail = *self->sqTail;
+    unsigned index = tail & self->sqMask;
+
+    struct io_uring_sqe* sqe = &self->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    self->sqArray[index] = index;
+
+    // published by UR_Flush
+    *self->sqTail = tail + 1;
+    return sqe;
+}
+
+static void UR_QueueFile(UringReader* self, const UR_File* file, usize slot) {
+    // the read is short for every file smaller than the slot, which breaks a normal link,
+    // so the close is hard linked to run anyway
+    struct io_uring_sqe* open = UR_GetSqe(self);
+    open->opcode = IORING_OP_OPENAT;
+    open->fd = file->dirFd;
+    open->addr = (uint64_t)(uintptr_t)file->path;
+    open->open_flags = O_RDONLY; // O_CLOEXEC is not allowed (nor needed) for direct descriptors
+    open->file_index = (uint32_t)slot + 1;
+    open->flags = IOSQE_IO_LINK;
+    open->user_data = UR_USER_DATA(slot, URO_Open);
+
+    struct io_uring_sqe* read = UR_GetSqe(self);
+    read->opcode = IORING_OP_READ;
+    read->fd = (int)slot;
+    read->addr = (uint64_t)(uintptr_t)(self->slots + slot * UR_SLOT_SIZE);
+    read->len = UR_SLOT_SIZE;
+    read->off = 0;
+    read->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+    read->user_data = UR_USER_DATA(slot, URO_Read);
+
+    struct io_uring_sqe* close = UR_GetSqe(self);
+    close->opcode = IORING_OP_CLOSE;
+    close->file_index = (uint32_t)slot + 1;
+    close->user_data = UR_USER_DATA(slot, URO_Close);
+}
+
+UR_Error UR_ReadFiles(UringReader* self, const UR_File* files, usize count, UR_Callback* cb, void* ctx) {
+    if (self->ringFd == -1 || self->broken) return URE_Unsupported;
+
+    UR_Slot slots[UR_QUEUE_DEPTH];
+    usize freeSlots[UR_QUEUE_DEPTH];
+    usize freeCount = UR_QUEUE_DEPTH;
+    for (usize i = 0; i < UR_QUEUE_DEPTH; ++i) freeSlots[i] = UR_QUEUE_DEPTH - 1 - i;
+
+    usize next = 0;
+    usize done = 0;
+    unsigned toSubmit = 0;
+    while (done < count) {
+        while (next < count && freeCount > 0) {
+            usize slot = freeSlots[--freeCount];
+            slots[slot] = (UR_Slot) { .file = next, .pending = 3 };
+            UR_QueueFile(self, &files[next++], slot);
+            toSubmit += 3;
+        }
+
+        // publish the new tail before the kernel looks at it
+        __atomic_store_n(self->sqTail, *self->sqTail, __ATOMIC_RELEASE);
+
+        int res = UR_Enter(self->ringFd, toSubmit, 1, IORING_ENTER_GETEVENTS);
+        if (res < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            self->broken = true;
+            return URE_SubmitFailed;
+        }
+        toSubmit -= (unsigned)res;
+
+        unsigned head = *self->cqHead;
+        unsigned tail = __atomic_load_n(self->cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const struct io_uring_cqe* cqe = &self->cqes[head & self->cqMask];
+            UR_Slot* slot = &slots[cqe->user_data >> 2];
+
+            switch ((UR_Op)(cqe->user_data & 3)) {
+            case URO_Open:
+                slot->openRes = cqe->res;
+                break;
+            case URO_Read:
+                slot->readRes = cqe->res;
+                break;
+            case URO_Close:
+                break;
+            }
+
+            if (--slot->pending > 0) continue;
+
+            usize index = (usize)(slot - slots);
+            UR_Result result = { .data = self->slots + index * UR_SLOT_SIZE };
+            if (slot->openRes < 0) {
+                result.err = -slot->openRes;
+            } else if (slot->readRes < 0) {
+                result.err = -slot->readRes;
+            } else {
+                result.len = (usize)slot->readRes;
+                result.truncated = result.len == UR_SLOT_SIZE;
+            }
+            cb(ctx, slot->file, &result);
+
+            freeSlots[freeCount++] = index;
+            done++;
+        }
+        __atomic_store_n(self->cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    return URE_Ok;
+}
+
+static bool supported = false;
+static pthread_once_t supportedOnce = PTHREAD_ONCE_INIT;
+
+static void UR_ProbeCallback(void* ctx, usize index, const UR_Result* result) {
+    (void)index;
+    // the root directory opens fine everywhere, reading it fails with EISDIR
+    *(bool*)ctx = result->err != EINVAL && result->err != EBADF;
+}
+
+static void UR_Probe() {
+    struct io_uring_params params = {0};
+    int fd = UR_Setup(4, &params);
+    if (fd < 0) return; // ENOSYS, or blocked by seccomp
+
+    const usize probeSize = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe* probe = calloc(1, probeSize);
+    bool hasOps = probe != NULL && UR_Register(fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+    if (hasOps) {
+        const unsigned ops[] = { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE };
+        for (usize i = 0; i < sizeof(ops) / sizeof(ops[0]); ++i) {
+            hasOps = hasOps && ops[i] <= probe->last_op && (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED);
+        }
+    }
+    free(probe);
+    close(fd);
+    if (!hasOps) return;
+
+    // direct descriptors (5.15) can only be seen by using them
+    UringReader reader;
+    bool works = false;
+    if (UR_InitRing(&reader) == URE_Ok) {
+        UR_File root = { .dirFd = AT_FDCWD, .path = "/" };
+        if (UR_ReadFiles(&reader, &root, 1, UR_ProbeCallback, &works) != URE_Ok) works = false;
+        UR_Destroy(&reader);
+    }
+    supported = works;
+}
+
+bool UR_IsSupported() {
+    pthread_once(&supportedOnce, UR_Probe);
+    return supported;
+}
+
+#else // !UR_HAS_IO_URING
+
+UR_Error UR_Init(UringReader* self) {
+    memset(self, 0, sizeof(*self));
+    self->ringFd = -1;
+    return URE_Unsupported;
+}
+
+UR_Error UR_Destroy(UringReader* self) {
+    return URE_Ok;
+}
+
+UR_Error UR_ReadFiles(UringReader* self, const UR_File* files, usize count, UR_Callback* cb, void* ctx) {
+    return URE_Unsupported;
+}
+
+bool UR_IsSupported() {
+    return false;
+}
+
+#endif
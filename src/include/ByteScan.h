@@ -0,0 +1,27 @@
+#ifndef BYTE_SCAN_H
+#define BYTE_SCAN_H
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+
+typedef enum BS_Kernel {
+    BSK_Scalar = 0, ///< byte by byte, reference implementation
+    BSK_SSE2,
+    BSK_AVX2,
+    BSK_NEON,
+
+    BSK_Count,
+} BS_Kernel;
+
+typedef usize BS_FindFunc(const char* buf, usize len, char a, char b);
+
+/// Returns the offset of the first byte equal to a or b, len if there is none.
+usize BS_FindAny2(const char* buf, usize len, char a, char b);
+
+usize BS_FindAny2With(BS_Kernel kernel, const char* buf, usize len, char a, char b);
+bool BS_IsSupported(BS_Kernel kernel);
+BS_Kernel BS_BestKernel();
+const char* BS_KernelName(BS_Kernel kernel);
+
+#endif // BYTE_SCAN_H
@@ -3,15 +3,24 @@
 
 #include <Config.h>
 #include <Definitions.h>
+#include <ExtensionSet.h>
 #include <Utils.h>
 
 #include <HelpPrinter.h>
+#include <IgnoreRules.h>
 #include <INodeSet.h>
 #include <LineCounterList.h>
 #include <LocParser.h>
 #include <LocSettings.h>
+#include <PathTrie.h>
+#include <RegexSet.h>
+#include <ResultCache.h>
+#include <ThreadPool.h>
+#include <TopList.h>
+#include <UringReader.h>
 
-#include <regex.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 typedef enum CL_Error {
     CLE_Ok,
@@ -28,11 +37,108 @@ typedef enum CL_Error {
     CLE_ListError,
     CLE_SetError,
     CLE_LocError,
+    CLE_PoolError,
+    CLE_NotAGitRepo,
+    CLE_GitIndexError,
+    CLE_WatchError,
 
     CLE_Todo,
     CLE_InternalError,
 } CL_Error;
 
+/// An open directory shared by the tasks of its entries in parallel mode, so they can be opened with openat.
+typedef struct CL_DirHandle {
+    int fd;
+    atomic_size_t refs; ///< the scanning task, pending file jobs and subdirectories not opened yet
+    struct CLines* app;
+} CL_DirHandle;
+
+/// A single file counted by a worker of the pool (see --jobs).
+typedef struct CL_FileJob {
+    usize index; ///< index of the placeholder entry in CLinesApp.files
+    const char* path;
+    const char* name;
+    const Config* cfg;
+    CL_DirHandle* dir; ///< the file is opened relative to it, NULL to use path
+    struct CL_DirNode* node; ///< told when the job is done, NULL outside of CL_CountParallel
+
+    usize lines;
+    bool hasLocStat;
+    LocStat locStat;
+    const LocEntry* lang; ///< the language of locStat, NULL without one
+
+    CL_Error err;
+    LP_Error lperr;
+    bool counted; ///< already counted from a batch read through io_uring
+} CL_FileJob;
+
+/// A directory entry that passed the filters of CL_ShouldIncludePath.
+typedef struct CL_DirEntry {
+    char* path;       ///< formatted path (malloc'ed)
+    const char* name; ///< points into path
+    char* resolved;   ///< resolved path (malloc'ed), only for directories
+    bool isDir;
+    bool skipped;     ///< directory claimed by another task, so not scanned here (parallel mode)
+
+    INode inode;
+    FileMeta meta;
+    const uint8_t* blobId; ///< git object id of the content when the index says it is unchanged, only with --git
+
+    struct CL_DirNode* child; ///< only for directories in parallel mode
+    CL_FileJob job;           ///< only for files in parallel mode
+} CL_DirEntry;
+
+/**
+ * A directory scanned by a worker of the pool. Nodes form a tree which is merged in readdir order
+ * while it is being scanned, every node is freed as soon as it is merged.
+ */
+typedef struct CL_DirNode {
+    struct CLines* app;
+    const char* path; ///< owned by the parent entry (or the caller for the root)
+    const char* name; ///< points into path
+    const char* resolved; ///< resolved path, owned like path
+    CL_DirHandle* parent; ///< the directory is opened relative to it, NULL to use path
+    usize depth;
+
+    const IgnoreRules* ignore; ///< rules of the nearest parent that has some (see --ignore-files)
+    IgnoreRules* ownIgnore;    ///< rules of the ignore files of this directory
+
+    CL_DirEntry* entries;
+    usize len;
+
+    usize fileCount;
+    CL_Error err;
+
+    atomic_size_t pending; ///< the scan and the file jobs that are not done yet
+    bool submitted;        ///< false while it waits for the merge (see CLinesApp.pendingEntriesBudget)
+    bool done;             ///< pending reached 0, guarded by CLinesApp.nodesLock
+} CL_DirNode;
+
+/// A directory of the counted tree watched for changes (see --watch).
+typedef struct CL_WatchedDir {
+    char* path; ///< formatted path, its entries are path/name
+    char* resolved;
+    usize depth;
+    INode inode;
+    int wd; ///< -1 when it could not be watched
+
+    const IgnoreRules* ignore; ///< rules in effect for its entries
+    IgnoreRules* ownIgnore;    ///< taken over from the traversal
+} CL_WatchedDir;
+
+/// The io_uring of a thread (see --io-uring), set up on its first use.
+typedef struct CL_Ring {
+    UringReader reader;
+    bool initialized;
+    bool usable;
+} CL_Ring;
+
+/// Totals of the files of a language (see --loc-summary).
+typedef struct CL_LangSummary {
+    usize files;
+    LocStat stat;
+} CL_LangSummary;
+
 typedef struct CLines {
     Config cfg;
     HelpPrinter helpPrinter;
@@ -41,17 +147,40 @@ typedef struct CLines {
     usize fileCount;
     usize dirCount;
 
-    INodeSet seen;
-    LineCounterList files;
+    INodeSharedSet seen;
+    INodeSharedSet scanned; ///< directories claimed by a task of CL_CountParallel, each is scanned once
+    LineCounterList files; ///< stays empty when streaming
+    bool streaming;        ///< files are printed as soon as they are counted (see CL_CanStream)
+    TopList top;           ///< with --top, counted files are kept here and only the first ones reach files
+    bool keepingTop;       ///< see CL_CanKeepTop
+    bool summaryOnly;      ///< no file is printed on its own, so none is kept (see CL_IsSummaryOnly), with --jobs entries are freed once merged
+
+    CL_LangSummary* langSummary; ///< by GetLocEntries() index, NULL without --loc-summary
+
+    ExtensionSet includedExtensions;
+    ExtensionSet excludedExtensions;
 
-    regex_t* includedRegexes;
-    usize includedRegexesCount;
+    RegexSet includedRegexes;
+    RegexSet excludedRegexes;
 
-    regex_t* excludedRegexes;
-    usize excludedRegexesCount;
+    PathTrie excludedPaths; ///< resolved --exclude paths
 
-    char** excludedPaths;
-    usize excludedPathsCount;
+    struct CL_WatchState* watch; ///< NULL without --watch, see Watch.c
+
+    ResultCache cache;
+    bool cacheEnabled; ///< loaded, see --cache
+
+    ThreadPool pool;
+    CL_Ring* rings; ///< one per worker and the last one for the calling thread, NULL without --io-uring
+    usize ringsCount;
+
+    atomic_size_t openDirs; ///< directories kept open for openat/fstatat of their entries
+    usize openDirsBudget;   ///< past this, directories are closed after scanning (see RLIMIT_NOFILE)
+
+    atomic_size_t pendingEntries; ///< entries scanned by CL_CountParallel and not merged yet
+    usize pendingEntriesBudget;   ///< past this, subdirectories are only scanned once the merge gets to them
+    pthread_mutex_t nodesLock;
+    pthread_cond_t nodeDone; ///< a CL_DirNode is done
 
     char* currentPath;
     char* errorDetails;
@@ -66,24 +195,52 @@ CL_Error CL_SetErrorDetailsf(CLinesApp* self, const char* fmt, ...) ATTR_FORMAT(
 CL_Error CL_MapAndExceptCFG(CLinesApp* self, CFG_Error cerr);
 CL_Error CL_MapAndExceptLCL(CLinesApp* self, LCL_Error lcerr);
 CL_Error CL_MapAndExceptINS(CLinesApp* self, INS_Error inerr);
+CL_Error CL_MapAndExceptTP(CLinesApp* self, TP_Error tperr);
 CL_Error CL_MapAndExceptCL(CLinesApp* self, CL_Error err);
 CL_Error MapAndExceptLP(CLinesApp* self, LP_Error lperr);
 
 bool CL_ShouldIncludePath(CLinesApp* self, const char* resolvedPath, const char* name, bool isDir);
 CL_Error CL_HandleFile(
     CLinesApp* self, const char* formattedPath, const char* resolvedPath, const char* name, FileMeta* meta);
+CL_Error CL_AddFile(CLinesApp* self, const char* formattedPath, const char* name, FileMeta* meta);
 CL_Error CL_HandleFileWithLoc(
     CLinesApp* self, const char* formattedPath, const char* resolvedPath, const char* name, FileMeta* meta);
+CL_Error CL_ScanDir(CLinesApp* self, int dirFd, const char* path, const char* dirResolved, const IgnoreRules* ignore,
+    CL_DirEntry** outEntries, usize* outLen);
+CL_Error CL_CountDir(CLinesApp* self, int parentFd, const char* path, const char* name, const char* resolved,
+    const IgnoreRules* parentIgnore, usize depth);
+CL_Error CL_CountEntry(CLinesApp* self, CL_DirEntry* entry);
 CL_Error CL_CountRecursive(CLinesApp* self, const char* path, usize depth);
+CL_Error CL_CountParallel(CLinesApp* self, const char* path);
+CL_Error CL_CountGit(CLinesApp* self, const char* path);
+CL_Error CL_Count(CLinesApp* self, const char* path);
 CL_Error CL_ResetCounter(CLinesApp* self);
 
 bool CL_IsExcluded(CLinesApp* self, const char* resolvedPath);
 CL_Error CL_LoadIncludedRegexes(CLinesApp* self);
 CL_Error CL_LoadExcludedRegexes(CLinesApp* self);
+CL_Error CL_LoadExtensions(CLinesApp* self);
 CL_Error CL_LoadExcludedPaths(CLinesApp* self);
 CL_Error CL_LoadConfig(CLinesApp* self, int argc, char** argv);
-
+CL_Error CL_StartWorkers(CLinesApp* self);
+CL_Error CL_LoadCache(CLinesApp* self);
+CL_Error CL_SaveCache(CLinesApp* self);
+
+CL_Error CL_StartWatch(CLinesApp* self);
+CL_Error CL_WatchDir(CLinesApp* self, int dirFd, const char* path, const char* resolved, usize depth,
+    const IgnoreRules* ignore, IgnoreRules** ownIgnore);
+CL_Error CL_Watch(CLinesApp* self, const char* path);
+void CL_StopWatch(CLinesApp* self);
+
+bool CL_CanStream(const CLinesApp* self);
+bool CL_CanKeepTop(const CLinesApp* self);
+bool CL_IsSummaryOnly(const CLinesApp* self);
+void CL_SummarizeFile(CLinesApp* self, const LocEntry* lang, const LocStat* stat, bool remove);
+const LocEntry* CL_LangOf(const LineCounter* f);
+CL_Error CL_PrintLangSummary(CLinesApp* self);
+CL_Error CL_PrintFile(CLinesApp* self, LineCounter* f);
 CL_Error CL_PrintFiles(CLinesApp* self);
+CL_Error CL_PrintTotals(CLinesApp* self);
 CL_Error CL_ApplySort(CLinesApp* self);
 CL_Error CL_PrintLocStat(CLinesApp* self, LocStat* stat, usize indentLevel);
 
@@ -54,7 +54,13 @@ typedef struct Config {
     CFG_Switch recursive;
     CFG_Switch debugMode;
     CFG_Switch locEnabled;
+    CFG_Switch locSummary;
     CFG_Switch showHidden;
+    CFG_Switch ioUring;
+    CFG_Switch useCache;
+    CFG_Switch gitMode;
+    CFG_Switch ignoreFiles;
+    CFG_Switch watch;
 
     CFG_Switch showHelp;
     CFG_Switch showVersion;
@@ -64,7 +70,15 @@ typedef struct Config {
     bool maxDepthSetted;
 
     usize top;
-    usize topSetted;
+    bool topSetted;
+
+    usize jobs;
+    bool jobsSetted;
+
+    usize mmapThreshold;
+    bool mmapThresholdSetted;
+
+    char* cachePath; ///< NULL for RC_DEFAULT_PATH
 
     CFG_SortMode sortMode;
     CFG_Switch reverse;
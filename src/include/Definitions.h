@@ -12,6 +12,7 @@ typedef struct FileMeta {
     char* fullPath; /// malloc'ed
     off_t size;
     time_t mtime;
+    long mtimeNsec; ///< sub-second part of mtime
 } FileMeta;
 
 #endif // DEFINTIONS_H
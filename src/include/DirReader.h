@@ -0,0 +1,63 @@
+#ifndef DIR_READER_H
+#define DIR_READER_H
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+
+#include <dirent.h>
+
+#ifndef DR_BUF_SIZE
+#    define DR_BUF_SIZE (64 * 1024)
+#endif
+
+typedef enum DR_Error {
+    DRE_Ok = 0,
+    DRE_OpenError,
+    DRE_ReadError,
+} DR_Error;
+
+typedef enum DR_Backend {
+    DRB_Readdir = 0, ///< portable readdir
+    DRB_Getdents64,  ///< Linux only, fills the caller's buffer with as many entries as fit per syscall
+
+    DRB_Count,
+} DR_Backend;
+
+typedef struct DR_Entry {
+    const char* name;
+    unsigned char type; ///< d_type, DT_UNKNOWN when the filesystem does not fill it
+} DR_Entry;
+
+/**
+ * Reads the entries of an open directory. The getdents64 backend parses entries straight out
+ * of the caller's buffer, so a large buffer means few syscalls for huge directories. readdir
+ * goes through a DIR of its own (on a dup of the fd) and is used where getdents64 is missing.
+ */
+typedef struct DirReader {
+    DR_Backend backend;
+    int fd; ///< borrowed, the caller closes it
+
+    DIR* dir; ///< only for DRB_Readdir
+
+    char* buf; ///< caller provided, only for DRB_Getdents64
+    usize bufCap;
+    usize pos;
+    usize len;
+    bool done;
+} DirReader;
+
+/// Uses the best supported backend. buf should be DR_BUF_SIZE big, getdents64 needs at least 512 bytes (readdir ignores it).
+DR_Error DR_Open(DirReader* self, int fd, char* buf, usize bufCap);
+DR_Error DR_OpenWith(DirReader* self, DR_Backend backend, int fd, char* buf, usize bufCap);
+
+/// Returns the next entry ("." and ".." included), outEntry->name is NULL at the end. It is valid until the next call.
+DR_Error DR_Next(DirReader* self, DR_Entry* outEntry);
+
+DR_Error DR_Close(DirReader* self);
+
+bool DR_IsSupported(DR_Backend backend);
+DR_Backend DR_BestBackend();
+const char* DR_BackendName(DR_Backend backend);
+
+#endif // DIR_READER_H
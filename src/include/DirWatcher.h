@@ -0,0 +1,68 @@
+#ifndef DIR_WATCHER_H
+#define DIR_WATCHER_H
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Quiet time after the last event before the changes are handed out (see --watch).
+#ifndef DW_DEFAULT_DELAY_MS
+#    define DW_DEFAULT_DELAY_MS 200
+#endif
+
+/// Changes are handed out after this long even if events keep coming.
+#ifndef DW_MAX_DELAY_MS
+#    define DW_MAX_DELAY_MS 2000
+#endif
+
+typedef enum DW_Error {
+    DWE_Ok = 0,
+    DWE_AllocFailed,
+    DWE_Unsupported,  ///< no inotify
+    DWE_LimitReached, ///< fs.inotify.max_user_watches (or the fd limit) is used up
+    DWE_WatchFailed,
+    DWE_ReadFailed,
+} DW_Error;
+
+/// All events of one entry of a watched directory since the last DW_Wait.
+typedef struct DW_Change {
+    int wd;        ///< the watch of the directory, as returned by DW_Add
+    char* name;    ///< the entry, NULL for the directory itself (deleted or moved)
+    uint32_t mask; ///< IN_* bits of every event merged
+} DW_Change;
+
+/// Sorted by wd, then name, every entry once.
+typedef struct DW_Changes {
+    DW_Change* data;
+    usize len;
+    usize cap;
+    bool overflow; ///< the kernel dropped events, anything may have changed
+} DW_Changes;
+
+/**
+ * Watches directories (not their subdirectories) through inotify for entries being created,
+ * deleted, moved, written or touched. Events are coalesced: DW_Wait returns only once no new
+ * event came for a while, with a single change per entry.
+ */
+typedef struct DirWatcher {
+    int fd;
+} DirWatcher;
+
+DW_Error DW_Init(DirWatcher* self);
+void DW_Destroy(DirWatcher* self);
+
+/// Starts watching the directory at path, *outWd identifies it in changes.
+DW_Error DW_Add(DirWatcher* self, const char* path, int* outWd);
+void DW_Remove(DirWatcher* self, int wd);
+
+/**
+ * Blocks until something changes, then collects events until none came for delayMs (at most
+ * DW_MAX_DELAY_MS in total). out is cleared first. Events of a watch removed meanwhile are
+ * still reported, the caller skips the watches it does not know anymore.
+ */
+DW_Error DW_Wait(DirWatcher* self, int delayMs, DW_Changes* out);
+
+void DW_FreeChanges(DW_Changes* self);
+
+#endif // DIR_WATCHER_H
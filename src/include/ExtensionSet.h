@@ -0,0 +1,39 @@
+#ifndef EXTENSION_SET_H
+#define EXTENSION_SET_H
+
+#include <Definitions.h>
+#include <StringList.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum ES_Error {
+    ESE_Ok,
+    ESE_AllocFailed,
+} ES_Error;
+
+typedef struct ES_Slot {
+    const char* ext; ///< NULL for an empty slot, points into the source StringList
+    usize len;
+    uint64_t hash;
+} ES_Slot;
+
+/**
+ * Set of file extensions compiled once from --include-ext/--exclude-ext, so checking
+ * a name costs one hash of its extension no matter how many extensions are configured.
+ */
+typedef struct ExtensionSet {
+    ES_Slot* slots;
+    usize mask;
+    usize len;
+} ExtensionSet;
+
+/// The set borrows the strings of exts, which has to outlive it.
+ES_Error ES_Init(ExtensionSet* self, StringList* exts);
+ES_Error ES_Destroy(ExtensionSet* self);
+
+bool ES_Contains(const ExtensionSet* self, const char* ext, usize len);
+/// Checks the extension of a file name (the part after its last dot).
+bool ES_MatchesName(const ExtensionSet* self, const char* name);
+
+#endif // EXTENSION_SET_H
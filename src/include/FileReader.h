@@ -0,0 +1,59 @@
+#ifndef FILE_READER_H
+#define FILE_READER_H
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+
+#ifndef FR_DEFAULT_MMAP_THRESHOLD
+#    define FR_DEFAULT_MMAP_THRESHOLD (1024 * 1024)
+#endif
+
+typedef enum FR_Error {
+    FRE_Ok = 0,
+    FRE_OpenError,
+    FRE_ReadError,
+} FR_Error;
+
+/**
+ * Reads a file block by block. Files of at least `mmapThreshold` bytes are mapped
+ * (with MADV_SEQUENTIAL) and returned as a single block, smaller ones are read()
+ * into the caller's buffer, where the mmap setup would cost more than the copy.
+ *
+ * A mapped file that shrinks while it is read raises SIGBUS on the pages past its new end,
+ * FR_ForEach catches that, reading blocks of FR_Next directly does not.
+ */
+typedef struct FileReader {
+    int fd;
+    usize size;
+
+    bool mapped;
+    char* map;
+
+    char* buf; ///< caller provided, used when the file is not mapped
+    usize bufCap;
+    bool done;
+} FileReader;
+
+/// @param mmapThreshold 0 disables mmap
+FR_Error FR_Open(FileReader* self, const char* path, usize mmapThreshold, char* buf, usize bufCap);
+
+/// Like FR_Open, but a relative path is opened relative to the directory dirFd (see openat), AT_FDCWD works too.
+FR_Error FR_OpenAt(FileReader* self, int dirFd, const char* path, usize mmapThreshold, char* buf, usize bufCap);
+
+/// Returns the next block of the file, *outLen is 0 at the end of the file.
+FR_Error FR_Next(FileReader* self, const char** outData, usize* outLen);
+
+/// Called for every block by FR_ForEach, returns false to stop reading.
+typedef bool (*FR_BlockFn)(void* arg, const char* data, usize len);
+
+/**
+ * Passes every block of the file to fn. A SIGBUS while fn reads a mapped block (the file was
+ * truncated after it was mapped) jumps out of fn and returns FRE_ReadError, so fn must not
+ * take locks or leave state behind that the caller keeps after an error.
+ */
+FR_Error FR_ForEach(FileReader* self, FR_BlockFn fn, void* arg);
+
+FR_Error FR_Close(FileReader* self);
+
+#endif // FILE_READER_H
@@ -0,0 +1,67 @@
+#ifndef GIT_INDEX_H
+#define GIT_INDEX_H
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sys/stat.h>
+
+/// Object ids are SHA-1, repositories with extensions.objectFormat = sha256 are not supported.
+#define GI_OID_SIZE 20
+
+typedef enum GI_Error {
+    GIE_Ok = 0,
+    GIE_AllocFailed,
+    GIE_NotARepo,
+    GIE_ReadError,
+    GIE_InvalidIndex,
+    GIE_Unsupported, ///< unknown index version or a split index
+} GI_Error;
+
+/// A tracked file (stage 0, or the first stage of a conflict).
+typedef struct GI_Entry {
+    const char* path; ///< relative to the work tree, points into GitIndex.paths
+    usize pathLen;
+    uint32_t mode;    ///< 0100644, 0100755 or 0120000 (symlink), submodules are left out
+
+    // stat data as of the last time git looked at the file, truncated to 32 bits like git does
+    uint32_t mtimeSec;
+    uint32_t mtimeNsec;
+    uint32_t ino;
+    uint32_t size;
+
+    uint8_t oid[GI_OID_SIZE];
+    bool hasOid; ///< the oid is the content of the file as staged (not a conflict or intent-to-add)
+} GI_Entry;
+
+/**
+ * The entries of .git/index (versions 2 to 4), sorted by path like git keeps them, so the
+ * files of a directory are next to each other. Files that are not checked out (sparse
+ * checkouts) are left out.
+ */
+typedef struct GitIndex {
+    GI_Entry* entries;
+    usize count;
+    char* paths;
+
+    // mtime of the index file, entries modified at or after it may have changed unnoticed
+    int64_t mtimeSec;
+    int64_t mtimeNsec;
+} GitIndex;
+
+/**
+ * Finds the repository that contains the directory (an absolute, resolved path) by looking
+ * for .git in it and its parents. .git may also be a file pointing to the git directory
+ * (worktrees, submodules). Both out paths are malloc'ed.
+ */
+GI_Error GI_FindRepo(const char* dir, char** outWorkTree, char** outGitDir);
+
+GI_Error GI_Load(GitIndex* self, const char* gitDir);
+GI_Error GI_Destroy(GitIndex* self);
+
+/// Whether the file still has the content of entry->oid, judged by its stat data like git does.
+bool GI_IsUnchanged(const GitIndex* self, const GI_Entry* entry, const struct stat* st);
+
+#endif // GIT_INDEX_H
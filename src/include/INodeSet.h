@@ -3,6 +3,7 @@
 
 #include <Definitions.h>
 
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <sys/stat.h>
@@ -59,6 +60,29 @@ INS_Error INS_Move(INodeSet* dst, INodeSet* src);
 
 bool INS_Contains(const INodeSet* self, INode fi);
 INS_Error INS_Insert(INodeSet* self, INode fi);
+/// Removes fi if it is in the set.
+INS_Error INS_Remove(INodeSet* self, INode fi);
 INS_Error INS_InsertFrom(INodeSet* self, const INodeSet* src);
 
+/// INodeSet split into independently locked shards, safe for concurrent inserts.
+typedef struct INSS_Shard {
+    pthread_mutex_t lock;
+    INodeSet set;
+} INSS_Shard;
+
+typedef struct INodeSharedSet {
+    INSS_Shard* shards;
+    usize shardsCount;
+} INodeSharedSet;
+
+INS_Error INSS_Init(INodeSharedSet* self, usize shardsCount);
+INS_Error INSS_DefaultInit(INodeSharedSet* self);
+INS_Error INSS_Clear(INodeSharedSet* self);
+INS_Error INSS_Destroy(INodeSharedSet* self);
+
+bool INSS_Contains(INodeSharedSet* self, INode fi);
+/// Inserts fi atomically, returns INSE_AlredyExists if another thread inserted it first.
+INS_Error INSS_Insert(INodeSharedSet* self, INode fi);
+INS_Error INSS_Remove(INodeSharedSet* self, INode fi);
+
 #endif // INODE_SET_H
@@ -0,0 +1,85 @@
+#ifndef IGNORE_RULES_H
+#define IGNORE_RULES_H
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Files read from every directory (see --ignore-files), rules of later ones take precedence.
+#define IG_FILE_NAMES { ".gitignore", ".ignore" }
+
+#ifndef IG_MAX_FILE_SIZE
+#    define IG_MAX_FILE_SIZE (1024 * 1024)
+#endif
+
+typedef enum IG_Error {
+    IGE_Ok = 0,
+    IGE_AllocFailed,
+} IG_Error;
+
+typedef struct IG_Rule {
+    char* pattern;   ///< without '!', the leading '/' and the trailing '/'
+    bool negated;    ///< !pattern, re-includes what an earlier rule ignored
+    bool dirOnly;    ///< pattern/, matches directories only
+    bool anchored;   ///< has a '/', matched against the path relative to the directory of the file
+    usize prefixLen; ///< length of the literal start of the pattern, compared before matching the glob
+} IG_Rule;
+
+/// A rule that is a plain name (build, node_modules) or extension (*.o), looked up instead of matched.
+typedef struct IG_Literal {
+    const char* text; ///< points into the pattern of the rule
+    uint32_t rule;
+} IG_Literal;
+
+/**
+ * The rules of the ignore files of one directory, with gitignore semantics: blank lines and
+ * # comments are skipped, the last matching rule wins, ! negates, a trailing / matches only
+ * directories, and a pattern with a / in it is anchored to the directory. *, ? and [...]
+ * do not match /, ** matches any number of directories.
+ *
+ * Plain names and *.ext rules are kept in sorted tables, so most lookups are a couple of
+ * binary searches no matter how many rules there are. Only the remaining globs are matched
+ * one by one (from the last), and only while they could still beat the best match found.
+ * Directories deeper in the tree take precedence, rules of a directory point to the rules
+ * of the nearest parent that has some.
+ */
+typedef struct IgnoreRules {
+    char* text; ///< the ignore files, patterns point into it
+    IG_Rule* rules;
+    usize count;
+
+    IG_Literal* names; ///< sorted by text, then rule
+    usize namesCount;
+    IG_Literal* exts; ///< *.ext rules by ext, sorted like names
+    usize extsCount;
+    uint32_t* globs; ///< the other rules, in order
+    usize globsCount;
+
+    usize dirLen; ///< length of the formatted path of the directory, to get paths relative to it
+    const struct IgnoreRules* parent;
+} IgnoreRules;
+
+/**
+ * Reads the ignore files of the directory (open as dirFd, formatted as path). *out is NULL
+ * when there are none (or no rules in them). Unreadable files are skipped like missing ones.
+ */
+IG_Error IG_Load(int dirFd, const char* path, const IgnoreRules* parent, IgnoreRules** out);
+
+/// Compiles the rules of an ignore file into self (dirLen and parent are left to the caller).
+IG_Error IG_Parse(IgnoreRules* self, const char* text, usize len);
+void IG_Destroy(IgnoreRules* self);
+
+/// Destroys and frees rules from IG_Load.
+void IG_Free(IgnoreRules* self);
+
+/**
+ * Checks whether the entry name of the directory with the formatted path dirPath is
+ * ignored by rules or any of its parents.
+ */
+bool IG_IsIgnored(const IgnoreRules* rules, const char* dirPath, const char* name, bool isDir);
+
+/// Matches a single glob against text the way rules do (* and ? stop at /, ** crosses it).
+bool IG_GlobMatch(const char* pattern, const char* text);
+
+#endif // IGNORE_RULES_H
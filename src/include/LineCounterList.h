@@ -5,7 +5,10 @@
 #include <Definitions.h>
 
 #include <LocSettings.h>
+#include <StringArena.h>
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 typedef enum LCL_Error {
@@ -15,21 +18,47 @@ typedef enum LCL_Error {
     LCLE_IndexOutOfRange,
 } LCL_Error;
 
+/// A single counter of the list, see LCL_Get.
 typedef struct LineCounter {
-    char* toPrint;
+    char* toPrint; ///< in LineCounterList.strings, shared with meta.fullPath when they are equal
     usize lines;
 
-    FileMeta meta;
+    FileMeta meta; ///< fullPath is in LineCounterList.strings too
     bool hasLocStat;
     LocStat locStat;
 } LineCounter;
 
+/**
+ * Counters stored by column: row i of every column is the i-th counter appended, so sorting
+ * and summing touch only the columns they need. Sorting doesn't move rows, it reorders the
+ * 32-bit row numbers of order (see LCL_GetOrdered), rows keep their index for LCL_Get/LCL_Set.
+ */
 typedef struct LineCounterList {
-    LineCounter* data;
     usize len;
     usize cap;
+
+    char** toPrint;
+    char** fullPath; ///< NULL while every fullPath is the same string as toPrint
+    usize* lines;
+    off_t* size;
+    time_t* mtime;
+    long* mtimeNsec;
+
+    // NULL until a counter with a LocStat is stored, locStat.totalLines is lines
+    bool* hasLocStat;
+    usize* emptyLines;
+    usize* commentLines;
+    usize* codeLines;
+    usize* preprocessorLines;
+
+    uint32_t* order; ///< rows in the order of the last LCL_SortBy, appended rows go last
+
+    StringArena strings; ///< the paths of the counters, freed all at once by LCL_Clear
 } LineCounterList;
 
+/// At most this many counters fit, rows are 32-bit.
+#define LCL_MAX_LEN ((usize)UINT32_MAX)
+
 LCL_Error LCL_AllocBuf(LineCounterList* self, usize newCap);
 LCL_Error LCL_Resize(LineCounterList* self, usize newCap);
 LCL_Error LCL_Expand(LineCounterList* self);
@@ -49,9 +78,16 @@ LCL_Error LCL_Copy(LineCounterList* dst, const LineCounterList* src);
 //        if it does, you need to call @ref LCL_Destroy before this operation
 LCL_Error LCL_Move(LineCounterList* dst, LineCounterList* src);
 
+/// @note locStat.totalLines is not stored, lines is returned in its place.
 LCL_Error LCL_Append(LineCounterList* self, const char* name, usize lines, FileMeta* meta, LocStat locStat, bool hasLocStat);
 LCL_Error LCL_Set(LineCounterList* self, usize index, const char* name, usize lines, FileMeta* meta, LocStat locStat, bool hasLocStat);
-LCL_Error LCL_Get(LineCounterList* self, usize index, LineCounter** out);
+/// Removes the counter at index by moving the last one in its place, its paths stay in the arena until LCL_Clear.
+LCL_Error LCL_SwapRemove(LineCounterList* self, usize index);
+
+/// Copies the counter of row index into *out, its paths point into the list.
+LCL_Error LCL_Get(const LineCounterList* self, usize index, LineCounter* out);
+/// Like LCL_Get, but for the pos-th counter in the order of the last LCL_SortBy.
+LCL_Error LCL_GetOrdered(const LineCounterList* self, usize pos, LineCounter* out);
 
 LCL_Error LCL_SortBy(LineCounterList* self, CFG_SortMode mode, bool reverse);
 LCL_Error LCL_Print(const LineCounterList* self, FILE* out);
@@ -0,0 +1,77 @@
+#ifndef LOC_MATCHER_H
+#define LOC_MATCHER_H
+
+#include <LocSettings.h>
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef LM_MAX_DELIMS
+#    define LM_MAX_DELIMS 32
+#endif
+
+#ifndef LM_MAX_NODES
+#    define LM_MAX_NODES 128
+#endif
+
+typedef enum LM_Error {
+    LME_Ok = 0,
+    LME_TooManyDelims,
+} LM_Error;
+
+typedef enum LM_Kind {
+    LMK_String,
+    LMK_MultilineString,
+    LMK_Char,
+    LMK_Comment,
+    LMK_MultilineComment,
+    LMK_PPDirective,
+} LM_Kind;
+
+typedef struct LM_Delim {
+    LM_Kind kind;
+    const char* str; ///< the delimiter from the LocEntry arrays
+    const StringDelimPair* pair; ///< set for LMK_MultilineComment
+    usize len;
+} LM_Delim;
+
+typedef struct LM_Node {
+    uint8_t byte;
+    uint8_t delim; ///< index + 1 of the delimiter ending here, 0 if none
+    uint16_t child; ///< first child, 0 if none
+    uint16_t next; ///< next sibling, 0 if none
+} LM_Node;
+
+/**
+ * Every delimiter of a LocEntry compiled into a byte trie. `first` maps a byte to its
+ * trie node, so most characters of a line are rejected with a single table lookup.
+ * Delimiters keep the LocEntry priority (strings, multiline strings, chars, comments,
+ * multiline comments, pp directives, each in array order), not the longest match.
+ */
+typedef struct LocMatcher {
+    const LocEntry* lang;
+
+    uint16_t first[256];
+
+    LM_Node nodes[LM_MAX_NODES]; ///< nodes[0] is unused, 0 means "no node"
+    usize nodesCount;
+
+    LM_Delim delims[LM_MAX_DELIMS];
+    usize delimsCount;
+} LocMatcher;
+
+LM_Error LM_Compile(LocMatcher* self, const LocEntry* lang);
+
+/// Returns the matcher compiled at startup for an entry of GetLocEntries(), NULL for other entries.
+const LocMatcher* LM_For(const LocEntry* lang);
+
+static inline bool LM_IsCandidate(const LocMatcher* self, char c) {
+    return self->first[(unsigned char)c] != 0;
+}
+
+/// Returns the delimiter str[0..len) starts with, NULL if none.
+const LM_Delim* LM_Match(const LocMatcher* self, const char* str, usize len);
+
+#endif // LOC_MATCHER_H
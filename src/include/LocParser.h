@@ -1,6 +1,7 @@
 #ifndef LOC_PARSER_H
 #define LOC_PARSER_H
 
+#include <LocMatcher.h>
 #include <LocSettings.h>
 
 #include <Definitions.h>
@@ -10,7 +11,9 @@ typedef enum LP_Error {
     LPE_Ok,
     LPE_Unterminated,
     LPE_FileOpenError,
+    LPE_FileReadError,
     LPE_AllocFailed,
+    LPE_TooManyDelims,
 } LP_Error;
 
 typedef enum LP_State {
@@ -35,9 +38,20 @@ typedef struct LocParser {
         const StringDelimPair* lastMultilineCommentDelimPair;
         const char* lastCharDelim;
     };
+    usize lastDelimLen; ///< length of the delimiter that closes the current string/comment
+
+    const LocEntry* matcherLang;
+    const LocMatcher* matcher;
+    LocMatcher localMatcher; ///< compiled here for entries not coming from GetLocEntries()
 
     bool continueSingleLineComment;
     bool continuePPDirective;
+
+    char* carry; ///< unfinished last line of the previous LP_ParseBuffer block
+    usize carryLen;
+    usize carryCap;
+
+    usize mmapThreshold; ///< files at least this big are mapped by LP_ParseFile (0 disables mmap)
 } LocParser;
 
 LP_Error LP_Init(LocParser* self);
@@ -45,7 +59,13 @@ LP_Error LP_Destroy(LocParser* self);
 LP_Error LP_Refresh(LocParser* self, LocStat* result);
 
 LP_Error LP_ParseLine(LocParser* self, const LocEntry* lang, const char* line, usize len, LocStat* result);
+/// Parses a block of a file, a line split between two blocks is carried over to the next call.
+LP_Error LP_ParseBuffer(LocParser* self, const LocEntry* lang, const char* buf, usize len, LocStat* result);
+/// Parses the carried over line, if the last block did not end with a newline.
+LP_Error LP_Finish(LocParser* self, const LocEntry* lang, LocStat* result);
 LP_Error LP_ParseCode(LocParser* self, const LocEntry* lang, const char* code, LocStat* result);
 LP_Error LP_ParseFile(LocParser* self, const LocEntry* lang, const char* path, LocStat* result);
+/// LP_ParseFile with path relative to the directory dirFd (see FR_OpenAt).
+LP_Error LP_ParseFileAt(LocParser* self, const LocEntry* lang, int dirFd, const char* path, LocStat* result);
 
 #endif // LOC_PARSER_H
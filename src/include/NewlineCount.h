@@ -0,0 +1,29 @@
+#ifndef NEWLINE_COUNT_H
+#define NEWLINE_COUNT_H
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+
+typedef enum NC_Kernel {
+    NCK_Scalar = 0, ///< byte by byte, reference implementation
+    NCK_Swar,       ///< portable word-at-a-time
+    NCK_SSE2,
+    NCK_AVX2,
+    NCK_AVX512,
+    NCK_NEON,
+
+    NCK_Count,
+} NC_Kernel;
+
+typedef usize NC_CountFunc(const char* buf, usize len);
+
+/// Counts '\n' bytes in buf using the fastest kernel supported by the running CPU.
+usize NC_Count(const char* buf, usize len);
+
+usize NC_CountWith(NC_Kernel kernel, const char* buf, usize len);
+bool NC_IsSupported(NC_Kernel kernel);
+NC_Kernel NC_BestKernel();
+const char* NC_KernelName(NC_Kernel kernel);
+
+#endif // NEWLINE_COUNT_H
@@ -0,0 +1,62 @@
+#ifndef PATH_TRIE_H
+#define PATH_TRIE_H
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+
+typedef enum PT_Error {
+    PTE_Ok,
+    PTE_AllocFailed,
+} PT_Error;
+
+typedef struct PT_Node {
+    char* name; ///< a single path component, NULL for the root
+    usize nameLen;
+    bool terminal; ///< an inserted path ends here, so everything below is covered too
+
+    struct PT_Node** children; ///< sorted by name
+    usize childrenCount;
+    usize childrenCap;
+} PT_Node;
+
+/**
+ * Absolute paths stored by component ("/a/foo" is a -> foo). A path is covered when it
+ * or one of its parent directories was inserted, so "/a/foo" covers "/a/foo/x" but not
+ * "/a/foobar". Lookups cost one child search per component, and a traversal can keep
+ * the node of the current directory (see PT_Child) to check its entries in one step.
+ */
+typedef struct PathTrie {
+    PT_Node root;
+} PathTrie;
+
+PT_Error PT_Init(PathTrie* self);
+PT_Error PT_Destroy(PathTrie* self);
+
+PT_Error PT_Insert(PathTrie* self, const char* path);
+
+static inline bool PT_IsEmpty(const PathTrie* self) {
+    return self->root.childrenCount == 0 && !self->root.terminal;
+}
+
+static inline const PT_Node* PT_Root(const PathTrie* self) {
+    return &self->root;
+}
+
+/// Returns the child of node for the given component, NULL if there is none (nothing below is covered).
+const PT_Node* PT_Child(const PT_Node* node, const char* name, usize len);
+
+/**
+ * Walks path from node. Returns the node of path, or NULL when nothing at or below path
+ * was inserted. *covered is set if path or one of its parents is covered.
+ */
+const PT_Node* PT_Walk(const PT_Node* node, const char* path, bool* covered);
+
+/// Walks path from node, returns true if it or one of its parents is covered.
+bool PT_CoversFrom(const PT_Node* node, const char* path);
+
+static inline bool PT_Covers(const PathTrie* self, const char* path) {
+    return PT_CoversFrom(&self->root, path);
+}
+
+#endif // PATH_TRIE_H
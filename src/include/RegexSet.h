@@ -0,0 +1,57 @@
+#ifndef REGEX_SET_H
+#define REGEX_SET_H
+
+#include <Definitions.h>
+#include <StringList.h>
+
+#include <regex.h>
+#include <stdbool.h>
+
+typedef enum RS_Error {
+    RSE_Ok,
+    RSE_AllocFailed,
+    RSE_InvalidRegex,
+} RS_Error;
+
+typedef enum RS_LiteralKind {
+    RSLK_Substring, ///< abc
+    RSLK_Prefix,    ///< ^abc
+    RSLK_Suffix,    ///< abc$
+    RSLK_Exact,     ///< ^abc$
+} RS_LiteralKind;
+
+typedef struct RS_Literal {
+    char* text; ///< unescaped, malloc'ed
+    usize len;
+    RS_LiteralKind kind;
+} RS_Literal;
+
+/**
+ * A list of case-insensitive POSIX basic regexes (--include-regex/--exclude-regex) matched
+ * as one. Plain strings are compared directly, the rest is joined into a single GNU
+ * `\(a\)\|\(b\)` alternation compiled with REG_NOSUB, so a path is matched in one regexec.
+ * Patterns with back-references can't be joined (the group numbers would shift) and are
+ * kept as separate regexes.
+ */
+typedef struct RegexSet {
+    usize len; ///< number of source patterns
+
+    RS_Literal* literals;
+    usize literalsCount;
+
+    bool hasCombined;
+    regex_t combined;
+
+    regex_t* separate;
+    usize separateCount;
+
+    const char* invalidPattern; ///< set when RS_Init returns RSE_InvalidRegex
+} RegexSet;
+
+RS_Error RS_Init(RegexSet* self, StringList* patterns);
+RS_Error RS_Destroy(RegexSet* self);
+
+/// Checks whether str matches any of the patterns.
+bool RS_Matches(const RegexSet* self, const char* str);
+
+#endif // REGEX_SET_H
@@ -0,0 +1,123 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <Definitions.h>
+#include <LocSettings.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define RC_MAGIC "CLNCACHE"
+#define RC_VERSION 2
+#define RC_DEFAULT_PATH ".clines-cache"
+#define RC_BYTE_ORDER 0x01020304u
+
+/// Files modified this close to the start of a run are not saved, a change in the same mtime tick would go unnoticed.
+#ifndef RC_RACY_NS
+#    define RC_RACY_NS 2000000000LL
+#endif
+
+/// Results of files not visited by a run are kept while the file holds fewer records than this.
+#ifndef RC_MAX_RECORDS
+#    define RC_MAX_RECORDS (1 << 21)
+#endif
+
+typedef enum RC_Error {
+    RCE_Ok = 0,
+    RCE_AllocFailed,
+    RCE_WriteError,
+} RC_Error;
+
+/// Identifies a version of a file and how it was counted.
+typedef struct RC_Key {
+    uint64_t dev;
+    uint64_t ino;
+    int64_t size;
+    int64_t mtimeNs;
+    uint32_t mode; ///< 0 for a plain newline count, n for LOC parsing with GetLocEntries()[n - 1]
+} RC_Key;
+
+/// dev of records keyed by the git object id of the content instead of an inode, see RC_BlobKey.
+#define RC_BLOB_DEV UINT64_MAX
+
+/// Content known by its blob id (see --git) is the same in every branch and worktree, so its key does not depend on the file.
+static inline RC_Key RC_BlobKey(const uint8_t* oid, int64_t size, uint32_t mode) {
+    RC_Key key = { .dev = RC_BLOB_DEV, .size = size, .mode = mode };
+    memcpy(&key.ino, oid, sizeof(key.ino));
+    memcpy(&key.mtimeNs, oid + sizeof(key.ino), sizeof(key.mtimeNs));
+    return key;
+}
+
+typedef struct RC_Value {
+    usize lines;
+    LocStat locStat; ///< only for modes above 0
+} RC_Value;
+
+/// A record of the file, the header is followed by count records sorted by (dev, ino).
+typedef struct RC_Record {
+    uint64_t dev;
+    uint64_t ino;
+    int64_t size;
+    int64_t mtimeNs;
+    uint32_t mode;
+    uint32_t reserved;
+
+    uint64_t lines;
+    uint64_t emptyLines;
+    uint64_t commentLines;
+    uint64_t codeLines;
+    uint64_t preprocessorLines;
+} RC_Record;
+
+typedef struct RC_Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;  ///< RC_BYTE_ORDER as written, a cache from another endianness does not match
+    uint32_t recordSize; ///< sizeof(RC_Record)
+    uint32_t langCount;  ///< modes depend on the order of GetLocEntries()
+    uint64_t langHash;   ///< of the names and delimiters of GetLocEntries(), a changed table does not match
+    int64_t startedNs;   ///< start of the run that wrote the file
+    uint64_t count;
+} RC_Header;
+
+/**
+ * Results of earlier runs, so unchanged files are not opened at all. The file is mapped
+ * and searched in place (lookups are read only, so workers can do them concurrently).
+ * The results of the current run are collected with RC_Add and merged into the file on save:
+ * they replace the records of the files they belong to, records of files the run did not
+ * visit (another directory counted with the same cache) are kept up to RC_MAX_RECORDS.
+ * Blob records never go stale, unvisited ones are kept (at most as many as there are fresh
+ * records) for other branches.
+ */
+typedef struct ResultCache {
+    void* map;
+    usize mapSize;
+    const RC_Record* records;
+    usize count;
+
+    int64_t startedNs;
+    RC_Record* fresh;
+    usize freshLen;
+    usize freshCap;
+
+    RC_Record* racy; ///< files visited but not saved (see RC_RACY_NS), only their ids matter
+    usize racyLen;
+    usize racyCap;
+} ResultCache;
+
+RC_Error RC_Init(ResultCache* self);
+RC_Error RC_Destroy(ResultCache* self);
+
+/// Maps the cache file. A missing, unreadable or incompatible file is just an empty cache.
+RC_Error RC_Load(ResultCache* self, const char* path);
+
+bool RC_Lookup(const ResultCache* self, const RC_Key* key, RC_Value* out);
+
+/// Remembers the result for the next run (not thread safe).
+RC_Error RC_Add(ResultCache* self, const RC_Key* key, const RC_Value* value);
+
+/// Writes the added results, with the still valid loaded ones, to path (through a temporary file and rename).
+RC_Error RC_Save(ResultCache* self, const char* path);
+
+#endif // RESULT_CACHE_H
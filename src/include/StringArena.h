@@ -0,0 +1,43 @@
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include <Definitions.h>
+
+/// Size of a regular chunk, longer strings get a mapping of their own.
+#ifndef SA_CHUNK_SIZE
+#    define SA_CHUNK_SIZE (1024 * 1024)
+#endif
+
+typedef enum SA_Error {
+    SAE_Ok = 0,
+    SAE_AllocFailed,
+} SA_Error;
+
+/// A mapping the strings are bumped into, chunks are linked from the newest one.
+typedef struct SA_Chunk {
+    struct SA_Chunk* next;
+    usize size; ///< of the whole mapping, this header included
+    usize used;
+} SA_Chunk;
+
+/**
+ * Strings that are freed all at once: each one is copied after the previous one into
+ * mmap'ed chunks, so adding costs a memcpy and destroying a munmap per chunk. Single
+ * strings can't be freed, their space comes back only with SA_Clear.
+ */
+typedef struct StringArena {
+    SA_Chunk* head; ///< the chunk strings are added to
+    usize bytes;    ///< taken by the strings, terminators included
+} StringArena;
+
+SA_Error SA_Init(StringArena* self);
+SA_Error SA_Destroy(StringArena* self);
+
+/// Unmaps every chunk, strings returned so far are gone.
+SA_Error SA_Clear(StringArena* self);
+
+/// Copies the len bytes of str (plus a terminator) into the arena.
+SA_Error SA_DupN(StringArena* self, const char* str, usize len, char** out);
+SA_Error SA_Dup(StringArena* self, const char* str, char** out);
+
+#endif // STRING_ARENA_H
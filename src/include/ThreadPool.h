@@ -0,0 +1,72 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <Definitions.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+typedef enum TP_Error {
+    TPE_Ok = 0,
+    TPE_AllocFailed,
+    TPE_ThreadError,
+    TPE_InvalidArgument,
+} TP_Error;
+
+typedef void TP_TaskFunc(void* arg);
+
+typedef struct TP_Task {
+    TP_TaskFunc* func;
+    void* arg;
+} TP_Task;
+
+/// Per-worker double ended queue. The owner pushes and pops at the bottom,
+/// other workers steal from the top.
+typedef struct TP_Deque {
+    pthread_mutex_t lock;
+    TP_Task* data; ///< ring buffer
+    usize head;    ///< index of the top element
+    usize len;
+    usize cap;
+} TP_Deque;
+
+typedef struct TP_Worker {
+    struct ThreadPool* pool;
+    usize index;
+    pthread_t thread;
+} TP_Worker;
+
+typedef struct ThreadPool {
+    TP_Worker* workers;
+    TP_Deque* deques;
+    usize workersCount;
+
+    pthread_mutex_t lock;
+    pthread_cond_t workAvailable;
+    pthread_cond_t allDone;
+
+    atomic_size_t queued;  ///< tasks sitting in deques
+    atomic_size_t pending; ///< tasks submitted but not finished yet
+    atomic_size_t nextDeque;
+    bool stopping;
+} ThreadPool;
+
+TP_Error TP_Init(ThreadPool* self, usize workersCount);
+TP_Error TP_Destroy(ThreadPool* self);
+
+/// Submits a task. When called from a worker of this pool the task goes to the
+/// worker's own deque, otherwise the deques are filled round-robin.
+TP_Error TP_Submit(ThreadPool* self, TP_TaskFunc* func, void* arg);
+
+/// Blocks until every submitted task (including tasks submitted by tasks) finished.
+/// @note Must not be called from a worker thread.
+TP_Error TP_Wait(ThreadPool* self);
+
+/// Returns the index of the calling worker, or -1 if called from outside of any pool.
+isize TP_CurrentWorker();
+
+/// Returns the number of online processors (at least 1).
+usize TP_DefaultWorkersCount();
+
+#endif // THREAD_POOL_H
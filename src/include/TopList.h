@@ -0,0 +1,44 @@
+#ifndef TOP_LIST_H
+#define TOP_LIST_H
+
+#include <Config.h>
+#include <Definitions.h>
+#include <LineCounterList.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum TL_Error {
+    TLE_Ok = 0,
+    TLE_AllocFailed,
+} TL_Error;
+
+/**
+ * The first limit counters in the order LCL_SortBy(mode, reverse) gives, kept while they are
+ * offered one by one (see --top). They form a heap whose root is the last of them, so a counter
+ * that doesn't get in costs one comparison, and memory stays bounded by limit however many
+ * counters are offered.
+ */
+typedef struct TopList {
+    usize limit;
+    CFG_SortMode mode;
+    bool reverse;
+
+    LineCounterList list; ///< the kept counters, the row of a dropped one is reused
+    uint32_t* heap;       ///< rows of list, the root comes last in the order
+    uint64_t* offeredAt;  ///< by row, equal counters keep the order they were offered in
+    usize cap;            ///< of heap and offeredAt
+    uint64_t offered;
+    usize compactAt; ///< paths of dropped counters are freed once the arena of list holds this many bytes
+} TopList;
+
+TL_Error TL_Init(TopList* self, usize limit, CFG_SortMode mode, bool reverse);
+TL_Error TL_Destroy(TopList* self);
+
+/// Keeps a copy of the counter if it is among the first limit ones offered so far.
+TL_Error TL_Offer(TopList* self, const char* name, usize lines, FileMeta* meta, LocStat locStat, bool hasLocStat);
+
+/// Appends the kept counters to dst in the order they were offered (so LCL_SortBy orders them as it would all of them) and empties the list.
+TL_Error TL_MoveTo(TopList* self, LineCounterList* dst);
+
+#endif // TOP_LIST_H
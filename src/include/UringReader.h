@@ -0,0 +1,80 @@
+#ifndef URING_READER_H
+#define URING_READER_H
+
+#include <Definitions.h>
+
+#include <stdbool.h>
+
+#ifndef UR_QUEUE_DEPTH
+#    define UR_QUEUE_DEPTH 32
+#endif
+
+#ifndef UR_SLOT_SIZE
+#    define UR_SLOT_SIZE (64 * 1024)
+#endif
+
+typedef enum UR_Error {
+    URE_Ok = 0,
+    URE_Unsupported,
+    URE_SetupFailed,
+    URE_SubmitFailed,
+} UR_Error;
+
+typedef struct UR_File {
+    int dirFd; ///< path is relative to it, AT_FDCWD works too
+    const char* path;
+} UR_File;
+
+typedef struct UR_Result {
+    const char* data;
+    usize len;
+    int err;        ///< errno of the failed open or read, 0 on success
+    bool truncated; ///< the file filled the whole slot, so it may be bigger than data
+} UR_Result;
+
+typedef void UR_Callback(void* ctx, usize index, const UR_Result* result);
+
+/**
+ * Reads whole small files through io_uring. Every file is an openat -> read -> close chain
+ * on a direct descriptor, so nothing goes back to userspace between the three steps, and
+ * up to UR_QUEUE_DEPTH chains are in flight at once (one syscall per batch instead of at
+ * least three per file). Files are read into UR_SLOT_SIZE slots, bigger ones come back
+ * truncated and should be read the usual way. Linux 5.15+ only (see UR_IsSupported).
+ */
+typedef struct UringReader {
+    int ringFd;
+    unsigned entries;
+
+    void* sqRing;
+    usize sqRingSize;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned sqMask;
+    unsigned* sqArray;
+    struct io_uring_sqe* sqes;
+    usize sqesSize;
+
+    void* cqRing;
+    usize cqRingSize;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe* cqes;
+
+    char* slots; ///< UR_QUEUE_DEPTH * UR_SLOT_SIZE bytes
+    bool broken; ///< a submit failed, requests may still be in flight, so the ring must not be used anymore
+} UringReader;
+
+UR_Error UR_Init(UringReader* self);
+UR_Error UR_Destroy(UringReader* self);
+
+/**
+ * Reads the files, cb is called once for every file (in completion order) and the data
+ * is only valid during the call. On URE_SubmitFailed some files may not have been reported.
+ */
+UR_Error UR_ReadFiles(UringReader* self, const UR_File* files, usize count, UR_Callback* cb, void* ctx);
+
+/// Checks (once) if the kernel allows io_uring and supports direct descriptors for openat/read/close.
+bool UR_IsSupported();
+
+#endif // URING_READER_H
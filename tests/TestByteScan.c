@@ -0,0 +1,46 @@
+#include <Unity/unity.h>
+
+#include <ByteScan.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+void setUp() {}
+void tearDown() {}
+
+void TestKernelsMatchScalar() {
+    char buf[300];
+    srand(7);
+
+    // every position of the first match, including none at all (-1)
+    for (int at = -1; at < (int)sizeof(buf); ++at) {
+        for (usize i = 0; i < sizeof(buf); ++i) buf[i] = 'a' + rand() % 26;
+        if (at >= 0) buf[at] = (at % 2) ? '"' : '\\';
+
+        for (BS_Kernel k = 0; k < BSK_Count; ++k) {
+            if (!BS_IsSupported(k)) continue;
+
+            for (usize off = 0; off < 3; ++off) {
+                usize expected = BS_FindAny2With(BSK_Scalar, buf + off, sizeof(buf) - off, '\\', '"');
+                usize got = BS_FindAny2With(k, buf + off, sizeof(buf) - off, '\\', '"');
+                TEST_ASSERT_EQUAL_MESSAGE(expected, got, BS_KernelName(k));
+            }
+        }
+    }
+}
+
+void TestFindAny2() {
+    const char* text = "a string with \\\"escapes\\\" and a \"quote";
+
+    TEST_ASSERT_EQUAL(strchr(text, '\\') - text, BS_FindAny2(text, strlen(text), '"', '\\'));
+    TEST_ASSERT_EQUAL(strlen(text), BS_FindAny2(text, strlen(text), '*', '/'));
+    TEST_ASSERT_EQUAL(strchr(text, 'q') - text, BS_FindAny2(text, strlen(text), 'q', 'q'));
+    TEST_ASSERT_EQUAL(0, BS_FindAny2(text, 0, 'a', 'a'));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestKernelsMatchScalar);
+    RUN_TEST(TestFindAny2);
+    return UNITY_END();
+}
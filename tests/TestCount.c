@@ -0,0 +1,170 @@
+#include <Unity/unity.h>
+
+#include <CLines/App.h>
+#include <LineCounterList.h>
+#include <LocUtils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DIRS_COUNT 8
+#define RUNS_COUNT 20
+
+static char dirPath[] = "/tmp/clines-count-XXXXXX";
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * Counts dirPath with the given --jobs and returns the counted paths in the order they were listed, one per line.
+ * budget limits the entries CL_CountParallel holds (see CLinesApp.pendingEntriesBudget), 0 keeps the default.
+ */
+static char* CountPaths(const char* jobs, usize budget, usize* outDirCount) {
+    char* argv[] = { "clines", dirPath, (char*)jobs, "--no-cache" };
+    CLinesApp app;
+    TEST_ASSERT_EQUAL(CLE_Ok, CL_Init(&app));
+    TEST_ASSERT_EQUAL(CLE_Ok, CL_LoadConfig(&app, sizeof(argv) / sizeof(argv[0]), argv));
+    TEST_ASSERT_EQUAL(CLE_Ok, CL_StartWorkers(&app));
+    if (budget > 0) app.pendingEntriesBudget = budget;
+    TEST_ASSERT_EQUAL(CLE_Ok, CL_Count(&app, dirPath));
+
+    usize cap = 1;
+    for (usize i = 0; i < app.files.len; ++i) {
+        LineCounter c;
+        LCL_Get(&app.files, i, &c);
+        cap += strlen(c.toPrint) + 1;
+    }
+
+    char* paths = malloc(cap);
+    TEST_ASSERT_NOT_NULL(paths);
+    paths[0] = '\0';
+    for (usize i = 0; i < app.files.len; ++i) {
+        LineCounter c;
+        LCL_Get(&app.files, i, &c);
+        strcat(paths, c.toPrint);
+        strcat(paths, "\n");
+    }
+
+    *outDirCount = app.dirCount;
+    TEST_ASSERT_EQUAL(0, atomic_load(&app.pendingEntries));
+    CL_Destroy(&app);
+    return paths;
+}
+
+void TestParallelKeepsTheCopiesOfTheSerialWalk() {
+    usize serialDirs;
+    char* serial = CountPaths("--jobs=1", 0, &serialDirs);
+    TEST_ASSERT_NOT_NULL(strstr(serial, "f.txt"));
+
+    // which task reaches a directory first changes from run to run, the result must not
+    for (usize run = 0; run < RUNS_COUNT; ++run) {
+        usize parallelDirs;
+        char* parallel = CountPaths("--jobs=4", 0, &parallelDirs);
+        TEST_ASSERT_EQUAL_STRING(serial, parallel);
+        TEST_ASSERT_EQUAL(serialDirs, parallelDirs);
+        free(parallel);
+    }
+    free(serial);
+}
+
+void TestParallelOverTheBudgetKeepsTheSerialWalk() {
+    usize serialDirs;
+    char* serial = CountPaths("--jobs=1", 0, &serialDirs);
+
+    // most directories wait for the merge to reach them before they are scanned
+    for (usize budget = 1; budget <= 16; budget *= 4) {
+        usize parallelDirs;
+        char* parallel = CountPaths("--jobs=4", budget, &parallelDirs);
+        TEST_ASSERT_EQUAL_STRING(serial, parallel);
+        TEST_ASSERT_EQUAL(serialDirs, parallelDirs);
+        free(parallel);
+    }
+    free(serial);
+}
+
+/// Counts dirPath with --loc-summary the way CL_Run sets it up and returns the table, by GetLocEntries() index.
+static CL_LangSummary* CountSummary(const char* jobs, usize budget, usize* outLines) {
+    char* argv[] = { "clines", dirPath, (char*)jobs, "--no-cache", "--loc-summary" };
+    CLinesApp app;
+    TEST_ASSERT_EQUAL(CLE_Ok, CL_Init(&app));
+    TEST_ASSERT_EQUAL(CLE_Ok, CL_LoadConfig(&app, sizeof(argv) / sizeof(argv[0]), argv));
+    TEST_ASSERT_EQUAL(CLE_Ok, CL_StartWorkers(&app));
+    if (budget > 0) app.pendingEntriesBudget = budget;
+
+    app.summaryOnly = CL_IsSummaryOnly(&app);
+    TEST_ASSERT_TRUE(app.summaryOnly);
+    app.langSummary = calloc(GetLocEntriesCount(), sizeof(CL_LangSummary));
+    TEST_ASSERT_NOT_NULL(app.langSummary);
+    TEST_ASSERT_EQUAL(CLE_Ok, CL_Count(&app, dirPath));
+
+    // per-file data is gone once merged, the list stays empty
+    TEST_ASSERT_EQUAL(0, app.files.len);
+    TEST_ASSERT_EQUAL(0, atomic_load(&app.pendingEntries));
+
+    CL_LangSummary* summary = app.langSummary;
+    app.langSummary = NULL;
+    *outLines = app.linesCount;
+    CL_Destroy(&app);
+    return summary;
+}
+
+void TestParallelSummaryMatchesTheSerialOne() {
+    usize serialLines;
+    CL_LangSummary* serial = CountSummary("--jobs=1", 0, &serialLines);
+
+    usize parallelLines;
+    CL_LangSummary* parallel = CountSummary("--jobs=4", 1, &parallelLines);
+    TEST_ASSERT_EQUAL(serialLines, parallelLines);
+    TEST_ASSERT_EQUAL_MEMORY(serial, parallel, GetLocEntriesCount() * sizeof(CL_LangSummary));
+
+    const LocEntry* c;
+    TEST_ASSERT_TRUE(GetLocLangFor("g.c", &c));
+    TEST_ASSERT_EQUAL(DIRS_COUNT, serial[c - GetLocEntries()].files);
+
+    free(serial);
+    free(parallel);
+}
+
+int main() {
+    if (mkdtemp(dirPath) == NULL) return 1;
+
+    // every directory is also reachable through the others: <d>/x/l<m> -> ../../<m>
+    char path[256], target[64];
+    for (char d = 'a'; d < 'a' + DIRS_COUNT; ++d) {
+        snprintf(path, sizeof(path), "%s/%c", dirPath, d);
+        mkdir(path, 0755);
+        snprintf(path, sizeof(path), "%s/%c/f.txt", dirPath, d);
+        int fd = open(path, O_WRONLY | O_CREAT, 0644);
+        if (write(fd, "line\n", 5) != 5) return 1;
+        close(fd);
+        snprintf(path, sizeof(path), "%s/%c/g.c", dirPath, d);
+        fd = open(path, O_WRONLY | O_CREAT, 0644);
+        if (write(fd, "int x; // y\n", 12) != 12) return 1;
+        close(fd);
+        snprintf(path, sizeof(path), "%s/%c/x", dirPath, d);
+        mkdir(path, 0755);
+
+        for (char m = 'a'; m < 'a' + DIRS_COUNT; ++m) {
+            if (m == d) continue;
+            snprintf(path, sizeof(path), "%s/%c/x/l%c", dirPath, d, m);
+            snprintf(target, sizeof(target), "../../%c", m);
+            if (symlink(target, path) != 0) return 1;
+        }
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(TestParallelKeepsTheCopiesOfTheSerialWalk);
+    RUN_TEST(TestParallelOverTheBudgetKeepsTheSerialWalk);
+    RUN_TEST(TestParallelSummaryMatchesTheSerialOne);
+    int res = UNITY_END();
+
+    char cmd[64];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dirPath);
+    if (system(cmd) != 0) return 1;
+    return res;
+}
@@ -0,0 +1,93 @@
+#include <Unity/unity.h>
+
+#include <DirReader.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ENTRIES_COUNT 300
+
+static char dirPath[] = "/tmp/clines-dirreader-XXXXXX";
+
+void setUp() {}
+void tearDown() {}
+
+/// Reads the whole directory, marks seen[i] for every "entry_<i>" and returns how many entries there were.
+static usize ReadAll(DR_Backend backend, usize bufCap, bool* seen) {
+    int fd = open(dirPath, O_RDONLY | O_DIRECTORY);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+
+    char* buf = malloc(bufCap);
+    DirReader reader;
+    TEST_ASSERT_EQUAL(DRE_Ok, DR_OpenWith(&reader, backend, fd, buf, bufCap));
+
+    usize count = 0;
+    DR_Entry entry;
+    while (DR_Next(&reader, &entry) == DRE_Ok && entry.name != NULL) {
+        count++;
+
+        int i;
+        if (sscanf(entry.name, "entry_%d", &i) == 1) {
+            TEST_ASSERT_FALSE(seen[i]);
+            TEST_ASSERT_TRUE(entry.type == DT_REG || entry.type == DT_UNKNOWN);
+            seen[i] = true;
+        } else if (strcmp(entry.name, "subdir") == 0) {
+            TEST_ASSERT_TRUE(entry.type == DT_DIR || entry.type == DT_UNKNOWN);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(DRE_Ok, DR_Close(&reader));
+    free(buf);
+    close(fd);
+    return count;
+}
+
+void TestBackendsAgree() {
+    for (DR_Backend backend = 0; backend < DRB_Count; ++backend) {
+        if (!DR_IsSupported(backend)) continue;
+
+        // a small buffer needs many calls, a big one gets everything at once
+        const usize bufCaps[] = { 512, DR_BUF_SIZE };
+        for (usize b = 0; b < 2; ++b) {
+            bool seen[ENTRIES_COUNT] = {0};
+            usize count = ReadAll(backend, bufCaps[b], seen);
+
+            // ".", ".." and subdir
+            TEST_ASSERT_EQUAL_MESSAGE(ENTRIES_COUNT + 3, count, DR_BackendName(backend));
+            for (usize i = 0; i < ENTRIES_COUNT; ++i) TEST_ASSERT_TRUE(seen[i]);
+        }
+    }
+}
+
+void TestBestBackendIsSupported() {
+    TEST_ASSERT_TRUE(DR_IsSupported(DRB_Readdir));
+    TEST_ASSERT_TRUE(DR_IsSupported(DR_BestBackend()));
+    TEST_ASSERT_EQUAL_STRING("unknown", DR_BackendName(DRB_Count));
+}
+
+int main() {
+    if (mkdtemp(dirPath) == NULL) return 1;
+
+    char path[256];
+    for (int i = 0; i < ENTRIES_COUNT; ++i) {
+        // long names so that a 512 bytes buffer only holds a few of them
+        snprintf(path, sizeof(path), "%s/entry_%d_%060d", dirPath, i, 0);
+        close(open(path, O_WRONLY | O_CREAT, 0644));
+    }
+    snprintf(path, sizeof(path), "%s/subdir", dirPath);
+    mkdir(path, 0755);
+
+    UNITY_BEGIN();
+    RUN_TEST(TestBackendsAgree);
+    RUN_TEST(TestBestBackendIsSupported);
+    int res = UNITY_END();
+
+    char cmd[300];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", dirPath);
+    return system(cmd) == 0 ? res : 1;
+}
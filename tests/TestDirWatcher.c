@@ -0,0 +1,109 @@
+#include <Unity/unity.h>
+
+#include <DirWatcher.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char dirPath[] = "/tmp/clines-dirwatcher-XXXXXX";
+static DirWatcher watcher;
+static DW_Changes changes;
+
+void setUp() {
+    TEST_ASSERT_NOT_NULL(mkdtemp(dirPath));
+    TEST_ASSERT_EQUAL(DWE_Ok, DW_Init(&watcher));
+}
+
+void tearDown() {
+    DW_FreeChanges(&changes);
+    DW_Destroy(&watcher);
+
+    char cmd[sizeof(dirPath) + 16];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dirPath);
+    TEST_ASSERT_EQUAL(0, system(cmd));
+    strcpy(dirPath + strlen(dirPath) - 6, "XXXXXX");
+}
+
+static void WriteFile(const char* name, const char* text) {
+    char path[sizeof(dirPath) + 32];
+    snprintf(path, sizeof(path), "%s/%s", dirPath, name);
+
+    FILE* fp = fopen(path, "w");
+    TEST_ASSERT_NOT_NULL(fp);
+    fputs(text, fp);
+    fclose(fp);
+}
+
+static const DW_Change* FindChange(int wd, const char* name) {
+    for (usize i = 0; i < changes.len; ++i) {
+        const DW_Change* change = &changes.data[i];
+        if (change->wd != wd) continue;
+        if (name == NULL ? change->name == NULL : change->name != NULL && strcmp(change->name, name) == 0) return change;
+    }
+    return NULL;
+}
+
+void TestCoalescesEventsOfAnEntry() {
+    int wd;
+    TEST_ASSERT_EQUAL(DWE_Ok, DW_Add(&watcher, dirPath, &wd));
+
+    WriteFile("a.txt", "1\n");
+    WriteFile("a.txt", "1\n2\n");
+    WriteFile("b.txt", "1\n");
+
+    TEST_ASSERT_EQUAL(DWE_Ok, DW_Wait(&watcher, 50, &changes));
+    TEST_ASSERT_FALSE(changes.overflow);
+    TEST_ASSERT_EQUAL(2, changes.len);
+
+    const DW_Change* a = FindChange(wd, "a.txt");
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_TRUE(a->mask & IN_CREATE);
+    TEST_ASSERT_TRUE(a->mask & IN_CLOSE_WRITE);
+    TEST_ASSERT_NOT_NULL(FindChange(wd, "b.txt"));
+}
+
+void TestReportsDeletedDirectories() {
+    char sub[sizeof(dirPath) + 8];
+    snprintf(sub, sizeof(sub), "%s/sub", dirPath);
+    TEST_ASSERT_EQUAL(0, mkdir(sub, 0755));
+
+    int wd, subWd;
+    TEST_ASSERT_EQUAL(DWE_Ok, DW_Add(&watcher, dirPath, &wd));
+    TEST_ASSERT_EQUAL(DWE_Ok, DW_Add(&watcher, sub, &subWd));
+    TEST_ASSERT_NOT_EQUAL(wd, subWd);
+
+    TEST_ASSERT_EQUAL(0, rmdir(sub));
+    TEST_ASSERT_EQUAL(DWE_Ok, DW_Wait(&watcher, 50, &changes));
+
+    const DW_Change* entry = FindChange(wd, "sub");
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_TRUE(entry->mask & IN_DELETE);
+    TEST_ASSERT_TRUE(entry->mask & IN_ISDIR);
+
+    const DW_Change* self = FindChange(subWd, NULL);
+    TEST_ASSERT_NOT_NULL(self);
+    TEST_ASSERT_TRUE(self->mask & IN_DELETE_SELF);
+}
+
+void TestRejectsFiles() {
+    WriteFile("file", "x\n");
+
+    char path[sizeof(dirPath) + 8];
+    snprintf(path, sizeof(path), "%s/file", dirPath);
+
+    int wd;
+    TEST_ASSERT_EQUAL(DWE_WatchFailed, DW_Add(&watcher, path, &wd));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestCoalescesEventsOfAnEntry);
+    RUN_TEST(TestReportsDeletedDirectories);
+    RUN_TEST(TestRejectsFiles);
+    return UNITY_END();
+}
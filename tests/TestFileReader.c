@@ -0,0 +1,104 @@
+#include <Unity/unity.h>
+
+#include <FileReader.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define FILE_SIZE (4 * 1024 * 1024)
+
+static char filePath[] = "/tmp/clines-reader-XXXXXX";
+static char buf[4096];
+
+static void FillFile() {
+    int fd = open(filePath, O_WRONLY | O_TRUNC);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+
+    char* data = malloc(FILE_SIZE);
+    TEST_ASSERT_NOT_NULL(data);
+    for (usize i = 0; i < FILE_SIZE; ++i) data[i] = i % 64 == 63 ? '\n' : 'x';
+    TEST_ASSERT_EQUAL(FILE_SIZE, write(fd, data, FILE_SIZE));
+    free(data);
+    close(fd);
+}
+
+void setUp() {
+    int fd = mkstemp(filePath);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    close(fd);
+    FillFile();
+}
+
+void tearDown() {
+    unlink(filePath);
+    strcpy(filePath, "/tmp/clines-reader-XXXXXX");
+}
+
+static bool SumBlock(void* arg, const char* data, usize len) {
+    usize* newlines = arg;
+    for (usize i = 0; i < len; ++i) *newlines += data[i] == '\n';
+    return true;
+}
+
+/// Truncates the file it reads, then reads its last byte, which is no longer backed by the file.
+static bool TruncatingBlock(void* arg, const char* data, usize len) {
+    usize* newlines = arg;
+    if (truncate(filePath, 0) != 0) return false;
+    *newlines += data[len - 1] == '\n';
+    return true;
+}
+
+void TestMappedAndReadBlocksMatch() {
+    usize thresholds[] = { 0, 1, FILE_SIZE + 1 };
+    for (usize t = 0; t < sizeof(thresholds) / sizeof(thresholds[0]); ++t) {
+        FileReader reader;
+        TEST_ASSERT_EQUAL(FRE_Ok, FR_Open(&reader, filePath, thresholds[t], buf, sizeof(buf)));
+        TEST_ASSERT_EQUAL(thresholds[t] == 1, reader.mapped);
+
+        usize newlines = 0;
+        TEST_ASSERT_EQUAL(FRE_Ok, FR_ForEach(&reader, SumBlock, &newlines));
+        TEST_ASSERT_EQUAL(FILE_SIZE / 64, newlines);
+        FR_Close(&reader);
+    }
+}
+
+void TestTruncatedMappingIsAReadError() {
+    FileReader reader;
+    TEST_ASSERT_EQUAL(FRE_Ok, FR_Open(&reader, filePath, 1, buf, sizeof(buf)));
+    TEST_ASSERT_TRUE(reader.mapped);
+
+    usize newlines = 0;
+    TEST_ASSERT_EQUAL(FRE_ReadError, FR_ForEach(&reader, TruncatingBlock, &newlines));
+    TEST_ASSERT_EQUAL(0, newlines);
+    FR_Close(&reader);
+
+    // the handler stays usable for the next file
+    FillFile();
+    TEST_ASSERT_EQUAL(FRE_Ok, FR_Open(&reader, filePath, 1, buf, sizeof(buf)));
+    TEST_ASSERT_TRUE(reader.mapped);
+    TEST_ASSERT_EQUAL(FRE_Ok, FR_ForEach(&reader, SumBlock, &newlines));
+    TEST_ASSERT_EQUAL(FILE_SIZE / 64, newlines);
+    FR_Close(&reader);
+}
+
+void TestTruncatedFileIsReadShorter() {
+    FileReader reader;
+    TEST_ASSERT_EQUAL(FRE_Ok, FR_Open(&reader, filePath, 0, buf, sizeof(buf)));
+
+    usize newlines = 0;
+    TEST_ASSERT_EQUAL(FRE_Ok, FR_ForEach(&reader, TruncatingBlock, &newlines));
+    TEST_ASSERT_EQUAL(1, newlines);
+    FR_Close(&reader);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestMappedAndReadBlocksMatch);
+    RUN_TEST(TestTruncatedMappingIsAReadError);
+    RUN_TEST(TestTruncatedFileIsReadShorter);
+    return UNITY_END();
+}
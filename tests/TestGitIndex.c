@@ -0,0 +1,176 @@
+#include <Unity/unity.h>
+
+#include <GitIndex.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char repoPath[] = "/tmp/clines-gitindex-XXXXXX";
+static char gitDir[sizeof(repoPath) + 8];
+
+static unsigned char buf[4096];
+static usize len;
+static const char* prevPath;
+
+void setUp() {
+    TEST_ASSERT_NOT_NULL(mkdtemp(repoPath));
+    snprintf(gitDir, sizeof(gitDir), "%s/.git", repoPath);
+    TEST_ASSERT_EQUAL(0, mkdir(gitDir, 0755));
+}
+
+void tearDown() {
+    char indexPath[sizeof(gitDir) + 8];
+    snprintf(indexPath, sizeof(indexPath), "%s/index", gitDir);
+    unlink(indexPath);
+    rmdir(gitDir);
+    rmdir(repoPath);
+    strcpy(repoPath + strlen(repoPath) - 6, "XXXXXX");
+}
+
+static void Put32(uint32_t v) {
+    buf[len++] = v >> 24;
+    buf[len++] = v >> 16;
+    buf[len++] = v >> 8;
+    buf[len++] = v;
+}
+
+static void Put16(uint16_t v) {
+    buf[len++] = v >> 8;
+    buf[len++] = v;
+}
+
+static void BeginIndex(uint32_t version, uint32_t count) {
+    len = 0;
+    prevPath = "";
+    memcpy(buf, "DIRC", 4);
+    len = 4;
+    Put32(version);
+    Put32(count);
+}
+
+static void PutEntry(uint32_t version, const char* path, uint32_t mode, uint16_t stage, uint16_t extFlags) {
+    usize start = len;
+    for (int i = 0; i < 5; ++i) Put32(i == 2 ? 1700000000u : 0); // ctime, mtime, dev
+    Put32(1234);                                                  // ino
+    Put32(mode);
+    Put32(0);
+    Put32(0);
+    Put32(42); // size
+    for (int i = 0; i < GI_OID_SIZE; ++i) buf[len++] = (unsigned char)(0xA0 + i);
+
+    usize pathLen = strlen(path);
+    Put16((uint16_t)((extFlags ? 0x4000 : 0) | (stage << 12) | (pathLen < 0xFFF ? pathLen : 0xFFF)));
+    if (extFlags) Put16(extFlags);
+
+    if (version == 4) {
+        // strip what differs from the previous path, single byte varints are enough here
+        usize common = 0;
+        while (prevPath[common] != '\0' && prevPath[common] == path[common]) ++common;
+        buf[len++] = (unsigned char)(strlen(prevPath) - common);
+        memcpy(buf + len, path + common, pathLen - common + 1);
+        len += pathLen - common + 1;
+    } else {
+        memcpy(buf + len, path, pathLen);
+        len += pathLen;
+        usize entryLen = (len - start + 8) & ~(usize)7;
+        while (len - start < entryLen) buf[len++] = '\0';
+    }
+    prevPath = path;
+}
+
+static void WriteIndex() {
+    memset(buf + len, 0, GI_OID_SIZE); // checksum, not verified
+    len += GI_OID_SIZE;
+
+    char indexPath[sizeof(gitDir) + 8];
+    snprintf(indexPath, sizeof(indexPath), "%s/index", gitDir);
+    FILE* fp = fopen(indexPath, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    TEST_ASSERT_EQUAL(len, fwrite(buf, 1, len, fp));
+    fclose(fp);
+}
+
+static void CheckEntries(uint32_t version) {
+    BeginIndex(version, 6);
+    PutEntry(version, "README.md", 0100644, 0, 0);
+    PutEntry(version, "lib", 0160000, 0, 0); // submodule
+    PutEntry(version, "src/a.c", 0100644, 1, 0);
+    PutEntry(version, "src/a.c", 0100644, 2, 0);
+    PutEntry(version, "src/main.c", 0100755, 0, version >= 3 ? 0x2000 : 0);
+    PutEntry(version, "src/sparse.c", 0100644, 0, version >= 3 ? 0x4000 : 0);
+    WriteIndex();
+
+    GitIndex index;
+    TEST_ASSERT_EQUAL(GIE_Ok, GI_Load(&index, gitDir));
+    TEST_ASSERT_EQUAL(version >= 3 ? 3 : 4, index.count);
+
+    TEST_ASSERT_EQUAL_STRING("README.md", index.entries[0].path);
+    TEST_ASSERT_TRUE(index.entries[0].hasOid);
+    TEST_ASSERT_EQUAL(42, index.entries[0].size);
+    TEST_ASSERT_EQUAL(1234, index.entries[0].ino);
+    TEST_ASSERT_EQUAL(0xA0, index.entries[0].oid[0]);
+
+    // the conflict is listed once, without a usable oid
+    TEST_ASSERT_EQUAL_STRING("src/a.c", index.entries[1].path);
+    TEST_ASSERT_FALSE(index.entries[1].hasOid);
+
+    TEST_ASSERT_EQUAL_STRING("src/main.c", index.entries[2].path);
+    TEST_ASSERT_EQUAL(version >= 3 ? false : true, index.entries[2].hasOid);
+
+    GI_Destroy(&index);
+}
+
+void TestVersion2() {
+    CheckEntries(2);
+}
+
+void TestVersion3() {
+    CheckEntries(3);
+}
+
+void TestVersion4() {
+    CheckEntries(4);
+}
+
+void TestRejectsGarbage() {
+    BeginIndex(2, 3);
+    PutEntry(2, "a", 0100644, 0, 0);
+    WriteIndex(); // fewer entries than announced
+
+    GitIndex index;
+    TEST_ASSERT_EQUAL(GIE_InvalidIndex, GI_Load(&index, gitDir));
+
+    BeginIndex(5, 0);
+    WriteIndex();
+    TEST_ASSERT_EQUAL(GIE_Unsupported, GI_Load(&index, gitDir));
+}
+
+void TestFindRepo() {
+    char sub[sizeof(repoPath) + 8];
+    snprintf(sub, sizeof(sub), "%s/x", repoPath);
+    TEST_ASSERT_EQUAL(0, mkdir(sub, 0755));
+
+    char* workTree = NULL;
+    char* foundGitDir = NULL;
+    TEST_ASSERT_EQUAL(GIE_Ok, GI_FindRepo(sub, &workTree, &foundGitDir));
+    TEST_ASSERT_EQUAL_STRING(repoPath, workTree);
+    TEST_ASSERT_EQUAL_STRING(gitDir, foundGitDir);
+
+    free(workTree);
+    free(foundGitDir);
+    rmdir(sub);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestVersion2);
+    RUN_TEST(TestVersion3);
+    RUN_TEST(TestVersion4);
+    RUN_TEST(TestRejectsGarbage);
+    RUN_TEST(TestFindRepo);
+    return UNITY_END();
+}
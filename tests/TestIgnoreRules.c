@@ -0,0 +1,116 @@
+#include <Unity/unity.h>
+
+#include <IgnoreRules.h>
+
+#include <stdio.h>
+#include <string.h>
+
+void setUp() {}
+void tearDown() {}
+
+static void Parse(IgnoreRules* rules, const char* text, const char* dirPath, const IgnoreRules* parent) {
+    TEST_ASSERT_EQUAL(IGE_Ok, IG_Parse(rules, text, strlen(text)));
+    rules->dirLen = strlen(dirPath);
+    rules->parent = parent;
+}
+
+void TestGlobMatch() {
+    TEST_ASSERT_TRUE(IG_GlobMatch("*.c", "main.c"));
+    TEST_ASSERT_FALSE(IG_GlobMatch("*.c", "src/main.c"));
+    TEST_ASSERT_TRUE(IG_GlobMatch("src/*.c", "src/main.c"));
+    TEST_ASSERT_TRUE(IG_GlobMatch("fil?.[ch]", "file.h"));
+    TEST_ASSERT_FALSE(IG_GlobMatch("fil?.[!ch]", "file.h"));
+    TEST_ASSERT_TRUE(IG_GlobMatch("tmp[0-9]", "tmp7"));
+
+    TEST_ASSERT_TRUE(IG_GlobMatch("**/foo", "foo"));
+    TEST_ASSERT_TRUE(IG_GlobMatch("**/foo", "a/b/foo"));
+    TEST_ASSERT_TRUE(IG_GlobMatch("a/**/b", "a/b"));
+    TEST_ASSERT_TRUE(IG_GlobMatch("a/**/b", "a/x/y/b"));
+    TEST_ASSERT_FALSE(IG_GlobMatch("a/**/b", "a/xb"));
+    TEST_ASSERT_TRUE(IG_GlobMatch("abc/**", "abc/x/y"));
+    TEST_ASSERT_FALSE(IG_GlobMatch("abc/**", "abc"));
+
+    TEST_ASSERT_TRUE(IG_GlobMatch("\\#hash", "#hash"));
+    TEST_ASSERT_TRUE(IG_GlobMatch("[unclosed", "[unclosed"));
+}
+
+void TestLastMatchWins() {
+    IgnoreRules rules;
+    Parse(&rules,
+        "# build output\n"
+        "\n"
+        "*.log\n"
+        "!keep.log\n"
+        "build/\n"
+        "/only-here\n"
+        "trailing   \n",
+        "root", NULL);
+
+    TEST_ASSERT_EQUAL(5, rules.count);
+    TEST_ASSERT_TRUE(IG_IsIgnored(&rules, "root", "a.log", false));
+    TEST_ASSERT_FALSE(IG_IsIgnored(&rules, "root", "keep.log", false));
+    TEST_ASSERT_TRUE(IG_IsIgnored(&rules, "root/x", "b.log", false));
+
+    // directories only
+    TEST_ASSERT_TRUE(IG_IsIgnored(&rules, "root/src", "build", true));
+    TEST_ASSERT_FALSE(IG_IsIgnored(&rules, "root", "build", false));
+
+    // anchored to the directory of the file
+    TEST_ASSERT_TRUE(IG_IsIgnored(&rules, "root", "only-here", false));
+    TEST_ASSERT_FALSE(IG_IsIgnored(&rules, "root/sub", "only-here", false));
+
+    TEST_ASSERT_TRUE(IG_IsIgnored(&rules, "root", "trailing", false));
+
+    IG_Destroy(&rules);
+}
+
+void TestNestedRules() {
+    IgnoreRules top, nested;
+    Parse(&top, "*.gen\ndocs/api/\n", "repo/", NULL);
+    Parse(&nested, "!keep.gen\n/local\n", "repo/src", &top);
+
+    TEST_ASSERT_TRUE(IG_IsIgnored(&nested, "repo/src/x", "a.gen", false));
+    TEST_ASSERT_FALSE(IG_IsIgnored(&nested, "repo/src/x", "keep.gen", false));
+    TEST_ASSERT_TRUE(IG_IsIgnored(&top, "repo/", "keep.gen", false));
+
+    TEST_ASSERT_TRUE(IG_IsIgnored(&nested, "repo/src", "local", true));
+    TEST_ASSERT_FALSE(IG_IsIgnored(&nested, "repo/src/x", "local", true));
+
+    TEST_ASSERT_TRUE(IG_IsIgnored(&top, "repo/docs", "api", true));
+    TEST_ASSERT_FALSE(IG_IsIgnored(&top, "repo/src/docs", "api", true));
+
+    IG_Destroy(&nested);
+    IG_Destroy(&top);
+}
+
+void TestManyRules() {
+    char text[16 * 1024] = "";
+    char line[64];
+    for (int i = 0; i < 300; ++i) {
+        snprintf(line, sizeof(line), i % 3 == 0 ? "dir%d\n" : (i % 3 == 1 ? "*.ext%d\n" : "/gen/*%d.tmp\n"), i);
+        strcat(text, line);
+    }
+
+    IgnoreRules rules;
+    Parse(&rules, text, "r", NULL);
+    TEST_ASSERT_EQUAL(100, rules.namesCount);
+    TEST_ASSERT_EQUAL(100, rules.extsCount);
+    TEST_ASSERT_EQUAL(100, rules.globsCount);
+
+    TEST_ASSERT_TRUE(IG_IsIgnored(&rules, "r", "dir297", true));
+    TEST_ASSERT_TRUE(IG_IsIgnored(&rules, "r/a", "x.ext298", false));
+    TEST_ASSERT_TRUE(IG_IsIgnored(&rules, "r/gen", "a299.tmp", false));
+    TEST_ASSERT_FALSE(IG_IsIgnored(&rules, "r/other", "a299.tmp", false));
+    TEST_ASSERT_FALSE(IG_IsIgnored(&rules, "r", "dir298", true));
+
+    IG_Destroy(&rules);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestGlobMatch);
+    RUN_TEST(TestLastMatchWins);
+    RUN_TEST(TestNestedRules);
+    RUN_TEST(TestManyRules);
+    return UNITY_END();
+}
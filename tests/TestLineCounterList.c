@@ -0,0 +1,147 @@
+#include <Unity/unity.h>
+
+#include <LineCounterList.h>
+
+#include <stdio.h>
+#include <string.h>
+
+static LineCounterList list;
+
+void setUp() {
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_Init(&list));
+}
+
+void tearDown() {
+    LCL_Destroy(&list);
+}
+
+static void Append(const char* path, usize lines, off_t size) {
+    FileMeta meta = { .fullPath = (char*)path, .size = size, .mtime = (time_t)size };
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_Append(&list, path, lines, &meta, (LocStat) {0}, false));
+}
+
+static const char* PathAt(usize pos) {
+    LineCounter c;
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_GetOrdered(&list, pos, &c));
+    return c.toPrint;
+}
+
+void TestSortsTheOrderNotTheRows() {
+    Append("./b.c", 20, 5);
+    Append("./a.h", 10, 7);
+    Append("./c", 30, 6);
+
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, SM_Lines, true));
+    TEST_ASSERT_EQUAL_STRING("./c", PathAt(0));
+    TEST_ASSERT_EQUAL_STRING("./b.c", PathAt(1));
+    TEST_ASSERT_EQUAL_STRING("./a.h", PathAt(2));
+
+    // rows stay where they were appended
+    LineCounter c;
+    LCL_Get(&list, 0, &c);
+    TEST_ASSERT_EQUAL_STRING("./b.c", c.toPrint);
+    TEST_ASSERT_EQUAL_PTR(c.toPrint, c.meta.fullPath);
+
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, SM_Size, false));
+    TEST_ASSERT_EQUAL_STRING("./b.c", PathAt(0));
+    TEST_ASSERT_EQUAL_STRING("./c", PathAt(1));
+
+    // files without an extension sort first
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, SM_Ext, false));
+    TEST_ASSERT_EQUAL_STRING("./c", PathAt(0));
+    TEST_ASSERT_EQUAL_STRING("./b.c", PathAt(1));
+    TEST_ASSERT_EQUAL_STRING("./a.h", PathAt(2));
+}
+
+void TestTiesKeepTheAppendOrder() {
+    Append("./x/same", 1, 0);
+    Append("./y/same", 2, 0);
+    Append("./z/same", 1, 0);
+
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, SM_Size, true));
+    TEST_ASSERT_EQUAL_STRING("./x/same", PathAt(0));
+    TEST_ASSERT_EQUAL_STRING("./y/same", PathAt(1));
+    TEST_ASSERT_EQUAL_STRING("./z/same", PathAt(2));
+
+    // by name the lines count breaks ties first
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, SM_Name, true));
+    TEST_ASSERT_EQUAL_STRING("./y/same", PathAt(0));
+    TEST_ASSERT_EQUAL_STRING("./x/same", PathAt(1));
+    TEST_ASSERT_EQUAL_STRING("./z/same", PathAt(2));
+}
+
+void TestSortsLargeGroupsOfEqualNames() {
+    // enough counters for the radix passes, with few distinct names and lines
+    char path[64];
+    for (usize i = 0; i < 5000; ++i) {
+        snprintf(path, sizeof(path), "./dir%zu/common_prefix_%zu.c", i % 7, i % 3);
+        Append(path, i % 5, 0);
+    }
+
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, SM_Name, true));
+    for (usize pos = 1; pos < list.len; ++pos) {
+        uint32_t a = list.order[pos - 1];
+        uint32_t b = list.order[pos];
+        int cmp = strcmp(strrchr(list.toPrint[a], '/'), strrchr(list.toPrint[b], '/'));
+        TEST_ASSERT_TRUE(cmp >= 0);
+        if (cmp == 0) {
+            TEST_ASSERT_TRUE(list.lines[a] >= list.lines[b]);
+            if (list.lines[a] == list.lines[b]) TEST_ASSERT_TRUE(a < b);
+        }
+    }
+}
+
+void TestSwapRemoveKeepsTheOrder() {
+    Append("./a", 1, 0);
+    Append("./b", 3, 0);
+    Append("./c", 2, 0);
+    Append("./d", 4, 0);
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, SM_Lines, false));
+
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SwapRemove(&list, 1));
+    TEST_ASSERT_EQUAL(3, list.len);
+    TEST_ASSERT_EQUAL_STRING("./a", PathAt(0));
+    TEST_ASSERT_EQUAL_STRING("./c", PathAt(1));
+    TEST_ASSERT_EQUAL_STRING("./d", PathAt(2));
+
+    LineCounter c;
+    LCL_Get(&list, 1, &c);
+    TEST_ASSERT_EQUAL_STRING("./d", c.toPrint);
+    TEST_ASSERT_EQUAL(LCLE_IndexOutOfRange, LCL_Get(&list, 3, &c));
+}
+
+void TestStoresLocStatsAndOtherPaths() {
+    Append("./plain", 5, 0);
+
+    FileMeta meta = { .fullPath = "/abs/src.c", .size = 1 };
+    LocStat stat = { .emptyLines = 1, .commentLines = 2, .codeLines = 3, .preprocessorLines = 4, .totalLines = 10 };
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_Append(&list, "./src.c", 10, &meta, stat, true));
+
+    LineCounter c;
+    LCL_Get(&list, 0, &c);
+    TEST_ASSERT_FALSE(c.hasLocStat);
+    TEST_ASSERT_EQUAL_STRING("./plain", c.meta.fullPath);
+
+    LCL_Get(&list, 1, &c);
+    TEST_ASSERT_TRUE(c.hasLocStat);
+    TEST_ASSERT_TRUE(LS_Eql(&stat, &c.locStat));
+    TEST_ASSERT_EQUAL_STRING("./src.c", c.toPrint);
+    TEST_ASSERT_EQUAL_STRING("/abs/src.c", c.meta.fullPath);
+
+    LineCounterList copy;
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_Copy(&copy, &list));
+    LCL_Get(&copy, 1, &c);
+    TEST_ASSERT_EQUAL_STRING("/abs/src.c", c.meta.fullPath);
+    TEST_ASSERT_EQUAL(3, c.locStat.codeLines);
+    LCL_Destroy(&copy);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestSortsTheOrderNotTheRows);
+    RUN_TEST(TestTiesKeepTheAppendOrder);
+    RUN_TEST(TestSortsLargeGroupsOfEqualNames);
+    RUN_TEST(TestSwapRemoveKeepsTheOrder);
+    RUN_TEST(TestStoresLocStatsAndOtherPaths);
+    return UNITY_END();
+}
@@ -1,5 +1,6 @@
 #include <Unity/unity.h>
 
+#include <LocMatcher.h>
 #include <LocSettings.h>
 #include <LocUtils.h>
 #include <LocParser.h>
@@ -36,6 +37,18 @@ void TestFindLocEntryFor() {
 
     GetLocLangFor("unknown.xyz", &lang);
     TEST_ASSERT_NULL(lang);
+
+    GetLocLangFor("MAIN.C", &lang);
+    TEST_ASSERT_EQUAL_STRING("C", lang->langName);
+
+    GetLocLangFor("index.d.ts", &lang);
+    TEST_ASSERT_EQUAL_STRING("TypeScript", lang->langName);
+
+    GetLocLangFor("archive.c.xyz", &lang);
+    TEST_ASSERT_NULL(lang);
+
+    GetLocLangFor("makefile.bak", &lang);
+    TEST_ASSERT_NULL(lang);
 }
 
 void TestLocParserC() {
@@ -162,11 +175,95 @@ void TestLocParserShellScript() {
     TEST_ASSERT(LS_Eql(&result, &expected));
 }
 
+void TestLocParserBlocks() {
+    // fed in small blocks so lines, strings and comments get split between them
+    const char* testCode =
+        "package main\n"
+        "\n"
+        "/* Block comment\n"
+        "   spanning lines */\n"
+        "func main() {\n"
+        "    str := \"Hello // world\" // trailing\n"
+        "    multiline := `This is a\n"
+        "        /* not a comment */`\n"
+        "\n"
+        "}";
+
+    LocParser parser;
+    LP_Init(&parser);
+    LocStat expected = {0};
+    LP_ParseCode(&parser, LOC_LANG_GO, testCode, &expected);
+    LP_Destroy(&parser);
+
+    usize len = strlen(testCode);
+    for (usize blockSize = 1; blockSize <= 7; ++blockSize) {
+        LP_Init(&parser);
+
+        LocStat result = {0};
+        for (usize i = 0; i < len; i += blockSize) {
+            usize n = len - i < blockSize ? len - i : blockSize;
+            TEST_ASSERT_EQUAL(LPE_Ok, LP_ParseBuffer(&parser, LOC_LANG_GO, testCode + i, n, &result));
+        }
+        TEST_ASSERT_EQUAL(LPE_Ok, LP_Finish(&parser, LOC_LANG_GO, &result));
+
+        if (!LS_Eql(&result, &expected)) {
+            DBG
+        }
+        TEST_ASSERT(LS_Eql(&result, &expected));
+        LP_Destroy(&parser);
+    }
+}
+
+void TestLocMatcher() {
+    LocMatcher matcher;
+    TEST_ASSERT_EQUAL(LME_Ok, LM_Compile(&matcher, LOC_LANG_HTML));
+
+    TEST_ASSERT_FALSE(LM_IsCandidate(&matcher, 'a'));
+    TEST_ASSERT_NULL(LM_Match(&matcher, "<!-", 3)); // bounded by the length, not by a NUL
+
+    const LM_Delim* d = LM_Match(&matcher, "<!-- x -->", 10);
+    TEST_ASSERT_NOT_NULL(d);
+    TEST_ASSERT_EQUAL(LMK_MultilineComment, d->kind);
+    TEST_ASSERT_EQUAL_STRING("-->", d->pair->end);
+
+    // delimiters keep the LocEntry priority, not the longest match
+    TEST_ASSERT_EQUAL(LME_Ok, LM_Compile(&matcher, LOC_LANG_JAVA));
+    d = LM_Match(&matcher, "\"\"\"text", 7);
+    TEST_ASSERT_NOT_NULL(d);
+    TEST_ASSERT_EQUAL(LMK_String, d->kind);
+
+    TEST_ASSERT_EQUAL_PTR(LOC_LANG_GO, LM_For(LOC_LANG_GO)->lang);
+    d = LM_Match(LM_For(LOC_LANG_GO), "//go:build linux", 16);
+    TEST_ASSERT_NOT_NULL(d);
+    TEST_ASSERT_EQUAL(LMK_Comment, d->kind);
+}
+
+void TestLocParserReportsUncompilableLanguages() {
+    // more delimiters than a LocMatcher holds
+    static char names[LM_MAX_DELIMS + 1][8];
+    static const char* commentStarts[LM_MAX_DELIMS + 2];
+    for (usize i = 0; i <= LM_MAX_DELIMS; ++i) {
+        snprintf(names[i], sizeof(names[i]), "#%zu", i);
+        commentStarts[i] = names[i];
+    }
+    const LocEntry lang = { .langName = "Too Many", .commentStarts = commentStarts };
+
+    LocParser parser;
+    LP_Init(&parser);
+    LocStat result = {0};
+    const char* code = "x = 1\ny = 2\n";
+    TEST_ASSERT_EQUAL(LPE_TooManyDelims, LP_ParseBuffer(&parser, &lang, code, strlen(code), &result));
+    LP_Destroy(&parser);
+}
+
 int main() {
     UNITY_BEGIN();
     RUN_TEST(TestFindLocEntryFor);
     RUN_TEST(TestLocParserC);
     RUN_TEST(TestLocParserGo);
     RUN_TEST(TestLocParserShellScript);
+    RUN_TEST(TestLocParserBlocks);
+    RUN_TEST(TestLocParserReportsUncompilableLanguages);
+    RUN_TEST(TestLocMatcher);
     return UNITY_END();
 }
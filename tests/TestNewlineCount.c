@@ -0,0 +1,58 @@
+#include <Unity/unity.h>
+
+#include <NewlineCount.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+void setUp() {}
+void tearDown() {}
+
+static char* RandomText(usize len, unsigned seed) {
+    char* buf = malloc(len + 1);
+    srand(seed);
+    for (usize i = 0; i < len; ++i) {
+        int r = rand() % 64;
+        buf[i] = r == 0 ? '\n' : (r == 1 ? '\n' + 128 : 'a' + r % 26);
+    }
+    buf[len] = '\0';
+    return buf;
+}
+
+void TestKernelsMatchScalar() {
+    const usize len = 1 << 20;
+    char* text = RandomText(len, 42);
+
+    // odd offsets and lengths exercise the unaligned heads and the scalar tails
+    const usize offsets[] = { 0, 1, 7, 31, 63 };
+    const usize lengths[] = { 0, 1, 15, 16, 33, 255 * 16 + 5, 255 * 32 + 70, len - 64 };
+
+    for (NC_Kernel k = 0; k < NCK_Count; ++k) {
+        if (!NC_IsSupported(k)) continue;
+
+        for (usize o = 0; o < sizeof(offsets) / sizeof(offsets[0]); ++o) {
+            for (usize l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+                usize expected = NC_CountWith(NCK_Scalar, text + offsets[o], lengths[l]);
+                usize got = NC_CountWith(k, text + offsets[o], lengths[l]);
+                TEST_ASSERT_EQUAL_MESSAGE(expected, got, NC_KernelName(k));
+            }
+        }
+    }
+
+    free(text);
+}
+
+void TestAllNewlines() {
+    char buf[1000];
+    memset(buf, '\n', sizeof(buf));
+
+    TEST_ASSERT_EQUAL(sizeof(buf), NC_Count(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(0, NC_Count(buf, 0));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestKernelsMatchScalar);
+    RUN_TEST(TestAllNewlines);
+    return UNITY_END();
+}
@@ -0,0 +1,80 @@
+#include <Unity/unity.h>
+
+#include <PathTrie.h>
+
+#include <string.h>
+
+void setUp() {}
+void tearDown() {}
+
+void TestComponentBoundaries() {
+    PathTrie trie;
+    PT_Init(&trie);
+    TEST_ASSERT_TRUE(PT_IsEmpty(&trie));
+
+    PT_Insert(&trie, "/a/foo");
+    PT_Insert(&trie, "/b/c/d/");
+
+    TEST_ASSERT_TRUE(PT_Covers(&trie, "/a/foo"));
+    TEST_ASSERT_TRUE(PT_Covers(&trie, "/a/foo/x/y.c"));
+    TEST_ASSERT_FALSE(PT_Covers(&trie, "/a/foobar"));
+    TEST_ASSERT_FALSE(PT_Covers(&trie, "/a/fo"));
+    TEST_ASSERT_FALSE(PT_Covers(&trie, "/a"));
+
+    TEST_ASSERT_TRUE(PT_Covers(&trie, "/b/c/d"));
+    TEST_ASSERT_FALSE(PT_Covers(&trie, "/b/c"));
+
+    PT_Destroy(&trie);
+}
+
+void TestShorterPathCoversLonger() {
+    PathTrie trie;
+    PT_Init(&trie);
+
+    PT_Insert(&trie, "/x/y/z");
+    PT_Insert(&trie, "/x");
+    PT_Insert(&trie, "/x/w");
+
+    TEST_ASSERT_TRUE(PT_Covers(&trie, "/x/anything"));
+    TEST_ASSERT_EQUAL(0, PT_Root(&trie)->children[0]->childrenCount);
+
+    PT_Insert(&trie, "/");
+    TEST_ASSERT_TRUE(PT_Covers(&trie, "/usr/include"));
+
+    PT_Destroy(&trie);
+}
+
+void TestWalkCursor() {
+    PathTrie trie;
+    PT_Init(&trie);
+
+    PT_Insert(&trie, "/home/user/project/build");
+    PT_Insert(&trie, "/home/user/project/out");
+
+    bool covered;
+    const PT_Node* dir = PT_Walk(PT_Root(&trie), "/home/user/project", &covered);
+    TEST_ASSERT_NOT_NULL(dir);
+    TEST_ASSERT_FALSE(covered);
+
+    const PT_Node* build = PT_Child(dir, "build", 5);
+    TEST_ASSERT_NOT_NULL(build);
+    TEST_ASSERT_TRUE(build->terminal);
+    TEST_ASSERT_NULL(PT_Child(dir, "src", 3));
+
+    // nothing below /home/other is excluded
+    TEST_ASSERT_NULL(PT_Walk(PT_Root(&trie), "/home/other", &covered));
+    TEST_ASSERT_FALSE(covered);
+
+    PT_Walk(PT_Root(&trie), "/home/user/project/out/deep", &covered);
+    TEST_ASSERT_TRUE(covered);
+
+    PT_Destroy(&trie);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestComponentBoundaries);
+    RUN_TEST(TestShorterPathCoversLonger);
+    RUN_TEST(TestWalkCursor);
+    return UNITY_END();
+}
@@ -0,0 +1,91 @@
+#include <Unity/unity.h>
+
+#include <RegexSet.h>
+#include <StringList.h>
+
+#include <regex.h>
+
+void setUp() {}
+void tearDown() {}
+
+static const char* const patterns[] = {
+    "node_modules", "\\.git$", "^/tmp/", "^/exact/path$", "BUILD", "a\\.b\\*c",
+    "\\.min\\.js$", "^/usr/.*/cache", "test_[0-9]*\\.c$", "\\(foo\\)\\1", "^\\(src\\|lib\\)/", "x$y",
+    NULL,
+};
+
+static const char* const paths[] = {
+    "/home/user/project/node_modules/pkg/index.js", "/home/user/project/.git", "/home/user/project/.github/ci.yml",
+    "/tmp/file.c", "/var/tmp/file.c", "/exact/path", "/exact/path/below", "/home/Build/out.o",
+    "/a.b*c", "/axb*c", "/site/app.MIN.JS", "/site/app.js", "/usr/share/x/cache/y", "/usr/cache",
+    "/src/test_12.c", "/src/test_12.cpp", "/foofoo", "/foobar", "src/main.c", "lib/x.c", "bin/x",
+    "/x$y", "", NULL,
+};
+
+// the same result as running regexec for each pattern separately
+void TestMatchesLikeSeparateRegexes() {
+    StringList list;
+    SL_Init(&list);
+    for (usize i = 0; patterns[i] != NULL; ++i) SL_Append(&list, patterns[i]);
+
+    RegexSet set;
+    TEST_ASSERT_EQUAL(RSE_Ok, RS_Init(&set, &list));
+    TEST_ASSERT_GREATER_THAN(0, set.literalsCount);
+    TEST_ASSERT_TRUE(set.hasCombined);
+    TEST_ASSERT_EQUAL(1, set.separateCount); // back-reference
+
+    for (usize p = 0; paths[p] != NULL; ++p) {
+        for (usize n = 0; patterns[n] != NULL; ++n) {
+            regex_t re;
+            TEST_ASSERT_EQUAL(0, regcomp(&re, patterns[n], REG_ICASE));
+            bool expected = regexec(&re, paths[p], 0, NULL, 0) == 0;
+            regfree(&re);
+
+            // a set with just this one pattern
+            StringList one;
+            SL_Init(&one);
+            SL_Append(&one, patterns[n]);
+
+            RegexSet single;
+            TEST_ASSERT_EQUAL(RSE_Ok, RS_Init(&single, &one));
+            TEST_ASSERT_EQUAL_MESSAGE(expected, RS_Matches(&single, paths[p]), patterns[n]);
+
+            RS_Destroy(&single);
+            SL_Destroy(&one);
+        }
+    }
+
+    for (usize p = 0; paths[p] != NULL; ++p) {
+        bool expected = false;
+        for (usize n = 0; patterns[n] != NULL && !expected; ++n) {
+            regex_t re;
+            regcomp(&re, patterns[n], REG_ICASE);
+            expected = regexec(&re, paths[p], 0, NULL, 0) == 0;
+            regfree(&re);
+        }
+        TEST_ASSERT_EQUAL_MESSAGE(expected, RS_Matches(&set, paths[p]), paths[p]);
+    }
+
+    RS_Destroy(&set);
+    SL_Destroy(&list);
+}
+
+void TestInvalidRegex() {
+    StringList list;
+    SL_Init(&list);
+    SL_Append(&list, "fine");
+    SL_Append(&list, "broken\\(");
+
+    RegexSet set;
+    TEST_ASSERT_EQUAL(RSE_InvalidRegex, RS_Init(&set, &list));
+    TEST_ASSERT_EQUAL_STRING("broken\\(", set.invalidPattern);
+
+    SL_Destroy(&list);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestMatchesLikeSeparateRegexes);
+    RUN_TEST(TestInvalidRegex);
+    return UNITY_END();
+}
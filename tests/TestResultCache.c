@@ -0,0 +1,176 @@
+#include <Unity/unity.h>
+
+#include <ResultCache.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+static char cachePath[] = "/tmp/clines-cache-XXXXXX";
+
+void setUp() {
+    int fd = mkstemp(cachePath);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    close(fd);
+}
+
+void tearDown() {
+    unlink(cachePath);
+    strcpy(cachePath + strlen(cachePath) - 6, "XXXXXX");
+}
+
+static RC_Key Key(uint64_t ino, int64_t mtimeNs, uint32_t mode) {
+    return (RC_Key) { .dev = 1, .ino = ino, .size = 100, .mtimeNs = mtimeNs, .mode = mode };
+}
+
+void TestRoundTrip() {
+    ResultCache cache;
+    RC_Init(&cache);
+    RC_Load(&cache, cachePath); // empty file, no records
+    TEST_ASSERT_EQUAL(0, cache.count);
+
+    for (uint64_t ino = 200; ino > 0; --ino) {
+        RC_Key key = Key(ino, 1000, ino % 2);
+        RC_Value value = { .lines = ino * 10, .locStat = { .totalLines = ino * 10, .codeLines = ino } };
+        TEST_ASSERT_EQUAL(RCE_Ok, RC_Add(&cache, &key, &value));
+    }
+    TEST_ASSERT_EQUAL(RCE_Ok, RC_Save(&cache, cachePath));
+    RC_Destroy(&cache);
+
+    RC_Init(&cache);
+    RC_Load(&cache, cachePath);
+    TEST_ASSERT_EQUAL(200, cache.count);
+
+    RC_Value value;
+    RC_Key key = Key(7, 1000, 1);
+    TEST_ASSERT_TRUE(RC_Lookup(&cache, &key, &value));
+    TEST_ASSERT_EQUAL(70, value.lines);
+    TEST_ASSERT_EQUAL(7, value.locStat.codeLines);
+
+    // any change of the file or of how it is counted is a miss
+    key = Key(7, 1001, 1);
+    TEST_ASSERT_FALSE(RC_Lookup(&cache, &key, &value));
+    key = Key(7, 1000, 0);
+    TEST_ASSERT_FALSE(RC_Lookup(&cache, &key, &value));
+    key = Key(7, 1000, 1);
+    key.size = 101;
+    TEST_ASSERT_FALSE(RC_Lookup(&cache, &key, &value));
+    key = Key(201, 1000, 1);
+    TEST_ASSERT_FALSE(RC_Lookup(&cache, &key, &value));
+
+    RC_Destroy(&cache);
+}
+
+void TestRacyFilesAreNotSaved() {
+    ResultCache cache;
+    RC_Init(&cache);
+
+    RC_Key key = Key(1, cache.startedNs, 0);
+    RC_Value value = { .lines = 5 };
+    RC_Add(&cache, &key, &value);
+    TEST_ASSERT_EQUAL(0, cache.freshLen);
+
+    RC_Destroy(&cache);
+}
+
+void TestInvalidFileIsEmpty() {
+    FILE* fp = fopen(cachePath, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    fputs("not a cache file, but long enough to hold a header of one", fp);
+    fclose(fp);
+
+    ResultCache cache;
+    RC_Init(&cache);
+    RC_Load(&cache, cachePath);
+    TEST_ASSERT_EQUAL(0, cache.count);
+
+    RC_Value value;
+    RC_Key key = Key(1, 1000, 0);
+    TEST_ASSERT_FALSE(RC_Lookup(&cache, &key, &value));
+
+    RC_Destroy(&cache);
+}
+
+static void SaveRun(uint64_t firstIno, uint64_t lastIno, int64_t mtimeNs, usize lines) {
+    ResultCache cache;
+    RC_Init(&cache);
+    RC_Load(&cache, cachePath);
+    for (uint64_t ino = firstIno; ino <= lastIno; ++ino) {
+        RC_Key key = Key(ino, mtimeNs, 0);
+        RC_Value value = { .lines = lines };
+        TEST_ASSERT_EQUAL(RCE_Ok, RC_Add(&cache, &key, &value));
+    }
+    TEST_ASSERT_EQUAL(RCE_Ok, RC_Save(&cache, cachePath));
+    RC_Destroy(&cache);
+}
+
+void TestUnvisitedFilesAreKept() {
+    // two directories counted one after another with the same cache
+    SaveRun(1, 10, 1000, 1);
+    SaveRun(11, 20, 1000, 2);
+
+    ResultCache cache;
+    RC_Init(&cache);
+    RC_Load(&cache, cachePath);
+    TEST_ASSERT_EQUAL(20, cache.count);
+
+    // the first one again, one file changed and another one is too new to be saved
+    RC_Key changed = Key(3, 2000, 0);
+    RC_Value value = { .lines = 30 };
+    RC_Add(&cache, &changed, &value);
+    RC_Key racy = Key(4, cache.startedNs, 0);
+    RC_Add(&cache, &racy, &value);
+    TEST_ASSERT_EQUAL(RCE_Ok, RC_Save(&cache, cachePath));
+    RC_Destroy(&cache);
+
+    RC_Init(&cache);
+    RC_Load(&cache, cachePath);
+    TEST_ASSERT_EQUAL(19, cache.count);
+
+    RC_Key key = Key(1, 1000, 0);
+    TEST_ASSERT_TRUE(RC_Lookup(&cache, &key, &value));
+    TEST_ASSERT_EQUAL(1, value.lines);
+    key = Key(15, 1000, 0);
+    TEST_ASSERT_TRUE(RC_Lookup(&cache, &key, &value));
+    TEST_ASSERT_EQUAL(2, value.lines);
+    TEST_ASSERT_TRUE(RC_Lookup(&cache, &changed, &value));
+    TEST_ASSERT_EQUAL(30, value.lines);
+    key = Key(3, 1000, 0);
+    TEST_ASSERT_FALSE(RC_Lookup(&cache, &key, &value));
+    key = Key(4, 1000, 0);
+    TEST_ASSERT_FALSE(RC_Lookup(&cache, &key, &value));
+
+    RC_Destroy(&cache);
+}
+
+void TestOtherLanguageTableIsEmpty() {
+    SaveRun(1, 10, 1000, 1);
+
+    // same number of languages, but different delimiters or order
+    FILE* fp = fopen(cachePath, "r+b");
+    TEST_ASSERT_NOT_NULL(fp);
+    RC_Header header;
+    TEST_ASSERT_EQUAL(1, fread(&header, sizeof(header), 1, fp));
+    header.langHash++;
+    rewind(fp);
+    TEST_ASSERT_EQUAL(1, fwrite(&header, sizeof(header), 1, fp));
+    fclose(fp);
+
+    ResultCache cache;
+    RC_Init(&cache);
+    RC_Load(&cache, cachePath);
+    TEST_ASSERT_EQUAL(0, cache.count);
+    RC_Destroy(&cache);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestRoundTrip);
+    RUN_TEST(TestRacyFilesAreNotSaved);
+    RUN_TEST(TestInvalidFileIsEmpty);
+    RUN_TEST(TestUnvisitedFilesAreKept);
+    RUN_TEST(TestOtherLanguageTableIsEmpty);
+    return UNITY_END();
+}
@@ -0,0 +1,75 @@
+#include <Unity/unity.h>
+
+#include <StringArena.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static StringArena arena;
+
+void setUp() {
+    SA_Init(&arena);
+}
+
+void tearDown() {
+    SA_Destroy(&arena);
+}
+
+void TestKeepsStringsAcrossChunks() {
+    char* strs[5000];
+    char buf[64];
+    for (usize i = 0; i < 5000; ++i) {
+        snprintf(buf, sizeof(buf), "./some/dir/file-%zu.c", i);
+        TEST_ASSERT_EQUAL(SAE_Ok, SA_Dup(&arena, buf, &strs[i]));
+    }
+
+    for (usize i = 0; i < 5000; ++i) {
+        snprintf(buf, sizeof(buf), "./some/dir/file-%zu.c", i);
+        TEST_ASSERT_EQUAL_STRING(buf, strs[i]);
+    }
+}
+
+void TestLongStringsGetTheirOwnChunk() {
+    char* small;
+    TEST_ASSERT_EQUAL(SAE_Ok, SA_Dup(&arena, "a", &small));
+    SA_Chunk* head = arena.head;
+
+    usize len = SA_CHUNK_SIZE * 2;
+    char* text = malloc(len + 1);
+    TEST_ASSERT_NOT_NULL(text);
+    memset(text, 'x', len);
+    text[len] = '\0';
+
+    char* big;
+    TEST_ASSERT_EQUAL(SAE_Ok, SA_Dup(&arena, text, &big));
+    TEST_ASSERT_EQUAL(len, strlen(big));
+    free(text);
+
+    // later strings still go after the first one
+    char* next;
+    TEST_ASSERT_EQUAL(SAE_Ok, SA_DupN(&arena, "bcd", 2, &next));
+    TEST_ASSERT_EQUAL_PTR(head, arena.head);
+    TEST_ASSERT_EQUAL_PTR(small + 2, next);
+    TEST_ASSERT_EQUAL_STRING("bc", next);
+    TEST_ASSERT_EQUAL_STRING("a", small);
+    TEST_ASSERT_EQUAL(len + 1 + 2 + 3, arena.bytes);
+}
+
+void TestClearReleasesEverything() {
+    char* s;
+    TEST_ASSERT_EQUAL(SAE_Ok, SA_Dup(&arena, "first", &s));
+    SA_Clear(&arena);
+    TEST_ASSERT_NULL(arena.head);
+    TEST_ASSERT_EQUAL(0, arena.bytes);
+
+    TEST_ASSERT_EQUAL(SAE_Ok, SA_Dup(&arena, "again", &s));
+    TEST_ASSERT_EQUAL_STRING("again", s);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestKeepsStringsAcrossChunks);
+    RUN_TEST(TestLongStringsGetTheirOwnChunk);
+    RUN_TEST(TestClearReleasesEverything);
+    return UNITY_END();
+}
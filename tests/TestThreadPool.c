@@ -0,0 +1,114 @@
+#include <Unity/unity.h>
+
+#include <ThreadPool.h>
+
+#include <stdatomic.h>
+#include <time.h>
+
+#define TASKS_COUNT 1000
+#define CHILDREN_COUNT 64
+
+static ThreadPool pool;
+static atomic_size_t done;
+
+void setUp() {
+    atomic_init(&done, 0);
+    TEST_ASSERT_EQUAL(TPE_Ok, TP_Init(&pool, 4));
+}
+
+void tearDown() {
+    TP_Destroy(&pool);
+}
+
+static void SleepMs(long ms) {
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000 };
+    nanosleep(&ts, NULL);
+}
+
+static void CountTask(void* arg) {
+    (void)arg;
+    atomic_fetch_add(&done, 1);
+}
+
+static void SlowTask(void* arg) {
+    (void)arg;
+    SleepMs(1);
+    atomic_fetch_add(&done, 1);
+}
+
+/// Submits arg (a usize) more tasks like itself from the worker, so they all go to its own deque.
+static void SpawningTask(void* arg) {
+    usize depth = (usize)arg;
+    atomic_fetch_add(&done, 1);
+    if (depth == 0) return;
+
+    for (usize i = 0; i < 2; ++i) TP_Submit(&pool, SpawningTask, (void*)(depth - 1));
+}
+
+static isize childWorkers[CHILDREN_COUNT];
+
+static void ChildTask(void* arg) {
+    childWorkers[(usize)arg] = TP_CurrentWorker();
+    atomic_fetch_add(&done, 1);
+}
+
+/// Fills its own deque and blocks until the children ran (or a few seconds passed), only thieves can run them meanwhile.
+static void ParentTask(void* arg) {
+    isize* parentWorker = arg;
+    *parentWorker = TP_CurrentWorker();
+
+    for (usize i = 0; i < CHILDREN_COUNT; ++i) TP_Submit(&pool, ChildTask, (void*)i);
+    for (usize waited = 0; atomic_load(&done) < CHILDREN_COUNT && waited < 5000; ++waited) SleepMs(1);
+}
+
+void TestWaitsForEverySubmittedTask() {
+    for (usize i = 0; i < TASKS_COUNT; ++i) TEST_ASSERT_EQUAL(TPE_Ok, TP_Submit(&pool, CountTask, NULL));
+    TEST_ASSERT_EQUAL(TPE_Ok, TP_Wait(&pool));
+    TEST_ASSERT_EQUAL(TASKS_COUNT, atomic_load(&done));
+    TEST_ASSERT_EQUAL(0, atomic_load(&pool.queued));
+    TEST_ASSERT_EQUAL(0, atomic_load(&pool.pending));
+
+    // tasks submitted by tasks are waited for as well
+    TEST_ASSERT_EQUAL(TPE_Ok, TP_Submit(&pool, SpawningTask, (void*)9));
+    TEST_ASSERT_EQUAL(TPE_Ok, TP_Wait(&pool));
+    TEST_ASSERT_EQUAL(TASKS_COUNT + 1023, atomic_load(&done));
+    TEST_ASSERT_EQUAL(0, atomic_load(&pool.queued));
+}
+
+void TestIdleWorkersStealTasks() {
+    isize parentWorker = -1;
+    TEST_ASSERT_EQUAL(TPE_Ok, TP_Submit(&pool, ParentTask, &parentWorker));
+    TEST_ASSERT_EQUAL(TPE_Ok, TP_Wait(&pool));
+    TEST_ASSERT_EQUAL(CHILDREN_COUNT, atomic_load(&done));
+
+    TEST_ASSERT_NOT_EQUAL(-1, parentWorker);
+    for (usize i = 0; i < CHILDREN_COUNT; ++i) TEST_ASSERT_NOT_EQUAL(parentWorker, childWorkers[i]);
+}
+
+void TestDestroyRunsPendingTasks() {
+    for (usize i = 0; i < 200; ++i) TEST_ASSERT_EQUAL(TPE_Ok, TP_Submit(&pool, SlowTask, NULL));
+    TEST_ASSERT_EQUAL(TPE_Ok, TP_Destroy(&pool));
+    TEST_ASSERT_EQUAL(200, atomic_load(&done));
+
+    // destroying twice (here and in tearDown) is fine
+    TEST_ASSERT_EQUAL(TPE_Ok, TP_Destroy(&pool));
+}
+
+void TestOutsideOfPool() {
+    TEST_ASSERT_EQUAL(-1, TP_CurrentWorker());
+
+    ThreadPool empty;
+    TEST_ASSERT_EQUAL(TPE_InvalidArgument, TP_Init(&empty, 0));
+    TEST_ASSERT_EQUAL(TPE_InvalidArgument, TP_Submit(&empty, CountTask, NULL));
+    TEST_ASSERT_EQUAL(TPE_InvalidArgument, TP_Submit(&pool, NULL, NULL));
+    TEST_ASSERT_EQUAL(TPE_Ok, TP_Wait(&empty));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestWaitsForEverySubmittedTask);
+    RUN_TEST(TestIdleWorkersStealTasks);
+    RUN_TEST(TestDestroyRunsPendingTasks);
+    RUN_TEST(TestOutsideOfPool);
+    return UNITY_END();
+}
@@ -0,0 +1,124 @@
+#include <Unity/unity.h>
+
+#include <LineCounterList.h>
+#include <TopList.h>
+
+#include <stdio.h>
+#include <string.h>
+
+static TopList top;
+static LineCounterList list;
+
+void setUp() {
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_Init(&list));
+}
+
+void tearDown() {
+    TL_Destroy(&top);
+    LCL_Destroy(&list);
+}
+
+static void Offer(const char* path, usize lines, off_t size) {
+    FileMeta meta = { .fullPath = (char*)path, .size = size };
+    TEST_ASSERT_EQUAL(TLE_Ok, TL_Offer(&top, path, lines, &meta, (LocStat) {0}, false));
+}
+
+static const char* PathAt(usize pos) {
+    LineCounter c;
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_GetOrdered(&list, pos, &c));
+    return c.toPrint;
+}
+
+void TestKeepsTheFirstInTheSortOrder() {
+    TL_Init(&top, 3, SM_Lines, true);
+    Offer("./a", 5, 0);
+    Offer("./b", 50, 0);
+    Offer("./c", 1, 0);
+    Offer("./d", 20, 0);
+    Offer("./e", 50, 0);
+    Offer("./f", 30, 0);
+
+    TEST_ASSERT_EQUAL(TLE_Ok, TL_MoveTo(&top, &list));
+    TEST_ASSERT_EQUAL(3, list.len);
+    TEST_ASSERT_EQUAL(0, top.list.len);
+
+    // appended in the order they were offered, ties keep it after sorting
+    LineCounter c;
+    LCL_Get(&list, 0, &c);
+    TEST_ASSERT_EQUAL_STRING("./b", c.toPrint);
+
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, SM_Lines, true));
+    TEST_ASSERT_EQUAL_STRING("./b", PathAt(0));
+    TEST_ASSERT_EQUAL_STRING("./e", PathAt(1));
+    TEST_ASSERT_EQUAL_STRING("./f", PathAt(2));
+}
+
+void TestMatchesAFullSort() {
+    static const CFG_SortMode modes[] = { SM_NotSort, SM_Lines, SM_Size, SM_Path, SM_Name, SM_Ext };
+
+    char path[64];
+    for (usize m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+        for (int reverse = 0; reverse <= 1; ++reverse) {
+            LineCounterList all;
+            LCL_Init(&all);
+            TL_Init(&top, 25, modes[m], reverse);
+
+            for (usize i = 0; i < 1000; ++i) {
+                snprintf(path, sizeof(path), "./d%zu/f%zu.%s", (i * 7) % 13, (i * 31) % 97, i % 3 ? "c" : "h");
+                FileMeta meta = { .fullPath = path, .size = (off_t)((i * 17) % 101) };
+                TEST_ASSERT_EQUAL(LCLE_Ok, LCL_Append(&all, path, (i * 13) % 41, &meta, (LocStat) {0}, false));
+                Offer(path, (i * 13) % 41, meta.size);
+            }
+
+            TEST_ASSERT_EQUAL(TLE_Ok, TL_MoveTo(&top, &list));
+            TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&all, modes[m], reverse));
+            TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, modes[m], reverse));
+            TEST_ASSERT_EQUAL(25, list.len);
+
+            for (usize pos = 0; pos < list.len; ++pos) {
+                LineCounter want;
+                LCL_GetOrdered(&all, pos, &want);
+                TEST_ASSERT_EQUAL_STRING(want.toPrint, PathAt(pos));
+            }
+
+            LCL_Destroy(&all);
+            LCL_Clear(&list);
+            TL_Destroy(&top);
+        }
+    }
+}
+
+void TestDropsThePathsOfReplacedCounters() {
+    TL_Init(&top, 2, SM_Size, false);
+
+    // every counter replaces one, compaction keeps the arena from growing with them
+    char path[256];
+    memset(path, 'x', sizeof(path) - 1);
+    path[sizeof(path) - 1] = '\0';
+    for (usize i = 0; i < 20000; ++i) Offer(path, 0, 20000 - (off_t)i);
+
+    TEST_ASSERT_TRUE(top.list.strings.bytes < 2 * SA_CHUNK_SIZE);
+    TEST_ASSERT_EQUAL(TLE_Ok, TL_MoveTo(&top, &list));
+    TEST_ASSERT_EQUAL(2, list.len);
+    TEST_ASSERT_EQUAL(LCLE_Ok, LCL_SortBy(&list, SM_Size, false));
+
+    LineCounter c;
+    LCL_GetOrdered(&list, 0, &c);
+    TEST_ASSERT_EQUAL(1, c.meta.size);
+}
+
+void TestZeroKeepsNothing() {
+    TL_Init(&top, 0, SM_Lines, true);
+    Offer("./a", 1, 0);
+    TEST_ASSERT_EQUAL(TLE_Ok, TL_MoveTo(&top, &list));
+    TEST_ASSERT_EQUAL(0, list.len);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(TestKeepsTheFirstInTheSortOrder);
+    RUN_TEST(TestMatchesAFullSort);
+    RUN_TEST(TestDropsThePathsOfReplacedCounters);
+    RUN_TEST(TestZeroKeepsNothing);
+    return UNITY_END();
+}
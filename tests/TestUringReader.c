@@ -0,0 +1,108 @@
+#include <Unity/unity.h>
+
+#include <UringReader.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define FILES_COUNT (UR_QUEUE_DEPTH * 2 + 3)
+
+static char dirPath[] = "/tmp/clines-uring-XXXXXX";
+
+void setUp() {}
+void tearDown() {}
+
+typedef struct Seen {
+    usize calls[FILES_COUNT];
+    UR_Result results[FILES_COUNT];
+    char firstByte[FILES_COUNT];
+} Seen;
+
+static void OnFile(void* ctx, usize index, const UR_Result* result) {
+    Seen* seen = ctx;
+    seen->calls[index]++;
+    seen->results[index] = *result;
+    seen->results[index].data = NULL; // only valid during the call
+    seen->firstByte[index] = result->len > 0 ? result->data[0] : '\0';
+}
+
+static void WriteFile(const char* name, usize size, char fill) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", dirPath, name);
+
+    char* data = malloc(size + 1);
+    memset(data, fill, size);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    TEST_ASSERT_EQUAL(size, write(fd, data, size));
+    close(fd);
+    free(data);
+}
+
+void TestReadFiles() {
+    if (!UR_IsSupported()) TEST_IGNORE_MESSAGE("io_uring is not available");
+
+    UringReader reader;
+    TEST_ASSERT_EQUAL(URE_Ok, UR_Init(&reader));
+
+    int dirFd = open(dirPath, O_RDONLY | O_DIRECTORY);
+    TEST_ASSERT_NOT_EQUAL(-1, dirFd);
+
+    // more files than slots, so slots are reused, and one of each special case at the end
+    char names[FILES_COUNT][32];
+    UR_File files[FILES_COUNT];
+    for (usize i = 0; i < FILES_COUNT; ++i) {
+        snprintf(names[i], sizeof(names[i]), "file_%zu", i);
+        files[i] = (UR_File) { .dirFd = dirFd, .path = names[i] };
+    }
+    const usize missing = FILES_COUNT - 1;
+    const usize big = FILES_COUNT - 2;
+    const usize empty = FILES_COUNT - 3;
+
+    for (usize i = 0; i < empty; ++i) WriteFile(names[i], 100 + i, 'a' + i % 26);
+    WriteFile(names[empty], 0, 'x');
+    WriteFile(names[big], UR_SLOT_SIZE + 10, 'b');
+
+    Seen seen = {0};
+    TEST_ASSERT_EQUAL(URE_Ok, UR_ReadFiles(&reader, files, FILES_COUNT, OnFile, &seen));
+
+    for (usize i = 0; i < empty; ++i) {
+        TEST_ASSERT_EQUAL(1, seen.calls[i]);
+        TEST_ASSERT_EQUAL(0, seen.results[i].err);
+        TEST_ASSERT_EQUAL(100 + i, seen.results[i].len);
+        TEST_ASSERT_FALSE(seen.results[i].truncated);
+        TEST_ASSERT_EQUAL_CHAR('a' + i % 26, seen.firstByte[i]);
+    }
+
+    TEST_ASSERT_EQUAL(0, seen.results[empty].err);
+    TEST_ASSERT_EQUAL(0, seen.results[empty].len);
+
+    TEST_ASSERT_EQUAL(UR_SLOT_SIZE, seen.results[big].len);
+    TEST_ASSERT_TRUE(seen.results[big].truncated);
+
+    TEST_ASSERT_EQUAL(1, seen.calls[missing]);
+    TEST_ASSERT_NOT_EQUAL(0, seen.results[missing].err);
+
+    // the slots are free again
+    memset(&seen, 0, sizeof(seen));
+    TEST_ASSERT_EQUAL(URE_Ok, UR_ReadFiles(&reader, files, 3, OnFile, &seen));
+    TEST_ASSERT_EQUAL(100, seen.results[0].len);
+
+    close(dirFd);
+    UR_Destroy(&reader);
+}
+
+int main() {
+    if (mkdtemp(dirPath) == NULL) return 1;
+
+    UNITY_BEGIN();
+    RUN_TEST(TestReadFiles);
+    int res = UNITY_END();
+
+    char cmd[300];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", dirPath);
+    return system(cmd) == 0 ? res : 1;
+}
@@ -21,6 +21,10 @@ includePath=(
     "."
 )
 
+libs=(
+    -pthread
+)
+
 SuccessExit=0
 CompilationErrorExit=1
 LinkingErrorExit=2
@@ -142,7 +146,7 @@ CompileTest() {
     fi
 
     if NeedsCompile "$out" "$obj" || [[ "build/testing.o" -nt "$out" ]]; then
-        "$CC" "${CCFLAGS[@]}" "${CLINES_OBJECTS[@]}" "$obj" "build/Unity.o" -o "$out" || ShowError $LinkingErrorExit "Test \"$testFile\" failed to link."
+        "$CC" "${CCFLAGS[@]}" "${CLINES_OBJECTS[@]}" "$obj" "build/Unity.o" "${libs[@]}" -o "$out" || ShowError $LinkingErrorExit "Test \"$testFile\" failed to link."
     fi
 }
 